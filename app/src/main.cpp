@@ -6,6 +6,7 @@ import vulkan;
 import th.core.logger;
 import th.core.application;
 
+import th.scene.animation;
 import th.scene.model;
 import th.scene.camera;
 import th.scene.texture_data;
@@ -13,6 +14,8 @@ import th.scene.texture_data;
 import th.platform.window;
 import th.platform.glfw.glfw_window;
 
+import th.render_system.dynamic_resolution;
+import th.render_system.frame_snapshot;
 import th.render_system.render_graph;
 import th.render_system.passes;
 import th.render_system.vulkan;
@@ -24,33 +27,180 @@ class ThymeApp: public th::WindowedApplication {
 public:
     ThymeApp(const th::WindowedApplicationInitInfo& windowed_application_init_info, th::Logger& logger)
         : th::WindowedApplication(windowed_application_init_info, logger),
-          m_uniform_buffer(m_renderer.createUniformBuffer<glm::mat4>(m_allocator)),
+          m_dynamic_resolution(m_logical_device,
+                               m_allocator,
+                               m_memory_tracker,
+                               m_renderer.getDeletionQueue(),
+                               m_renderer,
+                               th::g_hdr_color_format,
+                               th::DynamicResolutionSettings{},
+                               logger),
+          m_light_culling(m_logical_device,
+                          m_allocator,
+                          m_memory_tracker,
+                          m_pipeline_compiler,
+                          m_bindless_heap,
+                          m_renderer.getFrameArena(),
+                          m_renderer.getFramesInFlightCount(),
+                          th::LightClusterSettings{},
+                          logger),
+          m_depth_prepass(m_logical_device,
+                          m_allocator,
+                          m_memory_tracker,
+                          m_renderer.getDeletionQueue(),
+                          m_pipeline_compiler,
+                          m_bindless_heap,
+                          m_renderer.getFrameArena(),
+                          logger),
+          m_msaa_targets(m_logical_device,
+                         m_allocator,
+                         m_memory_tracker,
+                         m_renderer.getDeletionQueue(),
+                         th::g_hdr_color_format,
+                         th::g_depth_format,
+                         std::min(m_application_init_info.msaa_samples,
+                                  th::getMaxUsableSampleCount(*m_physical_devices.current()))),
           m_my_pass(m_physical_devices.current(),
                     m_logical_device,
-                    m_swapchain.getFormat(),
-                    m_uniform_buffer.getDescriptorBufferInfos(),
+                    m_pipeline_compiler,
+                    m_bindless_heap,
+                    m_renderer.getFrameArena(),
+                    m_renderer.getFramesInFlightCount(),
+                    th::g_hdr_color_format,
+                    th::g_depth_format,
+                    m_msaa_targets.getSamples(),
                     logger),
+          m_post_process(m_logical_device,
+                         m_allocator,
+                         m_memory_tracker,
+                         m_renderer.getDeletionQueue(),
+                         m_pipeline_compiler,
+                         m_bindless_heap,
+                         m_renderer.getFramesInFlightCount(),
+                         logger),
           m_camera(th::FpsCameraViewArguments{ .position = glm::vec3(0.0f, 0.0f, 2.0f) },
                    th::PerspectiveCameraArguments{ .fov = 45.0f,
                                                    .znear = 0.1f,
                                                    .zfar = 100.0f,
                                                    .aspect_ratio = 1280.0f / 720.0f }),
-          m_camera_controller(std::ref(m_camera), m_window_events_handlers) {};
+          m_camera_controller(std::ref(m_camera), m_window_events_handlers), m_lights{ createLights() },
+          m_light_anchors{ m_lights | std::views::transform(&th::GpuPointLight::position)
+                           | std::ranges::to<std::vector>() },
+          m_checker_texture{ m_texture_streamer.addTexture(createCheckerTexture()) } {
+        m_animation_system.add(th::RotationAnimation{ .target = getRectNode(), .angular_velocity = 0.25f });
+    }
 
-    void update(float dt, th::RenderGraph& render_graph) override {
+    void update(float dt, th::FrameSnapshot& frame) override {
+        auto& render_graph = frame.getRenderGraph();
         m_camera_controller.update(dt);
         m_camera.setResolution(m_window.getFrameBufferSize());
-        m_uniform_buffer.update(m_camera.getViewProjectionMatrix());
-        const auto resource = render_graph.addTextureResource("swapchain", m_swapchain);
-        m_my_pass.setup(render_graph, resource);
+        animateLights(dt);
+        const auto view_projection = th::reverseDepth(m_camera.getViewProjectionMatrix());
+        frame.requestTextureSize(m_checker_texture, getScreenSize(view_projection, m_window.getFrameBufferSize()));
+        const auto output = render_graph.addTextureResource("swapchain", m_swapchain);
+        const auto scene = m_dynamic_resolution.setup(render_graph, m_swapchain);
+        const auto& scene_target = m_dynamic_resolution.getSceneTarget();
+        const auto lights = m_light_culling.setup(render_graph, m_lights, th::makeClusterView(m_camera), scene_target);
+        if (m_msaa_targets.isEnabled()) {
+            const auto msaa = m_msaa_targets.setup(render_graph, scene_target);
+            m_my_pass.setup(render_graph,
+                            th::MyPassTargets{ .color = msaa.color, .depth = msaa.depth, .resolve = scene },
+                            view_projection,
+                            m_light_culling,
+                            lights,
+                            m_texture_streamer,
+                            m_checker_texture);
+        } else {
+            const auto depth = m_depth_prepass.setup(render_graph, scene_target, view_projection);
+            m_my_pass.setup(render_graph,
+                            th::MyPassTargets{ .color = scene, .depth = depth },
+                            view_projection,
+                            m_light_culling,
+                            lights,
+                            m_texture_streamer,
+                            m_checker_texture);
+        }
+        constexpr auto post_effects = std::array{
+            th::PostEffect::sharpen, th::PostEffect::color_grading, th::PostEffect::vignette, th::PostEffect::tonemap
+        };
+        const auto post = m_post_process.setup(
+                render_graph, scene, scene_target, post_effects, th::PostProcessSettings{ .exposure = 1.5f });
+        m_dynamic_resolution.upscale(render_graph, post, output);
     }
     ~ThymeApp() override = default;
 
 private:
-    th::UniformBuffer<glm::mat4> m_uniform_buffer;
+    // A grid of small coloured lights in front of the scene, each circling its own anchor.
+    [[nodiscard]] static auto createLights() -> std::vector<th::GpuPointLight> {
+        constexpr auto grid_size = 32;
+        auto lights = std::vector<th::GpuPointLight>{};
+        lights.reserve(grid_size * grid_size);
+        for (auto y = 0; y < grid_size; ++y) {
+            for (auto x = 0; x < grid_size; ++x) {
+                const auto hue = static_cast<float>(x * grid_size + y) / (grid_size * grid_size);
+                lights.push_back(th::GpuPointLight{
+                        .position = glm::vec3(static_cast<float>(x) / (grid_size - 1) * 4.0f - 2.0f,
+                                              static_cast<float>(y) / (grid_size - 1) * 4.0f - 2.0f,
+                                              0.25f),
+                        .radius = 0.35f,
+                        .color = 0.5f + 0.5f * glm::cos(6.2831853f * (hue + glm::vec3(0.0f, 0.33f, 0.67f))),
+                        .intensity = 1.5f,
+                });
+            }
+        }
+        return lights;
+    }
+
+    // Albedo of the quad drawn by the application, streamed at the mip matching its on-screen size.
+    [[nodiscard]] static auto createCheckerTexture() -> std::shared_ptr<const th::TextureData> {
+        constexpr auto size = 2048u;
+        constexpr auto cell_size = 64u;
+        auto data = std::vector<uint8_t>(static_cast<std::size_t>(size) * size * 4);
+        for (auto y = 0u; y < size; ++y) {
+            for (auto x = 0u; x < size; ++x) {
+                const auto value = static_cast<uint8_t>(((x / cell_size + y / cell_size) % 2) * 255);
+                const auto texel = (static_cast<std::size_t>(y) * size + x) * 4;
+                data[texel] = value;
+                data[texel + 1] = value;
+                data[texel + 2] = value;
+                data[texel + 3] = 255;
+            }
+        }
+        const auto mip_levels = static_cast<uint32_t>(std::bit_width(size));
+        return std::make_shared<const th::TextureData>(mip_levels, glm::ivec2(size), data);
+    }
+
+    // Largest extent in pixels of the unit quad around the origin.
+    [[nodiscard]] static auto getScreenSize(const glm::mat4& view_projection, const glm::uvec2 resolution) -> float {
+        const auto project = [&view_projection](const glm::vec2 corner) -> glm::vec2 {
+            const auto clip = view_projection * glm::vec4(corner, 0.0f, 1.0f);
+            return glm::vec2(clip) / std::max(clip.w, 1e-4f);
+        };
+        const auto extent =
+                glm::abs(project(glm::vec2(0.5f)) - project(glm::vec2(-0.5f))) * 0.5f * glm::vec2(resolution);
+        return std::max(extent.x, extent.y);
+    }
+
+    void animateLights(const float dt) {
+        m_time += dt;
+        for (auto i = 0uz; i < m_lights.size(); ++i) {
+            const auto phase = m_time * 1.5f + static_cast<float>(i) * 0.37f;
+            m_lights[i].position = m_light_anchors[i] + glm::vec3(std::cos(phase), std::sin(phase), 0.0f) * 0.1f;
+        }
+    }
+
+    th::DynamicResolutionPass m_dynamic_resolution;
+    th::ClusteredLightCulling m_light_culling;
+    th::DepthPrePass m_depth_prepass;
+    th::MultisampleTargets m_msaa_targets;
     th::MyPass m_my_pass;
+    th::PostProcessChain m_post_process;
     th::FpsCamera m_camera;
     th::CameraController m_camera_controller;
+    std::vector<th::GpuPointLight> m_lights;
+    std::vector<glm::vec3> m_light_anchors;
+    float m_time{ 0.0f };
+    th::StreamedTextureHandle m_checker_texture;
 };
 
 auto main() -> int {
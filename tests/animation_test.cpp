@@ -0,0 +1,124 @@
+import std;
+import glm;
+
+import th.core.job_system;
+import th.scene.animation;
+import th.scene.scene_graph;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto isNear(const glm::vec3 lhs, const glm::vec3 rhs) -> bool {
+    return glm::length(lhs - rhs) < 1e-4f;
+}
+
+// Quaternions q and -q are the same rotation.
+auto isNear(const glm::quat lhs, const glm::quat rhs) -> bool {
+    return std::abs(glm::dot(lhs, rhs)) > 1.0f - 1e-4f;
+}
+
+auto animationKinds() -> bool {
+    auto scene_graph = th::SceneGraph{};
+    const auto spinning = scene_graph.addNode();
+    const auto bobbing = scene_graph.addNode();
+    const auto keyframed = scene_graph.addNode();
+
+    constexpr auto half_pi = std::numbers::pi_v<float> * 0.5f;
+    auto animation_system = th::AnimationSystem{};
+    animation_system.add(th::RotationAnimation{ .target = spinning, .angular_velocity = half_pi });
+    animation_system.add(th::TranslationCurve{ .target = bobbing, .amplitude = glm::vec3(1.0f, 0.0f, 0.0f) });
+    animation_system.add(th::KeyframeTrack{
+            .target = keyframed,
+            .keyframes = { { .time = 0.0f, .translation = glm::vec3(0.0f) },
+                           { .time = 2.0f, .translation = glm::vec3(4.0f, 0.0f, 0.0f) } } });
+    auto callback_time = 0.0f;
+    animation_system.addCallback([&callback_time](const float dt) { callback_time += dt; });
+
+    auto passed = check(animation_system.size() == 3, "every batched animation is counted");
+    animation_system.update(1.0f);
+    animation_system.apply(scene_graph);
+    passed = passed
+             && check(isNear(scene_graph.getLocalTransform(spinning).rotation,
+                             glm::angleAxis(half_pi, glm::vec3(0.0f, 0.0f, 1.0f))),
+                      "rotations advance by their angular velocity")
+             && check(isNear(scene_graph.getLocalTransform(bobbing).translation,
+                             glm::vec3(std::sin(1.0f), 0.0f, 0.0f)),
+                      "translation curves follow the sine")
+             && check(isNear(scene_graph.getLocalTransform(keyframed).translation, glm::vec3(2.0f, 0.0f, 0.0f)),
+                      "keyframes are interpolated linearly")
+             && check(callback_time == 1.0f, "callbacks receive the frame time");
+
+    // Past the last keyframe the track loops.
+    scene_graph.update();
+    animation_system.update(2.0f);
+    animation_system.apply(scene_graph);
+    return passed
+           && check(isNear(scene_graph.getLocalTransform(keyframed).translation, glm::vec3(2.0f, 0.0f, 0.0f)),
+                    "keyframe tracks loop")
+           && check(scene_graph.update() == 3, "applied animations mark their targets dirty");
+}
+
+// Chunks computed on the job system have to match the single threaded result.
+auto batchedUpdate(th::JobSystem& job_system) -> bool {
+    constexpr auto count = 10000;
+    auto serial_graph = th::SceneGraph{};
+    auto parallel_graph = th::SceneGraph{};
+    auto serial_system = th::AnimationSystem{};
+    auto parallel_system = th::AnimationSystem{};
+    for (auto i = 0; i < count; ++i) {
+        const auto rotation = th::RotationAnimation{ .target = serial_graph.addNode(),
+                                                     .axis = glm::vec3(0.0f, 1.0f, 0.0f),
+                                                     .angular_velocity = static_cast<float>(i) * 0.001f };
+        const auto curve = th::TranslationCurve{ .target = serial_graph.addNode(),
+                                                 .amplitude = glm::vec3(1.0f),
+                                                 .frequency = glm::vec3(static_cast<float>(i) * 0.01f) };
+        parallel_graph.addNode();
+        parallel_graph.addNode();
+        serial_system.add(rotation);
+        serial_system.add(curve);
+        parallel_system.add(rotation);
+        parallel_system.add(curve);
+    }
+    for (auto frame = 0; frame < 10; ++frame) {
+        serial_system.update(1.0f / 60.0f);
+        parallel_system.update(1.0f / 60.0f, &job_system);
+    }
+    serial_system.apply(serial_graph);
+    parallel_system.apply(parallel_graph);
+    for (auto id = 0u; id < 2 * count; ++id) {
+        const auto node = th::SceneNodeHandle{ .id = id };
+        const auto serial = serial_graph.getLocalTransform(node);
+        const auto parallel = parallel_graph.getLocalTransform(node);
+        if (!check(isNear(serial.rotation, parallel.rotation) && isNear(serial.translation, parallel.translation),
+                   "the job system computes the same animations")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto emptyKeyframeTrackThrows() -> bool {
+    auto animation_system = th::AnimationSystem{};
+    auto threw = false;
+    try {
+        animation_system.add(th::KeyframeTrack{ .target = th::SceneNodeHandle{ .id = 0 } });
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    return check(threw, "keyframe tracks without keyframes are rejected")
+           && check(animation_system.size() == 0, "a rejected track is not added");
+}
+
+}// namespace
+
+auto main() -> int {
+    auto job_system = th::JobSystem{ std::max(std::thread::hardware_concurrency(), 4u) - 1 };
+    const auto passed = animationKinds() && batchedUpdate(job_system) && emptyKeyframeTrackThrows();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+import std;
+
+import th.render_system.dynamic_resolution;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto isNear(const float lhs, const float rhs) -> bool {
+    return std::abs(lhs - rhs) < 1e-4f;
+}
+
+auto isStep(const float scale, const float step) -> bool {
+    return std::abs(scale / step - std::round(scale / step)) < 1e-3f;
+}
+
+// A GPU time proportional to the pixel count, the way the controller models it.
+auto runFrames(th::DynamicResolutionController& controller, const float full_resolution_time_ms, const int frames)
+        -> float {
+    for (auto frame = 0; frame < frames; ++frame) {
+        const auto scale = controller.getScale();
+        controller.update(full_resolution_time_ms * scale * scale);
+    }
+    return controller.getScale();
+}
+
+auto dropsAndRecovers() -> bool {
+    const auto settings = th::DynamicResolutionSettings{ .target_gpu_time_ms = 10.0f };
+    auto controller = th::DynamicResolutionController{ settings };
+    if (!check(isNear(controller.getScale(), settings.max_scale), "rendering starts at the maximum scale")) {
+        return false;
+    }
+
+    // Twice the budget at full resolution, the scale has to fall until the frame fits.
+    const auto low_scale = runFrames(controller, 20.0f, 200);
+    auto passed = check(low_scale < settings.max_scale, "an overloaded GPU lowers the scale")
+                  && check(low_scale >= settings.min_scale, "the scale stays above the minimum")
+                  && check(isStep(low_scale, settings.scale_step), "the scale moves in steps")
+                  && check(20.0f * low_scale * low_scale <= settings.target_gpu_time_ms, "the frame fits the budget");
+    if (!passed) {
+        return false;
+    }
+
+    // A load inside the hysteresis band keeps the scale.
+    const auto band_time_ms = 0.875f * settings.target_gpu_time_ms / (low_scale * low_scale);
+    passed = check(isNear(runFrames(controller, band_time_ms, 300), low_scale), "the scale holds inside the band");
+
+    // Once the load is gone the scale rises back, slower than it dropped.
+    const auto fast_scale = runFrames(controller, 2.0f, 30);
+    return passed && check(isNear(fast_scale, low_scale), "increases wait for a longer trend than decreases")
+           && check(isNear(runFrames(controller, 2.0f, 1000), settings.max_scale),
+                    "an idle GPU restores the maximum scale");
+}
+
+auto respectsLimits() -> bool {
+    auto controller = th::DynamicResolutionController{ { .target_gpu_time_ms = 10.0f, .min_scale = 0.6f } };
+    auto disabled = th::DynamicResolutionController{ { .enabled = false, .target_gpu_time_ms = 10.0f } };
+    return check(isNear(runFrames(controller, 1000.0f, 500), 0.6f), "the scale bottoms out at the minimum")
+           && check(isNear(runFrames(disabled, 1000.0f, 500), 1.0f), "a disabled controller keeps the maximum scale")
+           && check(disabled.getAverageGpuTime() > 0.0f, "a disabled controller still measures")
+           && check(isNear(controller.update(std::nullopt), 0.6f), "frames without timings keep the scale");
+}
+
+auto renderResolution() -> bool {
+    auto controller = th::DynamicResolutionController{ { .target_gpu_time_ms = 10.0f, .min_scale = 0.5f } };
+    runFrames(controller, 1000.0f, 500);
+    const auto resolution = controller.getRenderResolution({ 1920, 1080 });
+    const auto tiny = controller.getRenderResolution({ 1, 1 });
+    const auto empty = controller.getRenderResolution({ 0, 1080 });
+    return check(resolution.width == 960 && resolution.height == 540, "the output resolution is scaled")
+           && check(tiny.width == 1 && tiny.height == 1, "the render resolution is at least one pixel")
+           && check(empty.width == 0 && empty.height == 540, "an empty output stays empty");
+}
+
+}// namespace
+
+auto main() -> int {
+    const auto passed = dropsAndRecovers() && respectsLimits() && renderResolution();
+    return passed ? 0 : 1;
+}
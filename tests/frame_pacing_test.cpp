@@ -0,0 +1,76 @@
+import std;
+
+import th.render_system.frame_pacing;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto runFrames(th::FramePacingController& controller, const float cpu_time_ms, const float gpu_time_ms,
+               const int frames) -> uint32_t {
+    auto frames_in_flight = controller.getFramesInFlight();
+    for (auto frame = 0; frame < frames; ++frame) {
+        frames_in_flight = controller.update({ .cpu_time_ms = cpu_time_ms, .gpu_time_ms = gpu_time_ms });
+    }
+    return frames_in_flight;
+}
+
+// While CPU and GPU fit the budget one after another a single frame in flight is enough, once they do not the
+// controller adds frames back one at a time.
+auto adaptsFramesInFlight() -> bool {
+    auto controller =
+            th::FramePacingController{ { .frames_in_flight = 2, .max_frames_in_flight = 3, .adaptive = true } };
+    return check(runFrames(controller, 2.0f, 2.0f, 10) == 2, "a short trend keeps the frames in flight")
+           && check(runFrames(controller, 2.0f, 2.0f, 100) == 1, "light frames drop to one frame in flight")
+           && check(runFrames(controller, 10.0f, 10.0f, 60) == 2, "heavy frames add one frame in flight")
+           && check(runFrames(controller, 10.0f, 10.0f, 200) == 3, "heavy frames grow up to the maximum")
+           && check(controller.getAverageCpuTime() > 9.0f && controller.getAverageGpuTime() > 9.0f,
+                    "frame times are averaged");
+}
+
+auto fixedFramesInFlight() -> bool {
+    auto fixed = th::FramePacingController{ { .frames_in_flight = 2, .max_frames_in_flight = 3 } };
+    auto throughput = th::FramePacingController{
+        { .profile = th::FramePacingProfile::max_throughput, .max_frames_in_flight = 3, .adaptive = true }
+    };
+    auto clamped = th::FramePacingController{ { .frames_in_flight = 5, .max_frames_in_flight = 3 } };
+    auto at_least_one = th::FramePacingController{ { .frames_in_flight = 0 } };
+    return check(runFrames(fixed, 1.0f, 1.0f, 200) == 2, "without adaptation the frames in flight stay fixed")
+           && check(runFrames(throughput, 1.0f, 1.0f, 200) == 3, "max throughput always uses the maximum")
+           && check(clamped.getFramesInFlight() == 3, "frames in flight are clamped to the maximum")
+           && check(at_least_one.getFramesInFlight() == 1, "at least one frame is in flight");
+}
+
+// Frames without a GPU timestamp keep the previous GPU average.
+auto missingGpuTimes() -> bool {
+    auto controller = th::FramePacingController{ { .adaptive = true } };
+    runFrames(controller, 4.0f, 8.0f, 100);
+    const auto gpu_time_ms = controller.getAverageGpuTime();
+    controller.update({ .cpu_time_ms = 4.0f, .gpu_time_ms = std::nullopt });
+    return check(controller.getAverageGpuTime() == gpu_time_ms, "a missing GPU time keeps the average");
+}
+
+// Only a lower bound, the scheduler may always wake the thread late.
+auto limiterKeepsPace() -> bool {
+    constexpr auto frame_rate = 100.0f;
+    constexpr auto frames = 10;
+    auto limiter = th::FrameLimiter{ frame_rate };
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame <= frames; ++frame) {
+        limiter.wait();
+    }
+    const auto elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    return check(elapsed >= 0.95f * frames / frame_rate, "the limiter waits for every frame deadline");
+}
+
+}// namespace
+
+auto main() -> int {
+    const auto passed = adaptsFramesInFlight() && fixedFramesInFlight() && missingGpuTimes() && limiterKeepsPace();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+import std;
+
+import th.render_system.frame_snapshot;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+// The simulation thread fills snapshots while the render thread reads them; every frame has to arrive once, in
+// order, and never while the other side still writes it.
+auto handoff(const int frames) -> bool {
+    auto queue = th::FrameSnapshotQueue{};
+    std::thread simulation([&queue, frames] {
+        for (auto frame = 0; frame < frames; ++frame) {
+            auto* snapshot = queue.beginWrite();
+            if (!snapshot) {
+                return;
+            }
+            snapshot->reset(static_cast<float>(frame));
+            snapshot->setSimulationTime(static_cast<float>(frame) * 2.0f);
+            queue.publish();
+        }
+    });
+    auto passed = true;
+    for (auto frame = 0; frame < frames && passed; ++frame) {
+        auto* snapshot = queue.beginRead();
+        passed = check(snapshot != nullptr, "published snapshots are read")
+                 && check(snapshot->getDeltaTime() == static_cast<float>(frame), "snapshots arrive in order")
+                 && check(snapshot->getSimulationTime() == static_cast<float>(frame) * 2.0f,
+                          "a snapshot is complete when read");
+        queue.release();
+    }
+    queue.stop();
+    simulation.join();
+    return passed;
+}
+
+// Stopping wakes a render thread waiting for a snapshot that never comes.
+auto stopWakesReader() -> bool {
+    auto queue = th::FrameSnapshotQueue{};
+    auto* read_snapshot = reinterpret_cast<th::FrameSnapshot*>(1);
+    std::thread render([&queue, &read_snapshot] { read_snapshot = queue.beginRead(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    queue.stop();
+    render.join();
+    return check(read_snapshot == nullptr, "a stopped queue returns no snapshot to read")
+           && check(queue.beginWrite() == nullptr, "a stopped queue returns no snapshot to write");
+}
+
+// Both slots filled, the simulation waits until the render thread releases one.
+auto stopWakesWriter() -> bool {
+    auto queue = th::FrameSnapshotQueue{};
+    for (auto i = 0; i < 2; ++i) {
+        if (!check(queue.beginWrite() != nullptr, "free slots can be written")) {
+            return false;
+        }
+        queue.publish();
+    }
+    auto* written_snapshot = reinterpret_cast<th::FrameSnapshot*>(1);
+    std::thread simulation([&queue, &written_snapshot] { written_snapshot = queue.beginWrite(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    queue.stop();
+    simulation.join();
+    return check(written_snapshot == nullptr, "stop wakes a waiting writer");
+}
+
+}// namespace
+
+auto main() -> int {
+    const auto passed = handoff(10000) && stopWakesReader() && stopWakesWriter();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+import std;
+
+import th.core.job_system;
+
+// Stress test of the counter hand-off: parallelFor destroys its stack counter as soon as wait returns, so a worker
+// still touching the counter after the count reached zero shows up as a crash or a sanitizer report.
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto parallelForLoop(th::JobSystem& job_system, const int iterations) -> bool {
+    constexpr auto count = std::size_t{ 4096 };
+    for (auto iteration = 0; iteration < iterations; ++iteration) {
+        auto sum = std::atomic<std::size_t>{ 0 };
+        job_system.parallelFor(0, count, 16, [&sum](const std::size_t begin, const std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                sum.fetch_add(i, std::memory_order_relaxed);
+            }
+        });
+        if (!check(sum.load() == count * (count - 1) / 2, "parallelFor visits every index once")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto continuationLoop(th::JobSystem& job_system, const int iterations) -> bool {
+    for (auto iteration = 0; iteration < iterations; ++iteration) {
+        auto first = th::JobCounter{};
+        auto second = th::JobCounter{};
+        auto value = std::atomic<int>{ 0 };
+        for (auto i = 0; i < 8; ++i) {
+            job_system.run([&value] { value.fetch_add(1, std::memory_order_relaxed); }, &first);
+        }
+        job_system.runAfter(first, [&value] { value.fetch_add(100, std::memory_order_relaxed); }, &second);
+        job_system.wait(second);
+        job_system.wait(first);
+        if (!check(value.load() == 108, "continuations run after their dependency")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Background jobs stay off the main thread unless there is no other thread to run them.
+auto backgroundLoop(th::JobSystem& job_system, const int iterations, const bool main_thread_allowed) -> bool {
+    const auto main_thread_id = std::this_thread::get_id();
+    for (auto iteration = 0; iteration < iterations; ++iteration) {
+        auto counter = th::JobCounter{};
+        auto value = std::atomic<int>{ 0 };
+        auto on_main_thread = std::atomic<bool>{ false };
+        for (auto i = 0; i < 4; ++i) {
+            job_system.runBackground(
+                    [&] {
+                        value.fetch_add(1, std::memory_order_relaxed);
+                        if (std::this_thread::get_id() == main_thread_id) {
+                            on_main_thread.store(true, std::memory_order_relaxed);
+                        }
+                    },
+                    &counter);
+        }
+        job_system.wait(counter);
+        if (!check(value.load() == 4, "every background job runs")
+            || !check(main_thread_allowed || !on_main_thread.load(), "background jobs stay off the main thread")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Without spawned workers the frame loop never waits on background work, processMainThreadJobs has to run it.
+auto frameLoopBackground(th::JobSystem& job_system, const int iterations) -> bool {
+    for (auto iteration = 0; iteration < iterations; ++iteration) {
+        auto counter = th::JobCounter{};
+        auto value = std::atomic<int>{ 0 };
+        for (auto i = 0; i < 4; ++i) {
+            job_system.runBackground([&value] { value.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        job_system.processMainThreadJobs();
+        if (!check(counter.isDone() && value.load() == 4, "processMainThreadJobs runs background jobs")) {
+            return false;
+        }
+        job_system.wait(counter);
+    }
+    return true;
+}
+
+}// namespace
+
+auto main() -> int {
+    {
+        auto single_threaded = th::JobSystem{ 0 };
+        if (!backgroundLoop(single_threaded, 100, true) || !frameLoopBackground(single_threaded, 100)) {
+            return 1;
+        }
+    }
+    auto job_system = th::JobSystem{ std::max(std::thread::hardware_concurrency(), 4u) - 1 };
+    auto passed = parallelForLoop(job_system, 20000) && continuationLoop(job_system, 20000);
+
+    // A thread that is neither a worker nor the creator, like the render thread, waiting on its own work.
+    auto foreign_passed = false;
+    std::thread([&] { foreign_passed = parallelForLoop(job_system, 2000); }).join();
+    passed = passed && check(foreign_passed, "parallelFor from a thread outside the job system");
+    passed = passed && backgroundLoop(job_system, 2000, false);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+import std;
+import glm;
+
+import th.core.job_system;
+import th.scene.scene_graph;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto isNear(const glm::vec3 lhs, const glm::vec3 rhs) -> bool {
+    return glm::length(lhs - rhs) < 1e-4f;
+}
+
+auto getWorldPosition(const th::SceneGraph& scene_graph, const th::SceneNodeHandle node) -> glm::vec3 {
+    return glm::vec3(scene_graph.getWorldMatrix(node)[3]);
+}
+
+auto contains(const std::span<const th::SceneNodeHandle> nodes, const th::SceneNodeHandle node) -> bool {
+    return std::ranges::find(nodes, node) != nodes.end();
+}
+
+// Changing a node recomputes it and its descendants only, parents ahead of children.
+auto dirtyPropagation(th::JobSystem* job_system) -> bool {
+    auto scene_graph = th::SceneGraph{};
+    const auto root = scene_graph.addNode({ .translation = glm::vec3(1.0f, 0.0f, 0.0f) });
+    const auto child = scene_graph.addNode({ .translation = glm::vec3(0.0f, 2.0f, 0.0f) }, root);
+    const auto grandchild = scene_graph.addNode({ .translation = glm::vec3(0.0f, 0.0f, 3.0f) }, child);
+    const auto sibling = scene_graph.addNode({ .translation = glm::vec3(0.0f, 5.0f, 0.0f) }, root);
+
+    auto passed = check(scene_graph.update(job_system) == 4, "new nodes are updated")
+                  && check(scene_graph.getDepthCount() == 3, "nodes are stored level by level")
+                  && check(scene_graph.getParent(grandchild) == child, "parents are kept")
+                  && check(isNear(getWorldPosition(scene_graph, grandchild), glm::vec3(1.0f, 2.0f, 3.0f)),
+                           "world matrices compose the hierarchy")
+                  && check(scene_graph.update(job_system) == 0, "an unchanged graph updates nothing")
+                  && check(scene_graph.getUpdatedNodes().empty(), "an unchanged graph reports no nodes");
+    if (!passed) {
+        return false;
+    }
+
+    scene_graph.setTranslation(child, glm::vec3(0.0f, 4.0f, 0.0f));
+    const auto count = scene_graph.update(job_system);
+    const auto updated = scene_graph.getUpdatedNodes();
+    passed = check(count == 2 && updated.size() == 2, "a change updates the node and its descendants")
+             && check(updated[0] == child && updated[1] == grandchild, "parents are reported ahead of children")
+             && check(!contains(updated, root) && !contains(updated, sibling), "unrelated nodes are not updated")
+             && check(isNear(getWorldPosition(scene_graph, grandchild), glm::vec3(1.0f, 4.0f, 3.0f)),
+                      "descendants see the new parent transform");
+    if (!passed) {
+        return false;
+    }
+
+    // Several changes to one node within a frame update it once.
+    scene_graph.setTranslation(root, glm::vec3(2.0f, 0.0f, 0.0f));
+    scene_graph.setScale(root, glm::vec3(1.0f));
+    scene_graph.setTranslation(grandchild, glm::vec3(0.0f, 0.0f, 1.0f));
+    return check(scene_graph.update(job_system) == 4, "every node below a changed root is updated once")
+           && check(isNear(getWorldPosition(scene_graph, grandchild), glm::vec3(2.0f, 4.0f, 1.0f)),
+                    "own and inherited changes combine")
+           && check(isNear(getWorldPosition(scene_graph, sibling), glm::vec3(2.0f, 5.0f, 0.0f)),
+                    "siblings inherit the root change");
+}
+
+// A level wider than one chunk, split across the job system.
+auto wideLevel(th::JobSystem& job_system) -> bool {
+    auto scene_graph = th::SceneGraph{};
+    const auto root = scene_graph.addNode();
+    auto children = std::vector<th::SceneNodeHandle>{};
+    for (auto i = 0; i < 5000; ++i) {
+        children.push_back(scene_graph.addNode({ .translation = glm::vec3(static_cast<float>(i), 0.0f, 0.0f) }, root));
+    }
+    scene_graph.update(&job_system);
+    scene_graph.setTranslation(root, glm::vec3(0.0f, 1.0f, 0.0f));
+    if (!check(scene_graph.update(&job_system) == children.size() + 1, "the whole subtree is updated")) {
+        return false;
+    }
+    for (auto i = 0uz; i < children.size(); ++i) {
+        if (!check(isNear(getWorldPosition(scene_graph, children[i]), glm::vec3(static_cast<float>(i), 1.0f, 0.0f)),
+                   "every chunk is computed")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto unknownNodeThrows() -> bool {
+    auto scene_graph = th::SceneGraph{};
+    auto threw = false;
+    try {
+        scene_graph.setTranslation(th::SceneNodeHandle{ .id = 7 }, glm::vec3(0.0f));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    return check(threw, "unknown nodes throw");
+}
+
+}// namespace
+
+auto main() -> int {
+    auto job_system = th::JobSystem{ std::max(std::thread::hardware_concurrency(), 4u) - 1 };
+    const auto passed =
+            dirtyPropagation(nullptr) && dirtyPropagation(&job_system) && wideLevel(job_system) && unknownNodeThrows();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+import std;
+
+import th.core.slot_map;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto handlesStayStable() -> bool {
+    auto slot_map = th::SlotMap<int>{};
+    auto handles = std::vector<th::SlotMapHandle<int>>{};
+    for (auto i = 0; i < 8; ++i) {
+        handles.push_back(slot_map.insert(int{ i }));
+    }
+    // Erasing from the middle moves the last value into the hole, the handles of the others must follow it.
+    auto passed = check(slot_map.erase(handles[2]), "erase of a live handle succeeds")
+                  && check(slot_map.erase(handles[5]), "erase of a second live handle succeeds")
+                  && check(slot_map.size() == 6, "erase shrinks the dense array");
+    for (auto i = 0uz; i < handles.size() && passed; ++i) {
+        const auto* value = slot_map.get(handles[i]);
+        passed = i == 2 || i == 5 ? check(value == nullptr, "erased handles are stale")
+                                  : check(value && *value == static_cast<int>(i), "live handles keep their value");
+    }
+    auto sum = 0;
+    for (const auto value : slot_map) {
+        sum += value;
+    }
+    return passed && check(sum == 0 + 1 + 3 + 4 + 6 + 7, "iteration visits every live value once");
+}
+
+auto staleHandlesDoNotAlias() -> bool {
+    auto slot_map = th::SlotMap<int>{};
+    const auto first = slot_map.insert(1);
+    slot_map.erase(first);
+    const auto second = slot_map.insert(2);
+    auto threw = false;
+    try {
+        [[maybe_unused]] const auto& value = slot_map.at(first);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    return check(second.index == first.index, "the freed slot is reused")
+           && check(second.generation != first.generation, "a reused slot gets a new generation")
+           && check(!slot_map.contains(first) && slot_map.get(first) == nullptr, "the old handle is stale")
+           && check(!slot_map.erase(first), "erasing a stale handle fails")
+           && check(threw, "at throws on a stale handle")
+           && check(slot_map.at(second) == 2, "the new handle sees the new value");
+}
+
+auto getHandleMatchesDensePosition() -> bool {
+    auto slot_map = th::SlotMap<std::string>{};
+    for (auto i = 0; i < 16; ++i) {
+        slot_map.emplace(std::to_string(i));
+    }
+    slot_map.erase(slot_map.getHandle(0));
+    slot_map.erase(slot_map.getHandle(7));
+    for (auto i = 0uz; i < slot_map.size(); ++i) {
+        const auto* value = slot_map.get(slot_map.getHandle(i));
+        if (!check(value == &*(slot_map.begin() + static_cast<std::ptrdiff_t>(i)), "getHandle points at its value")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto clearInvalidatesHandles() -> bool {
+    auto slot_map = th::SlotMap<int>{};
+    const auto first = slot_map.insert(1);
+    const auto second = slot_map.insert(2);
+    slot_map.clear();
+    const auto third = slot_map.insert(3);
+    return check(slot_map.size() == 1, "clear empties the map")
+           && check(!slot_map.contains(first) && !slot_map.contains(second), "clear makes every handle stale")
+           && check(third.index == first.index || third.index == second.index, "clear frees the slots for reuse")
+           && check(slot_map.at(third) == 3, "values inserted after clear are reachable");
+}
+
+}// namespace
+
+auto main() -> int {
+    const auto passed = handlesStayStable() && staleHandlesDoNotAlias() && getHandleMatchesDensePosition()
+                        && clearInvalidatesHandles();
+    return passed ? 0 : 1;
+}
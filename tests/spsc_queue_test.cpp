@@ -0,0 +1,71 @@
+import std;
+
+import th.core.spsc_queue;
+
+namespace {
+
+auto check(const bool condition, const std::string_view message) -> bool {
+    if (!condition) {
+        std::println(std::cerr, "FAILED: {}", message);
+    }
+    return condition;
+}
+
+auto boundedAndOrdered() -> bool {
+    auto queue = th::SpscQueue<int, 4>{};
+    if (!check(!queue.tryPop().has_value(), "a new queue is empty")) {
+        return false;
+    }
+    // Several rounds so the indices wrap around the buffer.
+    for (auto round = 0; round < 3; ++round) {
+        for (auto i = 0; i < 4; ++i) {
+            if (!check(queue.tryPush(round * 4 + i), "push succeeds below capacity")) {
+                return false;
+            }
+        }
+        if (!check(!queue.tryPush(-1), "push fails when full")) {
+            return false;
+        }
+        for (auto i = 0; i < 4; ++i) {
+            const auto value = queue.tryPop();
+            if (!check(value == round * 4 + i, "values come out in push order")) {
+                return false;
+            }
+        }
+        if (!check(!queue.tryPop().has_value(), "the queue is empty after popping everything")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One producer and one consumer thread, every value has to arrive exactly once and in order.
+auto producerConsumer(const std::size_t count) -> bool {
+    auto queue = th::SpscQueue<std::size_t, 64>{};
+    std::thread producer([&queue, count] {
+        for (auto i = 0uz; i < count; ++i) {
+            while (!queue.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    auto expected = 0uz;
+    auto in_order = true;
+    while (expected < count) {
+        if (const auto value = queue.tryPop()) {
+            in_order = in_order && *value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    return check(in_order, "values cross threads in order") && check(!queue.tryPop().has_value(), "no extra values");
+}
+
+}// namespace
+
+auto main() -> int {
+    const auto passed = boundedAndOrdered() && producerConsumer(1'000'000);
+    return passed ? 0 : 1;
+}
@@ -37,10 +37,38 @@ WindowedApplication::WindowedApplication(const WindowedApplicationInitInfo& wind
       m_allocator(m_vulkan_framework.getInstance(),
                   m_logical_device,
                   vma::AllocatorCreateInfo{
-                          .flags = vma::AllocatorCreateFlagBits::eBufferDeviceAddress,
+                          // Without VK_EXT_memory_budget VMA estimates the budget from its own allocations.
+                          .flags = vma::AllocatorCreateFlagBits::eBufferDeviceAddress
+                                   | (isDeviceExtensionSupported(*m_physical_devices.current(),
+                                                                 vk::EXTMemoryBudgetExtensionName)
+                                              ? vma::AllocatorCreateFlagBits::eExtMemoryBudget
+                                              : vma::AllocatorCreateFlags{}),
                           .physicalDevice = m_physical_devices.current(),
                   }),
-      m_renderer(m_logical_device, m_queue_family_index, getMaxFramesInFlight(), logger),
+      m_memory_tracker(m_allocator, m_physical_devices.current(), logger),
+      m_bindless_heap(m_physical_devices.current(), m_logical_device, BindlessHeapSettings{}, logger),
+      m_pipeline_cache(m_physical_devices.current(),
+                       m_logical_device,
+                       std::filesystem::current_path() / "pipeline_cache.bin",
+                       logger),
+      m_pipeline_registry(m_logical_device, m_pipeline_cache),
+      m_pipeline_compiler(m_logical_device, m_pipeline_registry, m_job_system, logger),
+      m_renderer(m_physical_devices.current(),
+                 m_logical_device,
+                 m_allocator,
+                 m_memory_tracker,
+                 m_bindless_heap,
+                 m_queue_family_index,
+                 getMaxFramesInFlight(),
+                 logger),
+      m_texture_streamer(m_allocator,
+                         m_memory_tracker,
+                         m_physical_devices.current(),
+                         m_logical_device,
+                         m_job_system,
+                         m_renderer.getFramesInFlightCount(),
+                         TextureStreamingSettings{},
+                         logger),
       m_swapchain(
               m_physical_devices.current(),
               m_logical_device,
@@ -50,17 +78,23 @@ WindowedApplication::WindowedApplication(const WindowedApplicationInitInfo& wind
                   const auto fbs = window->getFrameBufferSize();
                   return vk::Extent2D{ .width = fbs.x, .height = fbs.y };
               },
+              getPreferredPresentModes(windowed_application_init_info.frame_pacing.profile),
+              m_renderer.getDeletionQueue(),
               logger),
-      m_logger(logger) {}
+      m_logger(logger), m_rect_node{ m_scene_graph.addNode() },
+      m_frame_limiter(windowed_application_init_info.frame_pacing.target_frame_rate),
+      m_frame_pacing(windowed_application_init_info.frame_pacing) {
+    m_renderer.setFramesInFlight(m_frame_pacing.getFramesInFlight());
+}
 
 void WindowedApplication::run() {
     m_logger.info("Start application {}"sv, m_application_init_info.window_config.name);
-    auto getDT = [old_time = std::chrono::system_clock::now()]() mutable {
+    auto getDT = std::function<float()>{ [old_time = std::chrono::system_clock::now()]() mutable {
         const auto current_time = std::chrono::system_clock::now();
         const auto dt = std::chrono::duration<float>(current_time - old_time);
         old_time = current_time;
         return dt.count();
-    };
+    } };
 
     std::array<Vertex, 4> rect_vertices;
 
@@ -72,6 +106,10 @@ void WindowedApplication::run() {
     rect_vertices[1].color = { 0.5, 0.5, 0.5, 1 };
     rect_vertices[2].color = { 1, 0, 0, 1 };
     rect_vertices[3].color = { 0, 1, 0, 1 };
+    rect_vertices[0].tex_coord = { 1, 0 };
+    rect_vertices[1].tex_coord = { 1, 1 };
+    rect_vertices[2].tex_coord = { 0, 0 };
+    rect_vertices[3].tex_coord = { 0, 1 };
 
     std::array<uint32_t, 6> rect_indices;
 
@@ -83,45 +121,153 @@ void WindowedApplication::run() {
     rect_indices[4] = 1;
     rect_indices[5] = 3;
 
-    m_renderer.addMesh(GpuStaticMesh::create(m_allocator,
-                                             m_logical_device,
-                                             m_renderer.m_command_pool,
-                                             m_logical_device.getQueue(m_queue_family_index, 0),
-                                             rect_indices,
-                                             rect_vertices));
+    m_rect_mesh = m_renderer.addMesh(m_allocator, m_logical_device, rect_indices, rect_vertices);
+
+    if (m_application_init_info.pipelined_rendering) {
+        runPipelined(getDT);
+    } else {
+        runSequential(getDT);
+    }
+
+    m_logical_device.waitIdle();
+
+    const auto shader_cache_statistics = ShaderCache::getInstance().getStatistics();
+    const auto pipeline_registry_statistics = m_pipeline_registry.getStatistics();
+    const auto pipeline_cache_statistics = m_pipeline_cache.getStatistics();
+    m_logger.info("Shader cache hit rate {:.2f}, pipeline registry hit rate {:.2f}, pipeline cache hit rate {:.2f}",
+                  shader_cache_statistics.getHitRate(),
+                  pipeline_registry_statistics.getHitRate(),
+                  pipeline_cache_statistics.getHitRate());
+    m_logger.info("Average CPU frame time {:.2f} ms, GPU frame time {:.2f} ms, {} frames in flight",
+                  m_frame_pacing.getAverageCpuTime(),
+                  m_frame_pacing.getAverageGpuTime(),
+                  m_renderer.getFramesInFlight());
+    m_logger.info("Streamed textures resident {} bytes, budget {} bytes",
+                  m_texture_streamer.getResidentBytes(),
+                  m_texture_streamer.getMemoryBudget());
+    m_memory_tracker.logStatistics();
+}
+
+void WindowedApplication::simulateFrame(const float dt, FrameSnapshot& frame) {
+    const auto simulation_start = std::chrono::steady_clock::now();
+    frame.reset(dt);
+    auto& render_graph = frame.getRenderGraph();
+    m_animation_system.update(dt, &m_job_system);
+    m_animation_system.apply(m_scene_graph);
+    update(dt, frame);
+    m_scene_graph.update(&m_job_system);
+    for (const auto node : m_scene_graph.getUpdatedNodes()) {
+        frame.updateNode(node, m_scene_graph.getWorldMatrix(node));
+    }
+    const auto swapchain_rg_resource = render_graph.addTextureResource("swapchain", m_swapchain);
+    render_graph.addPass("present", [swapchain_rg_resource](RenderGraphBuilder& builder) {
+        builder.write(swapchain_rg_resource,
+                      ImageTransition{ .layout = vk::ImageLayout::ePresentSrcKHR,
+                                       .pipeline_stage = vk::PipelineStageFlagBits2::eBottomOfPipe });
 
+        return [=](const RenderGraphContext&, vk::CommandBuffer) -> void {
+
+        };
+    });
+    frame.drawNode(m_rect_mesh, m_rect_node);
+    frame.setSimulationTime(
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - simulation_start).count());
+}
+
+void WindowedApplication::renderFrame(FrameSnapshot& frame) {
+    // Node updates are kept by the renderer from one frame to the next, so they must not be lost with a skipped frame.
+    m_renderer.updateNodeTransforms(frame.getNodeUpdates());
+    if (m_window.isMinimalized()) {
+        return;
+    }
+    const auto wait_for_frame_semaphore = m_swapchain.prepareFrame(m_physical_devices.current(), m_logical_device);
+    if (!wait_for_frame_semaphore.has_value()) {
+        return;
+    }
+
+    for (const auto& [mesh, world] : frame.getInstances()) {
+        m_renderer.drawInstance(mesh, world);
+    }
+    for (const auto& [mesh, node] : frame.getNodes()) {
+        m_renderer.drawNode(mesh, node);
+    }
+    m_renderer.beginFrame(m_logical_device, wait_for_frame_semaphore.value().image_available_semaphore);
+    // Fence waits are excluded, they measure the GPU rather than the CPU.
+    const auto record_start = std::chrono::steady_clock::now();
+    for (const auto& [texture, screen_size_in_pixels] : frame.getTextureSizeRequests()) {
+        m_texture_streamer.requestScreenSize(texture, screen_size_in_pixels);
+    }
+    m_texture_streamer.update(m_renderer.getCommandBuffer(m_logical_device), m_renderer.getCurrentFrameIndex());
+    m_renderer.draw(m_logical_device, frame.getRenderGraph(), m_swapchain.getResolution());
+    m_renderer.endFrame(wait_for_frame_semaphore.value().image_rendering_semaphore);
+    const auto record_time_ms =
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - record_start).count();
+
+    m_swapchain.submitFrame();
+
+    // In pipelined mode simulation and recording overlap, so only the slower of the two bounds the frame.
+    const auto cpu_time_ms = m_application_init_info.pipelined_rendering
+                                     ? std::max(frame.getSimulationTime(), record_time_ms)
+                                     : frame.getSimulationTime() + record_time_ms;
+    const auto frames_in_flight = m_frame_pacing.update(
+            FrameTimings{ .cpu_time_ms = cpu_time_ms, .gpu_time_ms = m_renderer.getGpuFrameTime() });
+    if (frames_in_flight != m_renderer.getFramesInFlight()) {
+        m_logger.debug("Frames in flight {} -> {}", m_renderer.getFramesInFlight(), frames_in_flight);
+        m_renderer.setFramesInFlight(frames_in_flight);
+    }
+}
+
+void WindowedApplication::runSequential(const std::function<float()>& get_dt) {
+    FrameSnapshot frame;
     while (!m_window.shouldClose()) {
+        // Waiting before polling keeps the sampled input as fresh as possible.
+        m_frame_limiter.wait();
         m_window.poolEvents();
+        m_job_system.processMainThreadJobs();
 
-        RenderGraph render_graph;
-        update(getDT(), render_graph);
-        const auto swapchain_rg_resource = render_graph.addTextureResource("swapchain", m_swapchain);
-        render_graph.addPass("present", [swapchain_rg_resource](RenderGraphBuilder& builder) {
-            builder.write(swapchain_rg_resource,
-                          ImageTransition{ .layout = vk::ImageLayout::ePresentSrcKHR,
-                                           .pipeline_stage = vk::PipelineStageFlagBits2::eBottomOfPipe });
+        simulateFrame(get_dt(), frame);
+        renderFrame(frame);
+    }
+}
 
-            return [=](const RenderGraphContext&, vk::CommandBuffer) -> void {
+void WindowedApplication::runPipelined(const std::function<float()>& get_dt) {
+    FrameSnapshotQueue frames;
+    std::exception_ptr render_exception;
+    auto render_thread = std::jthread([this, &frames, &render_exception] {
+        try {
+            while (auto* frame = frames.beginRead()) {
+                renderFrame(*frame);
+                frames.release();
+            }
+        } catch (...) {
+            render_exception = std::current_exception();
+            frames.stop();
+        }
+    });
 
-            };
-        });
+    while (!m_window.shouldClose()) {
+        // Waiting before polling keeps the sampled input as fresh as possible.
+        m_frame_limiter.wait();
+        m_window.poolEvents();
+        m_job_system.processMainThreadJobs();
 
+        const auto dt = get_dt();
         if (m_window.isMinimalized()) {
             continue;
         }
-        const auto wait_for_frame_semaphore = m_swapchain.prepareFrame(m_physical_devices.current(), m_logical_device);
-        if (!wait_for_frame_semaphore.has_value()) {
-            continue;
+        auto* frame = frames.beginWrite();
+        if (frame == nullptr) {
+            break;
         }
-
-        m_renderer.beginFrame(m_logical_device, wait_for_frame_semaphore.value().image_available_semaphore);
-        m_renderer.draw(m_logical_device, render_graph, m_swapchain.getResolution());
-        m_renderer.endFrame(wait_for_frame_semaphore.value().image_rendering_semaphore);
-
-        m_swapchain.submitFrame();
+        simulateFrame(dt, *frame);
+        frames.publish();
     }
 
-    m_logical_device.waitIdle();
+    frames.stop();
+    render_thread.join();
+    if (render_exception) {
+        std::rethrow_exception(render_exception);
+    }
 }
 
 }// namespace th
@@ -5,14 +5,19 @@ import vk_mem_alloc;
 import vulkan;
 
 import th.core.events;
+import th.core.job_system;
 import th.core.logger;
 import th.scene.model;
+import th.scene.animation;
 import th.scene.camera;
+import th.scene.scene_graph;
 import th.platform.imgui_context;
 import th.platform.window_event_handler;
 import th.platform.window;
 import th.platform.glfw.glfw_window;
 import th.render_system.vulkan;
+import th.render_system.frame_pacing;
+import th.render_system.frame_snapshot;
 import th.render_system.renderer;
 import th.render_system.render_graph;
 import th.gui;
@@ -21,6 +26,12 @@ namespace th {
 
 export struct WindowedApplicationInitInfo {
     WindowConfig window_config;
+    // Records and submits frame N on a render thread while the main thread simulates frame N + 1.
+    bool pipelined_rendering{ false };
+    FramePacingSettings frame_pacing{};
+    // Samples per pixel of the scene, clamped to what the device supports. Multisampled depth is discarded after the
+    // scene pass and replaces the depth pre-pass, so multisampling is opt-in.
+    vk::SampleCountFlagBits msaa_samples{ vk::SampleCountFlagBits::e1 };
 };
 
 export class WindowedApplication {
@@ -29,14 +40,32 @@ public:
     WindowedApplication(const WindowedApplicationInitInfo& windowed_application_init_info, Logger& logger);
     void run();
 
-    virtual void update(float dt, RenderGraph& render_graph) = 0;
+    // Fills the snapshot of the next frame. In pipelined mode the previous frame may still be recorded meanwhile, so
+    // anything the render passes need has to be captured in the snapshot by value.
+    virtual void update(float dt, FrameSnapshot& frame) = 0;
 
-    [[nodiscard]] constexpr auto getMaxFramesInFlight() const noexcept -> uint32_t {
-        return 2;
+    [[nodiscard]] auto getMaxFramesInFlight() const noexcept -> uint32_t {
+        const auto& frame_pacing = m_application_init_info.frame_pacing;
+        const auto max_frames_in_flight = std::max(frame_pacing.max_frames_in_flight, 1u);
+        return frame_pacing.adaptive ? max_frames_in_flight
+                                     : std::clamp(frame_pacing.frames_in_flight, 1u, max_frames_in_flight);
     }
 
+protected:
+    // Scene node of the quad drawn every frame.
+    [[nodiscard]] auto getRectNode() const noexcept -> SceneNodeHandle {
+        return m_rect_node;
+    }
+
+private:
+    void simulateFrame(float dt, FrameSnapshot& frame);
+    void renderFrame(FrameSnapshot& frame);
+    void runSequential(const std::function<float()>& get_dt);
+    void runPipelined(const std::function<float()>& get_dt);
+
 protected:
     WindowedApplicationInitInfo m_application_init_info;
+    JobSystem m_job_system;
     WindowEventsHandlers m_window_events_handlers;
     GlfwWindow m_window;
     VulkanFramework m_vulkan_framework;
@@ -47,12 +76,33 @@ protected:
     vk::raii::Device m_logical_device;
 
     vma::raii::Allocator m_allocator;
+    // Tags are released by the resources of the members below, so it has to outlive them.
+    GpuMemoryTracker m_memory_tracker;
+
+    // Owns the pipeline layout the registry keys pipelines on, so the layout outlives every pipeline created with it.
+    BindlessDescriptorHeap m_bindless_heap;
+    VulkanPipelineCache m_pipeline_cache;
+    GraphicsPipelineRegistry m_pipeline_registry;
+    PipelineCompiler m_pipeline_compiler;
 
     Renderer m_renderer;
+    // Textures are added before run or from the thread recording frames, screen sizes go through the frame snapshot.
+    TextureStreamer m_texture_streamer;
 
     VulkanSwapchain2 m_swapchain;
 
+    // Updated on the simulation thread after update(), instances read their world matrices from it.
+    SceneGraph m_scene_graph;
+    // Stepped across the job system and applied to the scene graph before update().
+    AnimationSystem m_animation_system;
+
     Logger& m_logger;
+
+private:
+    MeshHandle m_rect_mesh{};
+    SceneNodeHandle m_rect_node;
+    FrameLimiter m_frame_limiter;
+    FramePacingController m_frame_pacing;
 };
 
 }// namespace th
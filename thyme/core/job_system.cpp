@@ -0,0 +1,306 @@
+module th.core.job_system;
+
+import std;
+
+namespace th {
+
+thread_local JobSystem* t_job_system{ nullptr };
+thread_local uint32_t t_worker_index{ 0 };
+
+WorkStealingDeque::WorkStealingDeque(const int64_t capacity) {
+    m_buffers.push_back(std::make_unique<Buffer>(std::bit_ceil(static_cast<uint64_t>(capacity))));
+    m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+void WorkStealingDeque::push(Job* job) {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed);
+    const auto top = m_top.load(std::memory_order_acquire);
+    auto* buffer = m_buffer.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->capacity - 1) {
+        auto grown = std::make_unique<Buffer>(buffer->capacity * 2);
+        for (auto i = top; i < bottom; ++i) {
+            grown->put(i, buffer->get(i));
+        }
+        buffer = m_buffers.emplace_back(std::move(grown)).get();
+        m_buffer.store(buffer, std::memory_order_release);
+    }
+    buffer->put(bottom, job);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+auto WorkStealingDeque::pop() noexcept -> Job* {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    auto* buffer = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = m_top.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    auto* job = buffer->get(bottom);
+    if (top == bottom) {
+        // Last job, race the thieves for it.
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+auto WorkStealingDeque::steal() noexcept -> Job* {
+    auto top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+    auto* job = m_buffer.load(std::memory_order_acquire)->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+JobSystem::JobSystem(const uint32_t worker_count) : m_main_thread_id{ std::this_thread::get_id() } {
+    for (uint32_t i{ 0 }; i <= worker_count; ++i) {
+        m_deques.push_back(std::make_unique<WorkStealingDeque>());
+    }
+    t_job_system = this;
+    t_worker_index = 0;
+    for (uint32_t i{ 1 }; i <= worker_count; ++i) {
+        m_workers.emplace_back([this, i](const std::stop_token& stop_token) { workerLoop(stop_token, i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    for (auto& worker : m_workers) {
+        worker.request_stop();
+    }
+    m_sleep_condition.notify_all();
+    m_workers.clear();
+
+    // Jobs still queued are dropped, their counters never reach zero. The workers are joined, so stealing from the
+    // owner's end of the deques is safe here.
+    for (const auto& deque : m_deques) {
+        while (auto* job = deque->steal()) {
+            delete job;
+        }
+    }
+    for (auto* job : m_injected_jobs) {
+        delete job;
+    }
+    for (auto* job : m_main_thread_jobs) {
+        delete job;
+    }
+    for (auto* job : m_background_jobs) {
+        delete job;
+    }
+    if (t_job_system == this) {
+        t_job_system = nullptr;
+    }
+}
+
+void JobSystem::run(std::function<void()> function, JobCounter* counter) {
+    if (counter) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    schedule(new Job{ .function = std::move(function), .counter = counter });
+}
+
+void JobSystem::runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter) {
+    if (counter) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto* job = new Job{ .function = std::move(function), .counter = counter };
+    {
+        std::scoped_lock lock{ dependency.m_mutex };
+        if (!dependency.isDone()) {
+            dependency.m_continuations.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+void JobSystem::runOnMainThread(std::function<void()> function, JobCounter* counter) {
+    if (counter) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::scoped_lock lock{ m_main_thread_mutex };
+    m_main_thread_jobs.push_back(new Job{ .function = std::move(function), .counter = counter });
+}
+
+void JobSystem::runBackground(std::function<void()> function, JobCounter* counter) {
+    if (counter) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_queued_jobs.fetch_add(1, std::memory_order_release);
+    {
+        std::scoped_lock lock{ m_background_mutex };
+        m_background_jobs.push_back(new Job{ .function = std::move(function), .counter = counter });
+    }
+    {
+        std::scoped_lock lock{ m_sleep_mutex };
+    }
+    m_sleep_condition.notify_one();
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    const auto worker_index = getCurrentWorkerIndex();
+    const auto is_main_thread = std::this_thread::get_id() == m_main_thread_id;
+    // Spawned workers are the ones with a non-zero index.
+    const auto takes_background_jobs = worker_index.value_or(0) != 0 || m_workers.empty();
+    while (!counter.isDone()) {
+        if (is_main_thread) {
+            processMainThreadJobs();
+        }
+        auto* job = findJob(worker_index);
+        if (job == nullptr && takes_background_jobs) {
+            job = findBackgroundJob();
+        }
+        if (job != nullptr) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    // The job bringing the count to zero does so under the mutex, once it is released the counter is not touched
+    // anymore and the caller may destroy it.
+    std::scoped_lock lock{ counter.m_mutex };
+}
+
+void JobSystem::processMainThreadJobs() {
+    auto jobs = [this] {
+        std::scoped_lock lock{ m_main_thread_mutex };
+        return std::exchange(m_main_thread_jobs, {});
+    }();
+    for (auto* job : jobs) {
+        execute(job);
+    }
+    // Without spawned workers nothing else takes background jobs. Only those queued so far run, so jobs queueing more
+    // cannot keep the frame here.
+    if (m_workers.empty()) {
+        const auto background_job_count = [this] {
+            std::scoped_lock lock{ m_background_mutex };
+            return m_background_jobs.size();
+        }();
+        for (std::size_t i{ 0 }; i < background_job_count; ++i) {
+            if (auto* job = findBackgroundJob()) {
+                execute(job);
+            }
+        }
+    }
+}
+
+void JobSystem::schedule(Job* job) {
+    // Counted before it is visible, so a worker taking it never sees the count drop below zero.
+    m_queued_jobs.fetch_add(1, std::memory_order_release);
+    if (const auto worker_index = getCurrentWorkerIndex(); worker_index.has_value()) {
+        m_deques[*worker_index]->push(job);
+    } else {
+        std::scoped_lock lock{ m_injected_mutex };
+        m_injected_jobs.push_back(job);
+    }
+    {
+        // Serialises with a worker between checking the count and going to sleep.
+        std::scoped_lock lock{ m_sleep_mutex };
+    }
+    m_sleep_condition.notify_one();
+}
+
+void JobSystem::execute(Job* job) {
+    const auto owned_job = std::unique_ptr<Job>{ job };
+    owned_job->function();
+    finish(owned_job->counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) {
+        return;
+    }
+    // Decrements that cannot be the last one skip the mutex.
+    auto value = counter->m_value.load(std::memory_order_relaxed);
+    while (value > 1) {
+        if (counter->m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+    // Possibly the last job: the continuations are taken out and the count reaches zero under the mutex, so wait and
+    // runAfter see either both or neither.
+    auto continuations = std::vector<Job*>{};
+    {
+        std::scoped_lock lock{ counter->m_mutex };
+        if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        continuations = std::exchange(counter->m_continuations, {});
+    }
+    for (auto* job : continuations) {
+        schedule(job);
+    }
+}
+
+auto JobSystem::findJob(const std::optional<uint32_t> worker_index) -> Job* {
+    // Only the owner may pop from a deque, other threads steal.
+    auto* job = worker_index ? m_deques[*worker_index]->pop() : nullptr;
+    if (!job) {
+        std::scoped_lock lock{ m_injected_mutex };
+        if (!m_injected_jobs.empty()) {
+            job = m_injected_jobs.front();
+            m_injected_jobs.pop_front();
+        }
+    }
+    // Start stealing from the next worker so thieves spread over the victims.
+    const auto first_victim = worker_index ? *worker_index + 1 : 0;
+    for (std::size_t i{ 0 }; !job && i < m_deques.size(); ++i) {
+        const auto victim = (first_victim + i) % m_deques.size();
+        if (victim != worker_index) {
+            job = m_deques[victim]->steal();
+        }
+    }
+    if (job) {
+        m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+auto JobSystem::findBackgroundJob() -> Job* {
+    std::scoped_lock lock{ m_background_mutex };
+    if (m_background_jobs.empty()) {
+        return nullptr;
+    }
+    auto* job = m_background_jobs.front();
+    m_background_jobs.pop_front();
+    m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+auto JobSystem::getCurrentWorkerIndex() const noexcept -> std::optional<uint32_t> {
+    if (t_job_system != this) {
+        return std::nullopt;
+    }
+    return t_worker_index;
+}
+
+void JobSystem::workerLoop(const std::stop_token& stop_token, const uint32_t worker_index) {
+    t_job_system = this;
+    t_worker_index = worker_index;
+    while (!stop_token.stop_requested()) {
+        auto* job = findJob(worker_index);
+        if (job == nullptr) {
+            job = findBackgroundJob();
+        }
+        if (job != nullptr) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock lock{ m_sleep_mutex };
+        m_sleep_condition.wait(
+                lock, stop_token, [this] { return m_queued_jobs.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+}// namespace th
@@ -0,0 +1,157 @@
+export module th.core.job_system;
+
+import std;
+
+namespace th {
+
+export class JobCounter;
+
+struct Job {
+    std::function<void()> function;
+    JobCounter* counter;
+};
+
+// Counts unfinished jobs. Jobs can be made to wait for a counter instead of blocking a worker on it. A counter may
+// only be destroyed once JobSystem::wait returned for it, seeing isDone alone does not mean its last job let go of it.
+export class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) = delete;
+    auto operator=(const JobCounter&) -> JobCounter& = delete;
+    auto operator=(JobCounter&&) -> JobCounter& = delete;
+    ~JobCounter() = default;
+
+    [[nodiscard]] auto isDone() const noexcept -> bool {
+        return m_value.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    std::atomic<uint32_t> m_value{ 0 };
+    // Guards the continuations and the final decrement of the value.
+    mutable std::mutex m_mutex;
+    std::vector<Job*> m_continuations;
+
+    friend class JobSystem;
+};
+
+// Chase-Lev deque: the owning worker pushes and pops at the bottom, other workers steal from the top.
+class WorkStealingDeque {
+    struct Buffer {
+        explicit Buffer(const int64_t capacity)
+            : capacity{ capacity },
+              slots{ std::make_unique<std::atomic<Job*>[]>(static_cast<std::size_t>(capacity)) } {}
+
+        [[nodiscard]] auto get(const int64_t index) const noexcept -> Job* {
+            return slots[static_cast<std::size_t>(index & (capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        void put(const int64_t index, Job* job) noexcept {
+            slots[static_cast<std::size_t>(index & (capacity - 1))].store(job, std::memory_order_relaxed);
+        }
+
+        int64_t capacity;
+        std::unique_ptr<std::atomic<Job*>[]> slots;
+    };
+
+public:
+    explicit WorkStealingDeque(int64_t capacity = 1024);
+
+    void push(Job* job);
+    [[nodiscard]] auto pop() noexcept -> Job*;
+    [[nodiscard]] auto steal() noexcept -> Job*;
+
+private:
+    std::atomic<int64_t> m_top{ 0 };
+    std::atomic<int64_t> m_bottom{ 0 };
+    std::atomic<Buffer*> m_buffer;
+    // Thieves may still read a buffer after it is replaced, so old buffers are kept until the deque is destroyed.
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+// Work-stealing scheduler shared by every subsystem. The thread that creates it takes part as worker 0 while it
+// waits for counters, and is the only thread running jobs submitted with runOnMainThread, e.g. queue submission.
+export class JobSystem {
+public:
+    explicit JobSystem(uint32_t worker_count = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    auto operator=(const JobSystem&) -> JobSystem& = delete;
+    auto operator=(JobSystem&&) -> JobSystem& = delete;
+    ~JobSystem();
+
+    void run(std::function<void()> function, JobCounter* counter = nullptr);
+    // Starts the job once dependency is done without blocking any thread in the meantime.
+    void runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+    void runOnMainThread(std::function<void()> function, JobCounter* counter = nullptr);
+    // For long jobs such as shader compilation or texture decoding. Only spawned workers take them, and only when they
+    // run out of frame work, so they never stall the main thread waiting on a counter. Without spawned workers the
+    // main thread runs them while it waits and from processMainThreadJobs.
+    void runBackground(std::function<void()> function, JobCounter* counter = nullptr);
+
+    // Executes other jobs until the counter is done. Threads that are not workers only take injected jobs and steal.
+    void wait(const JobCounter& counter);
+
+    // Runs the main thread queue, and the background queue when there are no spawned workers. Call it once per frame
+    // from the main thread.
+    void processMainThreadJobs();
+
+    // Calls function(chunk_begin, chunk_end) over [begin, end) split into chunks of at most grain_size and returns
+    // once every chunk is done.
+    template <typename Function>
+        requires std::invocable<Function&, std::size_t, std::size_t>
+    void parallelFor(const std::size_t begin, const std::size_t end, const std::size_t grain_size,
+                     Function&& function) {
+        if (begin >= end) {
+            return;
+        }
+        const auto chunk_size = std::max(grain_size, std::size_t{ 1 });
+        if (end - begin <= chunk_size) {
+            function(begin, end);
+            return;
+        }
+        JobCounter counter;
+        for (auto chunk_begin = begin + chunk_size; chunk_begin < end; chunk_begin += chunk_size) {
+            const auto chunk_end = std::min(chunk_begin + chunk_size, end);
+            run([&function, chunk_begin, chunk_end] { function(chunk_begin, chunk_end); }, &counter);
+        }
+        function(begin, begin + chunk_size);
+        wait(counter);
+    }
+
+    [[nodiscard]] auto getWorkerCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_deques.size());
+    }
+
+private:
+    void schedule(Job* job);
+    void execute(Job* job);
+    void finish(JobCounter* counter);
+    [[nodiscard]] auto findJob(std::optional<uint32_t> worker_index) -> Job*;
+    [[nodiscard]] auto findBackgroundJob() -> Job*;
+    [[nodiscard]] auto getCurrentWorkerIndex() const noexcept -> std::optional<uint32_t>;
+    void workerLoop(const std::stop_token& stop_token, uint32_t worker_index);
+
+private:
+    std::thread::id m_main_thread_id;
+    std::vector<std::unique_ptr<WorkStealingDeque>> m_deques;
+
+    // Jobs submitted from threads that are not workers.
+    std::mutex m_injected_mutex;
+    std::deque<Job*> m_injected_jobs;
+
+    std::mutex m_main_thread_mutex;
+    std::deque<Job*> m_main_thread_jobs;
+
+    std::mutex m_background_mutex;
+    std::deque<Job*> m_background_jobs;
+
+    std::atomic<uint32_t> m_queued_jobs{ 0 };
+    std::mutex m_sleep_mutex;
+    std::condition_variable_any m_sleep_condition;
+
+    std::vector<std::jthread> m_workers;
+};
+
+}// namespace th
@@ -6,6 +6,11 @@ module;
 #include <spdlog/spdlog.h>
 #endif
 
+// Calls below this level are compiled out, 0 keeps everything from trace up.
+#ifndef THYME_LOG_MIN_LEVEL
+#define THYME_LOG_MIN_LEVEL 0
+#endif
+
 export module th.core.logger;
 
 import std;
@@ -26,6 +31,17 @@ export enum struct LogLevel {
     off
 };
 
+export constexpr auto g_min_log_level = static_cast<LogLevel>(THYME_LOG_MIN_LEVEL);
+
+export enum struct LoggerMode {
+    synchronous,
+    // Every message goes through a lock-free ring, in call order, and is written by a background thread. Messages whose
+    // arguments are all numbers or enums are formatted there, anything else is formatted at the call site straight into
+    // the ring cell, cut at its capacity. A full ring makes the caller wait rather than write inline, so messages are
+    // never reordered.
+    asynchronous
+};
+
 #ifndef LOGGER_USE_STD_PRINT
 constexpr auto toSpdLogLevel(const LogLevel level) -> spdlog::level::level_enum {
     switch (level) {
@@ -89,9 +105,179 @@ private:
 template <class... _Args>
 using format_with_source_location = basic_format_with_source_location<std::type_identity_t<_Args>...>;
 
+#ifndef LOGGER_USE_STD_PRINT
+using LogSourceLocation = spdlog::source_loc;
+#else
+using LogSourceLocation = std::source_location;
+#endif
+
+template <typename T>
+concept async_log_argument = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+struct AsyncLogRecord {
+    // Also bounds the text of messages formatted at the call site.
+    static constexpr auto arguments_capacity = 256uz;
+    using Formatter = void (*)(const AsyncLogRecord&, std::string&);
+
+    Formatter formatter;
+    std::string_view format;
+    LogSourceLocation location;
+    LogLevel level;
+    // Taken at the call site, the message may be written much later.
+    std::chrono::system_clock::time_point time;
+    alignas(std::max_align_t) std::array<std::byte, arguments_capacity> arguments;
+};
+
+template <typename... Args>
+constexpr auto getArgumentOffsets() -> std::array<std::size_t, sizeof...(Args) + 1> {
+    auto offsets = std::array<std::size_t, sizeof...(Args) + 1>{};
+    auto offset = 0uz;
+    auto i = 0uz;
+    const auto place = [&](const std::size_t size, const std::size_t alignment) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        offsets[i++] = offset;
+        offset += size;
+    };
+    (place(sizeof(Args), alignof(Args)), ...);
+    offsets[i] = offset;
+    return offsets;
+}
+
+template <typename T>
+auto readArgument(const std::byte* data) noexcept -> T {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename... Args, std::size_t... I>
+void formatAsyncLogRecord(const AsyncLogRecord& record, std::string& message, std::index_sequence<I...>) {
+    constexpr auto offsets = getArgumentOffsets<Args...>();
+    const auto arguments = std::tuple{ readArgument<Args>(record.arguments.data() + offsets[I])... };
+    std::vformat_to(std::back_inserter(message), record.format, std::make_format_args(std::get<I>(arguments)...));
+}
+
+template <typename... Args>
+void formatAsyncLogRecord(const AsyncLogRecord& record, std::string& message) {
+    formatAsyncLogRecord<Args...>(record, message, std::index_sequence_for<Args...>{});
+}
+
+// Messages formatted at the call site carry the untruncated size of the text, followed by as much of it as fits.
+constexpr auto inline_text_offset = sizeof(std::size_t);
+constexpr auto inline_text_capacity = AsyncLogRecord::arguments_capacity - inline_text_offset;
+
+void writeInlineLogRecord(const AsyncLogRecord& record, std::string& message) {
+    const auto size = readArgument<std::size_t>(record.arguments.data());
+    const auto* const text = reinterpret_cast<const char*>(record.arguments.data() + inline_text_offset);
+    message.append(text, std::min(size, inline_text_capacity));
+    if (size > inline_text_capacity) {
+        std::format_to(std::back_inserter(message), "... ({} bytes cut)", size - inline_text_capacity);
+    }
+}
+
+// Bounded multi-producer ring in the style of Vyukov's queue: every cell carries a sequence number telling producers
+// and the consumer whose turn it is, so neither side takes a lock.
+class AsyncLogQueue {
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        AsyncLogRecord record;
+    };
+
+public:
+    explicit AsyncLogQueue(const std::size_t capacity)
+        : m_cells{ std::make_unique<Cell[]>(std::bit_ceil(capacity)) }, m_mask{ std::bit_ceil(capacity) - 1 } {
+        for (auto i = 0uz; i <= m_mask; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    auto tryPush(const AsyncLogRecord& record) noexcept -> bool {
+        auto position = m_enqueue_position.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = m_cells[position & m_mask];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.record = record;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < position) {
+                return false;
+            } else {
+                position = m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer.
+    auto tryPop(AsyncLogRecord& record) noexcept -> bool {
+        auto& cell = m_cells[m_dequeue_position & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != m_dequeue_position + 1) {
+            return false;
+        }
+        record = cell.record;
+        cell.sequence.store(m_dequeue_position + m_mask + 1, std::memory_order_release);
+        ++m_dequeue_position;
+        return true;
+    }
+
+private:
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+    alignas(64) std::atomic<std::size_t> m_enqueue_position{ 0 };
+    alignas(64) std::size_t m_dequeue_position{ 0 };
+};
+
+class AsyncLogBackend {
+public:
+    using Sink = std::function<void(std::chrono::system_clock::time_point, const LogSourceLocation&, LogLevel,
+                                    std::string_view)>;
+
+    explicit AsyncLogBackend(Sink sink, const std::size_t capacity = 8192)
+        : m_queue{ capacity }, m_sink{ std::move(sink) },
+          m_worker{ [this](const std::stop_token& stop_token) { workerLoop(stop_token); } } {}
+
+    // Waits for the writer to free a cell when the ring is full.
+    void push(const AsyncLogRecord& record) noexcept {
+        while (!m_queue.tryPush(record)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    void workerLoop(const std::stop_token& stop_token) {
+        auto message = std::string{};
+        auto record = AsyncLogRecord{};
+        while (true) {
+            if (!m_queue.tryPop(record)) {
+                // Drain everything queued before the logger goes away.
+                if (stop_token.stop_requested()) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            message.clear();
+            try {
+                record.formatter(record, message);
+            } catch (const std::exception& e) {
+                message = std::format("Cannot format log message: {}", e.what());
+            }
+            m_sink(record.time, record.location, record.level, message);
+        }
+    }
+
+    AsyncLogQueue m_queue;
+    Sink m_sink;
+    std::jthread m_worker;
+};
+
+
 export class Logger {
 public:
-    Logger(const LogLevel level, const std::string_view logger_name) {
+    Logger(const LogLevel level, const std::string_view logger_name,
+           const LoggerMode mode = LoggerMode::synchronous) {
 #ifndef LOGGER_USE_STD_PRINT
         m_logger = spdlog::stdout_color_mt(std::string(logger_name));
         m_logger->set_pattern("%^[%T:%e][%n][%l][%@]: %v%$");
@@ -101,86 +287,167 @@ public:
         m_current_log_level = level;
         m_logger_name = logger_name;
 #endif
+        if (mode == LoggerMode::asynchronous) {
+#ifndef LOGGER_USE_STD_PRINT
+            m_async_backend = std::make_shared<AsyncLogBackend>(
+                    [logger = m_logger](const std::chrono::system_clock::time_point time,
+                                        const LogSourceLocation& location,
+                                        const LogLevel message_level,
+                                        const std::string_view message) {
+                        logger->log(time, location, toSpdLogLevel(message_level), message);
+                    });
+#else
+            m_async_backend = std::make_shared<AsyncLogBackend>(
+                    [name = m_logger_name](const std::chrono::system_clock::time_point time,
+                                           const LogSourceLocation& location,
+                                           const LogLevel message_level,
+                                           const std::string_view message) {
+                        printMessage(name, time, location, message_level, message);
+                    });
+#endif
+        }
     }
 
-    template <typename... Args>
-    void trace(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
+    [[nodiscard]] auto isEnabled(const LogLevel level) const noexcept -> bool {
 #ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::trace, full_message);
+        return level >= g_min_log_level && m_logger->should_log(toSpdLogLevel(level));
 #else
-        printMessage(msg.get_location(), LogLevel::trace, full_message);
+        return level >= g_min_log_level && m_current_log_level <= level;
 #endif
     }
 
+    template <typename... Args>
+    void trace(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
+        log<LogLevel::trace, Args...>(msg, std::forward<Args>(args)...);
+    }
+
     template <typename... Args>
     void debug(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
-#ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::debug, full_message);
-#else
-        printMessage(msg.get_location(), LogLevel::debug, full_message);
-#endif
+        log<LogLevel::debug, Args...>(msg, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void info(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
-#ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::info, full_message);
-#else
-        printMessage(msg.get_location(), LogLevel::info, full_message);
-#endif
+        log<LogLevel::info, Args...>(msg, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void warn(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
-#ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::warn, full_message);
-#else
-        printMessage(msg.get_location(), LogLevel::warn, full_message);
-#endif
+        log<LogLevel::warn, Args...>(msg, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void error(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
-#ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::err, full_message);
-#else
-        printMessage(msg.get_location(), LogLevel::err, full_message);
-#endif
+        log<LogLevel::err, Args...>(msg, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void critical(format_with_source_location<Args...> msg, Args&&... args) const noexcept {
-        const auto full_message = std::format(msg.get_format(), std::forward<Args>(args)...);
+        log<LogLevel::critical, Args...>(msg, std::forward<Args>(args)...);
+    }
+
+private:
+    template <LogLevel level, typename... Args>
+    void log(const format_with_source_location<Args...>& msg, Args&&... args) const noexcept {
+        if constexpr (level >= g_min_log_level) {
+            if (!isEnabled(level)) {
+                return;
+            }
+            // A formatter or the allocation of the message may throw, which must not reach the caller.
+            try {
+                if (m_async_backend) {
+                    const auto time = std::chrono::system_clock::now();
+                    if constexpr ((async_log_argument<std::remove_cvref_t<Args>> && ...)
+                                  && getArgumentOffsets<std::remove_cvref_t<Args>...>().back()
+                                             <= AsyncLogRecord::arguments_capacity) {
+                        pushAsync<level, std::remove_cvref_t<Args>...>(msg, time, args...);
+                    } else {
+                        pushInline<level, Args...>(
+                                msg.get_location(), time, msg.get_format(), std::forward<Args>(args)...);
+                    }
+                    return;
+                }
+                write(msg.get_location(), level, std::format(msg.get_format(), std::forward<Args>(args)...));
+            } catch (const std::exception& e) {
+                logFormatError<level>(msg.get_location(), e.what());
+            }
+        }
+    }
+
+    void write(const LogSourceLocation& location, const LogLevel level, const std::string_view message) const {
 #ifndef LOGGER_USE_STD_PRINT
-        m_logger->log(msg.get_location(), spdlog::level::critical, full_message);
+        m_logger->log(location, toSpdLogLevel(level), message);
 #else
-        printMessage(msg.get_location(), LogLevel::critical, full_message);
+        printMessage(m_logger_name, std::chrono::system_clock::now(), location, level, message);
 #endif
     }
 
-private:
+    // Reported in place of the message, formatted into a fixed buffer so that it does not allocate.
+    template <LogLevel level>
+    void logFormatError(const LogSourceLocation& location, const char* const what) const noexcept {
+        try {
+            if (m_async_backend) {
+                pushInline<level>(location, std::chrono::system_clock::now(), "Cannot format log message: {}", what);
+                return;
+            }
+            auto buffer = std::array<char, inline_text_capacity>{};
+            const auto result = std::format_to_n(buffer.data(), buffer.size(), "Cannot format log message: {}", what);
+            const auto size = std::min(buffer.size(), static_cast<std::size_t>(result.size));
+            write(location, level, std::string_view{ buffer.data(), size });
+        } catch (...) {
+            // Nothing is left to report the failure through.
+        }
+    }
+
+    template <LogLevel level, typename... Args, typename Message, typename... Values>
+    void pushAsync(const Message& msg, const std::chrono::system_clock::time_point time,
+                   const Values&... values) const noexcept {
+        constexpr auto offsets = getArgumentOffsets<Args...>();
+        auto record = AsyncLogRecord{ .formatter = &formatAsyncLogRecord<Args...>,
+                                      .format = msg.get_format().get(),
+                                      .location = msg.get_location(),
+                                      .level = level,
+                                      .time = time,
+                                      .arguments = {} };
+        auto i = 0uz;
+        ((std::memcpy(record.arguments.data() + offsets[i++], &values, sizeof(Args))), ...);
+        m_async_backend->push(record);
+    }
+
+    template <LogLevel level, typename... Args>
+    void pushInline(const LogSourceLocation& location, const std::chrono::system_clock::time_point time,
+                    const std::format_string<Args...> format, Args&&... args) const {
+        auto record = AsyncLogRecord{ .formatter = &writeInlineLogRecord,
+                                      .format = {},
+                                      .location = location,
+                                      .level = level,
+                                      .time = time,
+                                      .arguments = {} };
+        auto* const text = reinterpret_cast<char*>(record.arguments.data() + inline_text_offset);
+        const auto size = static_cast<std::size_t>(
+                std::format_to_n(text, inline_text_capacity, format, std::forward<Args>(args)...).size);
+        std::memcpy(record.arguments.data(), &size, sizeof(size));
+        m_async_backend->push(record);
+    }
+
 #ifndef LOGGER_USE_STD_PRINT
     std::shared_ptr<spdlog::logger> m_logger;
 #else
     LogLevel m_current_log_level;
     std::string m_logger_name;
-    void printMessage(const std::source_location& location, const LogLevel level, const std::string_view message) const {
-        if (m_current_log_level <= level) {
-            const auto now = std::chrono::system_clock::now();
-            std::println("[{}][{}][{}][{}]: {}",
-                         now,
-                         m_logger_name,
-                         toString(level),
-                         std::format("{}:{}", location.file_name(), location.line()),
-                         message);
-        }
+    static void printMessage(const std::string_view logger_name, const std::chrono::system_clock::time_point time,
+                             const std::source_location& location, const LogLevel level,
+                             const std::string_view message) {
+        std::println("[{}][{}][{}][{}]: {}",
+                     time,
+                     logger_name,
+                     toString(level),
+                     std::format("{}:{}", location.file_name(), location.line()),
+                     message);
     }
 #endif
+    // Shared so copies of the logger keep writing through the same background thread.
+    std::shared_ptr<AsyncLogBackend> m_async_backend;
 };
 
 }// namespace th
@@ -0,0 +1,158 @@
+export module th.core.slot_map;
+
+import std;
+
+namespace th {
+
+// Reference into a SlotMap. The generation makes handles of erased values stale instead of aliasing whatever value
+// reuses the slot later.
+export template <typename T>
+struct SlotMapHandle {
+    static constexpr auto invalid = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{ invalid };
+    uint32_t generation{ 0 };
+
+    [[nodiscard]] auto isValid() const noexcept -> bool {
+        return index != invalid;
+    }
+
+    auto operator==(const SlotMapHandle&) const noexcept -> bool = default;
+};
+
+// Values are kept densely packed for iteration while handles stay stable: each slot stores where its value currently
+// lives, and erasing moves the last value into the hole. Insert, erase and lookup are O(1).
+export template <typename T>
+class SlotMap {
+public:
+    using Handle = SlotMapHandle<T>;
+
+    auto insert(T&& value) -> Handle {
+        auto slot_index = m_free_head;
+        if (slot_index == Handle::invalid) {
+            slot_index = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        } else {
+            m_free_head = m_slots[slot_index].next;
+        }
+        auto& slot = m_slots[slot_index];
+        slot.next = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_value_slots.push_back(slot_index);
+        return Handle{ .index = slot_index, .generation = slot.generation };
+    }
+
+    template <typename... Args>
+    auto emplace(Args&&... args) -> Handle {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    // Returns false if the handle is stale.
+    auto erase(const Handle handle) -> bool {
+        if (!contains(handle)) {
+            return false;
+        }
+        auto& slot = m_slots[handle.index];
+        const auto value_index = slot.next;
+        if (const auto last_index = static_cast<uint32_t>(m_values.size() - 1); value_index != last_index) {
+            m_values[value_index] = std::move(m_values[last_index]);
+            m_value_slots[value_index] = m_value_slots[last_index];
+            m_slots[m_value_slots[value_index]].next = value_index;
+        }
+        m_values.pop_back();
+        m_value_slots.pop_back();
+
+        ++slot.generation;
+        slot.next = m_free_head;
+        m_free_head = handle.index;
+        return true;
+    }
+
+    [[nodiscard]] auto contains(const Handle handle) const noexcept -> bool {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+    }
+
+    // Null if the handle is stale. The pointer is invalidated by the next insert or erase.
+    [[nodiscard]] auto get(const Handle handle) noexcept -> T* {
+        return contains(handle) ? &m_values[m_slots[handle.index].next] : nullptr;
+    }
+
+    [[nodiscard]] auto get(const Handle handle) const noexcept -> const T* {
+        return contains(handle) ? &m_values[m_slots[handle.index].next] : nullptr;
+    }
+
+    [[nodiscard]] auto at(const Handle handle) -> T& {
+        if (auto* value = get(handle)) {
+            return *value;
+        }
+        throw std::out_of_range(std::format("Stale slot map handle {}:{}", handle.index, handle.generation));
+    }
+
+    [[nodiscard]] auto at(const Handle handle) const -> const T& {
+        if (const auto* value = get(handle)) {
+            return *value;
+        }
+        throw std::out_of_range(std::format("Stale slot map handle {}:{}", handle.index, handle.generation));
+    }
+
+    // Handle of the value at a dense position, e.g. while iterating.
+    [[nodiscard]] auto getHandle(const std::size_t dense_index) const noexcept -> Handle {
+        const auto slot_index = m_value_slots[dense_index];
+        return Handle{ .index = slot_index, .generation = m_slots[slot_index].generation };
+    }
+
+    void reserve(const std::size_t capacity) {
+        m_slots.reserve(capacity);
+        m_values.reserve(capacity);
+        m_value_slots.reserve(capacity);
+    }
+
+    void clear() noexcept {
+        for (const auto slot_index : m_value_slots) {
+            auto& slot = m_slots[slot_index];
+            ++slot.generation;
+            slot.next = m_free_head;
+            m_free_head = slot_index;
+        }
+        m_values.clear();
+        m_value_slots.clear();
+    }
+
+    [[nodiscard]] auto begin() noexcept {
+        return m_values.begin();
+    }
+
+    [[nodiscard]] auto begin() const noexcept {
+        return m_values.begin();
+    }
+
+    [[nodiscard]] auto end() noexcept {
+        return m_values.end();
+    }
+
+    [[nodiscard]] auto end() const noexcept {
+        return m_values.end();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_values.size();
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_values.empty();
+    }
+
+private:
+    struct Slot {
+        // Position of the value while the slot is used, next free slot otherwise.
+        uint32_t next{ Handle::invalid };
+        uint32_t generation{ 0 };
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<T> m_values;
+    std::vector<uint32_t> m_value_slots;
+    uint32_t m_free_head{ Handle::invalid };
+};
+
+}// namespace th
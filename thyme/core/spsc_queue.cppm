@@ -0,0 +1,55 @@
+export module th.core.spsc_queue;
+
+import std;
+
+namespace th {
+
+// Bounded lock-free queue for exactly one producer and one consumer thread. Indices grow monotonically and are
+// wrapped by the power of two capacity; each side only writes its own index.
+export template <typename T, std::size_t Capacity>
+    requires(std::is_trivially_copyable_v<T> && std::has_single_bit(Capacity))
+class SpscQueue {
+    // Kept apart so the producer and the consumer do not invalidate each other's cache line.
+    static constexpr auto cache_line_size = 64uz;
+
+public:
+    // Returns false and drops the value when the queue is full.
+    auto tryPush(const T& value) noexcept -> bool {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head == Capacity) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head == Capacity) {
+                return false;
+            }
+        }
+        m_buffer[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] auto tryPop() noexcept -> std::optional<T> {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail) {
+                return std::nullopt;
+            }
+        }
+        const auto value = m_buffer[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    [[nodiscard]] static constexpr auto capacity() noexcept -> std::size_t {
+        return Capacity;
+    }
+
+private:
+    alignas(cache_line_size) std::atomic<std::size_t> m_head{ 0 };
+    std::size_t m_cached_tail{ 0 };
+    alignas(cache_line_size) std::atomic<std::size_t> m_tail{ 0 };
+    std::size_t m_cached_head{ 0 };
+    alignas(cache_line_size) std::array<T, Capacity> m_buffer{};
+};
+
+}// namespace th
@@ -30,6 +30,38 @@ auto readFile(const std::filesystem::path& file_path) -> Container {
     return buffer;
 }
 
+// 64-bit FNV-1a, used for content keys of cached GPU objects. Not suitable for anything security related.
+export class Fnv1aHasher {
+public:
+    auto add(const std::span<const std::byte> bytes) noexcept -> Fnv1aHasher& {
+        for (const auto byte : bytes) {
+            m_value = (m_value ^ static_cast<uint64_t>(byte)) * prime;
+        }
+        return *this;
+    }
+
+    auto add(const std::string_view text) noexcept -> Fnv1aHasher& {
+        addValue(text.size());
+        return add(std::as_bytes(std::span{ text }));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto addValue(const T& value) noexcept -> Fnv1aHasher& {
+        return add(std::as_bytes(std::span{ &value, 1 }));
+    }
+
+    [[nodiscard]] auto getValue() const noexcept -> uint64_t {
+        return m_value;
+    }
+
+private:
+    static constexpr uint64_t offset_basis = 14695981039346656037ull;
+    static constexpr uint64_t prime = 1099511628211ull;
+
+    uint64_t m_value{ offset_basis };
+};
+
 export template<typename T, typename ... U>
 concept either = (std::same_as<T, U> || ...);
 
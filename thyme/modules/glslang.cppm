@@ -45,6 +45,9 @@ using ::glslang::GlslangToSpv;
 
 using ::glslang::SpvOptions;
 
+using ::glslang::Version;
+using ::glslang::GetVersion;
+
 }// namespace glslang
 
 export namespace spv {
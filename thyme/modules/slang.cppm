@@ -10,6 +10,7 @@ export {
 constexpr auto slang_spirv = SLANG_SPIRV;
 constexpr auto slang_matrix_layout_column_major = SLANG_MATRIX_LAYOUT_COLUMN_MAJOR;
 using ::SlangInt;
+using ::spGetBuildTagString;
 }
 
 export namespace Slang {
@@ -19,6 +20,7 @@ using ::Slang::ComPtr;
 export namespace slang {
 using ::slang::IGlobalSession;
 using ::slang::SessionDesc;
+using ::slang::PreprocessorMacroDesc;
 using ::slang::TargetDesc;
 using ::slang::ISession;
 using ::slang::IModule;
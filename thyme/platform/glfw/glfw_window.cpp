@@ -36,28 +36,28 @@ GlfwWindow::GlfwWindow(const WindowConfig& config, WindowEventsHandlers& event_h
     glfwSetFramebufferSizeCallback(m_window.get(), [](GLFWwindow* window, const int width, const int height) {
         const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
         if (const auto state = (width == 0 || height == 0) ? WindowState::minimalized : WindowState::maximalized;
-            state != glfw_window->m_window_state) {
-            glfw_window->m_window_state = state;
-            glfw_window->m_event_handlers.onEvent(WindowMinimalizedEvent{ .minimized = state == WindowState::minimalized });
+            state != glfw_window->m_window_state.load(std::memory_order_relaxed)) {
+            glfw_window->m_window_state.store(state, std::memory_order_relaxed);
+            glfw_window->enqueueEvent(WindowMinimalizedEvent{ .minimized = state == WindowState::minimalized });
         }
         if (width > 0 && height > 0) {
-            glfw_window->m_event_handlers.onEvent(WindowResizedEvent{ .width = width, .height = height });
+            glfw_window->enqueueEvent(WindowResizedEvent{ .width = width, .height = height });
         }
     });
 
     glfwSetWindowCloseCallback(m_window.get(), [](GLFWwindow* window) {
         const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
-        glfw_window->m_event_handlers.onEvent(WindowClosedEvent{});
+        glfw_window->enqueueEvent(WindowClosedEvent{});
     });
 
     glfwSetCursorPosCallback(m_window.get(), [](GLFWwindow* window, double x, double y) {
         const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
-        glfw_window->m_event_handlers.onEvent(MousePositionEvent{ { x, y } });
+        glfw_window->enqueueEvent(MousePositionEvent{ { x, y } });
     });
 
     glfwSetScrollCallback(m_window.get(), [](GLFWwindow* window, double x, double y) {
         const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
-        glfw_window->m_event_handlers.onEvent(MouseWheelEvent{ { x, y } });
+        glfw_window->enqueueEvent(MouseWheelEvent{ { x, y } });
     });
 
     glfwSetKeyCallback(m_window.get(),
@@ -69,11 +69,11 @@ GlfwWindow::GlfwWindow(const WindowConfig& config, WindowEventsHandlers& event_h
                            const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
                            const auto key_code = static_cast<KeyCode>(key);
                            if (action == glfw_press) {
-                               glfw_window->m_event_handlers.onEvent(KeyPressedEvent{key_code});
+                               glfw_window->enqueueEvent(KeyPressedEvent{key_code});
                            } else if (action == glfw_release) {
-                               glfw_window->m_event_handlers.onEvent(KeyReleasedEvent{key_code});
+                               glfw_window->enqueueEvent(KeyReleasedEvent{key_code});
                            } else if (action == glfw_repeat) {
-                               glfw_window->m_event_handlers.onEvent(KeyRepeatedEvent{key_code});
+                               glfw_window->enqueueEvent(KeyRepeatedEvent{key_code});
                            }
                        });
 
@@ -82,15 +82,15 @@ GlfwWindow::GlfwWindow(const WindowConfig& config, WindowEventsHandlers& event_h
                                    const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
                                    const auto mouse_button = static_cast<MouseButton>(button);
                                    if (action == glfw_press) {
-                                       glfw_window->m_event_handlers.onEvent(MouseButtonPressedEvent{mouse_button});
+                                       glfw_window->enqueueEvent(MouseButtonPressedEvent{mouse_button});
                                    } else if (action == glfw_release) {
-                                       glfw_window->m_event_handlers.onEvent(MouseButtonReleasedEvent{mouse_button});
+                                       glfw_window->enqueueEvent(MouseButtonReleasedEvent{mouse_button});
                                    }
                                });
 
     glfwSetWindowMaximizeCallback(m_window.get(), [](GLFWwindow* window, const int maximize) {
         const auto glfw_window = static_cast<GlfwWindow*>(glfwGetWindowUserPointer(window));
-        glfw_window->m_event_handlers.onEvent(WindowMaximizedEvent{ .maximized = maximize == glfw_true });
+        glfw_window->enqueueEvent(WindowMaximizedEvent{ .maximized = maximize == glfw_true });
     });
 }
 
@@ -23,7 +23,7 @@ export class GlfwWindow final: public Window {
 public:
     explicit GlfwWindow(const WindowConfig& config, WindowEventsHandlers& event_handlers, Logger& logger);
 
-    void poolEvents() override {
+    void pollPlatformEvents() override {
         glfwPollEvents();
     }
 
@@ -4,6 +4,7 @@ import std;
 
 import th.core.events;
 import th.core.logger;
+import th.core.spsc_queue;
 import th.platform.window_event_handler;
 
 namespace th {
@@ -37,21 +38,108 @@ public:
     auto operator=(const Window& window) -> Window& = delete;
     auto operator=(Window&& window) -> Window& = delete;
 
-    virtual void poolEvents() = 0;
+    // Polls the platform and dispatches whatever it produced.
+    void poolEvents() {
+        pollPlatformEvents();
+        flushEvents();
+        processEvents();
+    }
+
+    // Producer side: platform callbacks only enqueue events and update the window state. GLFW only allows polling
+    // from the main thread, so it stays there; the queue keeps the dispatch separate from the platform callbacks.
+    virtual void pollPlatformEvents() = 0;
+
+    // Consumer side: drains the queue and invokes the subscribers.
+    void processEvents();
+
     [[nodiscard]] virtual auto shouldClose() -> bool = 0;
+    // Safe to call from any thread, e.g. the render thread.
     [[nodiscard]] auto isMinimalized() const noexcept -> bool {
-        return m_window_state == WindowState::minimalized;
+        return m_window_state.load(std::memory_order_relaxed) == WindowState::minimalized;
     }
 
     virtual ~Window() = default;
 
 protected:
-    WindowState m_window_state{ WindowState::maximalized };
+    // Consecutive mouse moves and resizes collapse into the latest one and consecutive wheel events are summed, the
+    // result is held back until an event of another kind arrives or the poll ends.
+    void enqueueEvent(const Event& event);
+
+    // Producer side: pushes the held back event and whatever overflowed, called once the platform has been polled.
+    void flushEvents();
+
+    // Written by the platform callbacks during polling.
+    std::atomic<WindowState> m_window_state{ WindowState::maximalized };
     WindowConfig m_config;
 
     WindowEventsHandlers& m_event_handlers;
 
     std::reference_wrapper<Logger> m_logger;
+
+private:
+    // Key and button releases or a close request must never be lost, so events that do not fit wait here, in order,
+    // until the consumer makes room.
+    void pushEvent(const Event& event);
+
+    [[nodiscard]] static auto isCoalescible(const Event& event) noexcept -> bool {
+        return std::holds_alternative<MousePositionEvent>(event) || std::holds_alternative<WindowResizedEvent>(event)
+               || std::holds_alternative<MouseWheelEvent>(event);
+    }
+
+private:
+    SpscQueue<Event, 1024> m_event_queue;
+    // Owned by the producer.
+    std::optional<Event> m_pending_event;
+    std::deque<Event> m_overflow_events;
+    std::atomic<uint32_t> m_overflowed_events{ 0 };
 };
 
+void Window::enqueueEvent(const Event& event) {
+    if (m_pending_event && m_pending_event->index() == event.index()) {
+        if (const auto* wheel = std::get_if<MouseWheelEvent>(&event)) {
+            std::get<MouseWheelEvent>(*m_pending_event).wheel += wheel->wheel;
+        } else {
+            m_pending_event = event;
+        }
+        return;
+    }
+    if (m_pending_event) {
+        pushEvent(*std::exchange(m_pending_event, std::nullopt));
+    }
+    if (isCoalescible(event)) {
+        m_pending_event = event;
+    } else {
+        pushEvent(event);
+    }
+}
+
+void Window::flushEvents() {
+    if (m_pending_event) {
+        pushEvent(*std::exchange(m_pending_event, std::nullopt));
+    }
+    while (!m_overflow_events.empty() && m_event_queue.tryPush(m_overflow_events.front())) {
+        m_overflow_events.pop_front();
+    }
+}
+
+void Window::pushEvent(const Event& event) {
+    while (!m_overflow_events.empty() && m_event_queue.tryPush(m_overflow_events.front())) {
+        m_overflow_events.pop_front();
+    }
+    if (!m_overflow_events.empty() || !m_event_queue.tryPush(event)) {
+        m_overflow_events.push_back(event);
+        m_overflowed_events.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Window::processEvents() {
+    while (const auto event = m_event_queue.tryPop()) {
+        m_event_handlers.onEvent(*event);
+    }
+    if (const auto overflowed_events = m_overflowed_events.exchange(0, std::memory_order_relaxed);
+        overflowed_events > 0) {
+        m_logger.get().warn("Event queue overflowed, {} events were deferred to a later poll", overflowed_events);
+    }
+}
+
 }// namespace th
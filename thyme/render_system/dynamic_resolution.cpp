@@ -0,0 +1,76 @@
+module th.render_system.dynamic_resolution;
+
+import std;
+import vulkan;
+
+namespace th {
+
+constexpr auto time_smoothing = 0.1f;
+// Shares of the GPU time budget. Above the first the scale drops, below the second it rises.
+constexpr auto decrease_threshold = 0.95f;
+constexpr auto increase_threshold = 0.8f;
+// A dropped frame hurts more than a softer image, so decreases react faster than increases.
+constexpr auto decrease_frames = 5u;
+constexpr auto increase_frames = 60u;
+
+DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings& settings)
+    : m_settings{ settings }, m_scale{ quantize(settings.max_scale) } {
+    m_settings.min_scale = std::clamp(m_settings.min_scale, m_settings.scale_step, m_scale);
+}
+
+auto DynamicResolutionController::update(const std::optional<float> gpu_time_ms) -> float {
+    if (!gpu_time_ms.has_value()) {
+        return m_scale;
+    }
+    m_gpu_time_ms = m_gpu_time_ms == 0.0f ? *gpu_time_ms : std::lerp(m_gpu_time_ms, *gpu_time_ms, time_smoothing);
+    if (!m_settings.enabled) {
+        return m_scale;
+    }
+
+    const auto load = m_gpu_time_ms / m_settings.target_gpu_time_ms;
+    const auto trend = [&] {
+        if (load > decrease_threshold && m_scale > m_settings.min_scale) {
+            return -1;
+        }
+        if (load < increase_threshold && m_scale < m_settings.max_scale) {
+            return 1;
+        }
+        return 0;
+    }();
+    if (trend == 0 || trend != m_trend) {
+        m_trend = trend;
+        m_trend_frames = 0;
+        return m_scale;
+    }
+    if (++m_trend_frames < (trend < 0 ? decrease_frames : increase_frames)) {
+        return m_scale;
+    }
+    m_trend_frames = 0;
+
+    // GPU time roughly follows the pixel count, the square of the scale. Aim at the middle of the hysteresis band and
+    // move at least one step.
+    constexpr auto target_load = (decrease_threshold + increase_threshold) * 0.5f;
+    const auto wanted_scale = m_scale * std::sqrt(target_load / load);
+    const auto scale = trend < 0 ? std::min(quantize(wanted_scale), m_scale - m_settings.scale_step)
+                                 : std::max(quantize(wanted_scale), m_scale + m_settings.scale_step);
+    const auto new_scale = std::clamp(quantize(scale), m_settings.min_scale, m_settings.max_scale);
+    // The average was measured at the old scale, predict it for the new one until fresh samples arrive.
+    m_gpu_time_ms *= (new_scale * new_scale) / (m_scale * m_scale);
+    m_scale = new_scale;
+    return m_scale;
+}
+
+auto DynamicResolutionController::getRenderResolution(const vk::Extent2D output_resolution) const noexcept
+        -> vk::Extent2D {
+    const auto scale_size = [this](const uint32_t size) {
+        const auto scaled_size = static_cast<uint32_t>(std::round(static_cast<float>(size) * m_scale));
+        return size == 0 ? 0 : std::clamp(scaled_size, 1u, size);
+    };
+    return vk::Extent2D{ .width = scale_size(output_resolution.width), .height = scale_size(output_resolution.height) };
+}
+
+auto DynamicResolutionController::quantize(const float scale) const noexcept -> float {
+    return std::round(scale / m_settings.scale_step) * m_settings.scale_step;
+}
+
+}// namespace th
@@ -0,0 +1,51 @@
+export module th.render_system.dynamic_resolution;
+
+import std;
+import vulkan;
+
+namespace th {
+
+export struct DynamicResolutionSettings {
+    // A fixed scale of max_scale when disabled.
+    bool enabled{ true };
+    float target_gpu_time_ms{ 1000.0f / 60.0f };
+    float min_scale{ 0.5f };
+    float max_scale{ 1.0f };
+    // The scale moves in multiples of this step, so render targets are only reallocated at a few distinct sizes.
+    float scale_step{ 0.05f };
+};
+
+// Picks the fraction of the output resolution the scene is rendered at from the measured GPU frame time. The scale
+// drops a few frames after the GPU time exceeds the budget, but only rises after a long stretch well below it; the gap
+// between both thresholds and the waits keep it from oscillating, and give the frames still in flight at the old scale
+// time to drain.
+export class DynamicResolutionController {
+public:
+    explicit DynamicResolutionController(const DynamicResolutionSettings& settings);
+
+    // Returns the scale to render the next frame at.
+    auto update(std::optional<float> gpu_time_ms) -> float;
+
+    [[nodiscard]] auto getScale() const noexcept -> float {
+        return m_scale;
+    }
+
+    [[nodiscard]] auto getAverageGpuTime() const noexcept -> float {
+        return m_gpu_time_ms;
+    }
+
+    // The output resolution scaled by the current scale, at least one pixel wide and high unless the output is empty.
+    [[nodiscard]] auto getRenderResolution(vk::Extent2D output_resolution) const noexcept -> vk::Extent2D;
+
+private:
+    [[nodiscard]] auto quantize(float scale) const noexcept -> float;
+
+private:
+    DynamicResolutionSettings m_settings;
+    float m_scale;
+    float m_gpu_time_ms{ 0.0f };
+    int m_trend{ 0 };
+    uint32_t m_trend_frames{ 0 };
+};
+
+}// namespace th
@@ -0,0 +1,99 @@
+module th.render_system.frame_pacing;
+
+import std;
+import vulkan;
+
+namespace th {
+
+// The sleep granularity of common schedulers, the part of the wait that is spun.
+constexpr auto spin_duration = std::chrono::microseconds{ 1500 };
+// Budget of the adaptive controller when no target frame rate is set.
+constexpr auto default_frame_rate = 60.0f;
+constexpr auto time_smoothing = 0.1f;
+constexpr auto trend_frames = 30u;
+constexpr auto shrink_threshold = 0.75f;
+constexpr auto grow_threshold = 0.95f;
+
+auto getPreferredPresentModes(const FramePacingProfile profile) -> std::vector<vk::PresentModeKHR> {
+    switch (profile) {
+        case FramePacingProfile::low_latency:
+            return { vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eFifo };
+        case FramePacingProfile::balanced: return { vk::PresentModeKHR::eFifo };
+        case FramePacingProfile::max_throughput:
+            return { vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eFifo };
+    }
+    std::unreachable();
+}
+
+FrameLimiter::FrameLimiter(const float target_frame_rate) {
+    setTargetFrameRate(target_frame_rate);
+}
+
+void FrameLimiter::setTargetFrameRate(const float target_frame_rate) {
+    const auto period = std::chrono::duration<float>(target_frame_rate > 0.0f ? 1.0f / target_frame_rate : 0.0f);
+    m_period = std::chrono::duration_cast<clock::duration>(period);
+    m_deadline = {};
+}
+
+void FrameLimiter::wait() {
+    if (m_period == clock::duration::zero()) {
+        return;
+    }
+    const auto now = clock::now();
+    if (m_deadline <= now) {
+        // A missed deadline restarts the schedule instead of rushing the following frames to catch up.
+        m_deadline = now + m_period;
+        return;
+    }
+    if (m_deadline - now > spin_duration) {
+        std::this_thread::sleep_until(m_deadline - spin_duration);
+    }
+    while (clock::now() < m_deadline) {
+        std::this_thread::yield();
+    }
+    m_deadline += m_period;
+}
+
+FramePacingController::FramePacingController(const FramePacingSettings& settings)
+    : m_settings{ settings },
+      m_frames_in_flight{ std::clamp(settings.frames_in_flight, 1u, std::max(settings.max_frames_in_flight, 1u)) },
+      m_frame_budget_ms{ 1000.0f
+                         / (settings.target_frame_rate > 0.0f ? settings.target_frame_rate : default_frame_rate) } {
+    if (m_settings.adaptive && m_settings.profile == FramePacingProfile::max_throughput) {
+        m_frames_in_flight = std::max(m_settings.max_frames_in_flight, 1u);
+    }
+}
+
+auto FramePacingController::update(const FrameTimings& timings) -> uint32_t {
+    m_cpu_time_ms = std::lerp(m_cpu_time_ms, timings.cpu_time_ms, time_smoothing);
+    if (timings.gpu_time_ms.has_value()) {
+        m_gpu_time_ms = std::lerp(m_gpu_time_ms, *timings.gpu_time_ms, time_smoothing);
+    }
+    if (!m_settings.adaptive || m_settings.profile == FramePacingProfile::max_throughput) {
+        return m_frames_in_flight;
+    }
+
+    const auto serial_time_ms = m_cpu_time_ms + m_gpu_time_ms;
+    const auto trend = [&] {
+        if (serial_time_ms < m_frame_budget_ms * shrink_threshold && m_frames_in_flight > 1) {
+            return -1;
+        }
+        if (serial_time_ms > m_frame_budget_ms * grow_threshold
+            && m_frames_in_flight < m_settings.max_frames_in_flight) {
+            return 1;
+        }
+        return 0;
+    }();
+    if (trend == 0 || trend != m_trend) {
+        m_trend = trend;
+        m_trend_frames = 0;
+        return m_frames_in_flight;
+    }
+    if (++m_trend_frames >= trend_frames) {
+        m_frames_in_flight = static_cast<uint32_t>(static_cast<int>(m_frames_in_flight) + trend);
+        m_trend_frames = 0;
+    }
+    return m_frames_in_flight;
+}
+
+}// namespace th
@@ -0,0 +1,83 @@
+export module th.render_system.frame_pacing;
+
+import std;
+import vulkan;
+
+namespace th {
+
+export enum struct FramePacingProfile {
+    // Shows the newest frame at the next vblank without tearing, input is sampled as late as possible.
+    low_latency,
+    // Classic vsync, the GPU never renders frames nobody sees.
+    balanced,
+    // Presents immediately and may tear, for offscreen and batch workloads where only throughput counts.
+    max_throughput
+};
+
+export struct FramePacingSettings {
+    FramePacingProfile profile{ FramePacingProfile::balanced };
+    // Frames the CPU may record ahead of the GPU, from 1 up to max_frames_in_flight.
+    uint32_t frames_in_flight{ 2 };
+    uint32_t max_frames_in_flight{ 3 };
+    // Zero leaves the pace to the present mode.
+    float target_frame_rate{ 0.0f };
+    // Tunes frames in flight from the measured CPU and GPU frame times.
+    bool adaptive{ false };
+};
+
+export [[nodiscard]] auto getPreferredPresentModes(FramePacingProfile profile) -> std::vector<vk::PresentModeKHR>;
+
+export struct FrameTimings {
+    float cpu_time_ms;
+    std::optional<float> gpu_time_ms;
+};
+
+// Caps the frame rate with a deadline per frame. The thread sleeps until shortly before the deadline, because sleeps
+// overshoot by up to a scheduler quantum, and spins the remainder.
+export class FrameLimiter {
+    using clock = std::chrono::steady_clock;
+
+public:
+    explicit FrameLimiter(float target_frame_rate = 0.0f);
+
+    void setTargetFrameRate(float target_frame_rate);
+    void wait();
+
+private:
+    clock::duration m_period{ clock::duration::zero() };
+    clock::time_point m_deadline{};
+};
+
+// Chooses how many frames may be in flight. The CPU and GPU only overlap with more than one frame in flight, so while
+// both fit into the frame budget one after another the controller trades the extra frames for latency, and adds them
+// back once the frame no longer fits. Changes need a steady trend over several frames to avoid oscillation.
+export class FramePacingController {
+public:
+    explicit FramePacingController(const FramePacingSettings& settings);
+
+    // Returns the frames in flight to use from the next frame on.
+    auto update(const FrameTimings& timings) -> uint32_t;
+
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> uint32_t {
+        return m_frames_in_flight;
+    }
+
+    [[nodiscard]] auto getAverageCpuTime() const noexcept -> float {
+        return m_cpu_time_ms;
+    }
+
+    [[nodiscard]] auto getAverageGpuTime() const noexcept -> float {
+        return m_gpu_time_ms;
+    }
+
+private:
+    FramePacingSettings m_settings;
+    uint32_t m_frames_in_flight;
+    float m_frame_budget_ms;
+    float m_cpu_time_ms{ 0.0f };
+    float m_gpu_time_ms{ 0.0f };
+    int m_trend{ 0 };
+    uint32_t m_trend_frames{ 0 };
+};
+
+}// namespace th
@@ -0,0 +1,50 @@
+module th.render_system.frame_snapshot;
+
+import std;
+
+namespace th {
+
+auto FrameSnapshotQueue::beginWrite() -> FrameSnapshot* {
+    auto& slot = m_slots[m_write_index];
+    slot.state.wait(SlotState::ready, std::memory_order_acquire);
+    if (slot.state.load(std::memory_order_acquire) == SlotState::stopped) {
+        return nullptr;
+    }
+    return &slot.snapshot;
+}
+
+void FrameSnapshotQueue::publish() {
+    auto& slot = m_slots[m_write_index];
+    auto expected = SlotState::free;
+    if (slot.state.compare_exchange_strong(expected, SlotState::ready, std::memory_order_release)) {
+        slot.state.notify_one();
+    }
+    m_write_index = (m_write_index + 1) % static_cast<uint32_t>(m_slots.size());
+}
+
+auto FrameSnapshotQueue::beginRead() -> FrameSnapshot* {
+    auto& slot = m_slots[m_read_index];
+    slot.state.wait(SlotState::free, std::memory_order_acquire);
+    if (slot.state.load(std::memory_order_acquire) == SlotState::stopped) {
+        return nullptr;
+    }
+    return &slot.snapshot;
+}
+
+void FrameSnapshotQueue::release() {
+    auto& slot = m_slots[m_read_index];
+    auto expected = SlotState::ready;
+    if (slot.state.compare_exchange_strong(expected, SlotState::free, std::memory_order_release)) {
+        slot.state.notify_one();
+    }
+    m_read_index = (m_read_index + 1) % static_cast<uint32_t>(m_slots.size());
+}
+
+void FrameSnapshotQueue::stop() {
+    for (auto& slot : m_slots) {
+        slot.state.store(SlotState::stopped, std::memory_order_release);
+        slot.state.notify_all();
+    }
+}
+
+}// namespace th
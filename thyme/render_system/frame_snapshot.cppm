@@ -0,0 +1,136 @@
+export module th.render_system.frame_snapshot;
+
+import std;
+import glm;
+
+import th.render_system.render_graph;
+import th.render_system.renderer;
+import th.render_system.vulkan;
+import th.scene.scene_graph;
+
+namespace th {
+
+export struct InstanceSubmission {
+    MeshHandle mesh;
+    glm::mat4 world;
+};
+
+export struct NodeSubmission {
+    MeshHandle mesh;
+    SceneNodeHandle node;
+};
+
+export struct TextureSizeRequest {
+    StreamedTextureHandle texture;
+    float screen_size_in_pixels;
+};
+
+// Everything the render stage needs to record a frame. The simulation stage fills it and never touches it again once
+// published, so the render stage can read it without locks.
+export class FrameSnapshot {
+public:
+    void reset(const float dt) {
+        m_dt = dt;
+        m_render_graph.emplace();
+        m_instances.clear();
+        m_node_updates.clear();
+        m_nodes.clear();
+        m_texture_size_requests.clear();
+    }
+
+    void drawInstance(const MeshHandle mesh, const glm::mat4& world) {
+        m_instances.push_back(InstanceSubmission{ .mesh = mesh, .world = world });
+    }
+
+    // Forwarded to Renderer::updateNodeTransforms. Only the nodes that changed this frame, typically
+    // SceneGraph::getUpdatedNodes, have to be passed, the renderer keeps the others.
+    void updateNode(const SceneNodeHandle node, const glm::mat4& world) {
+        m_node_updates.push_back(NodeTransformUpdate{ .node = node, .world = world });
+    }
+
+    void drawNode(const MeshHandle mesh, const SceneNodeHandle node) {
+        m_nodes.push_back(NodeSubmission{ .mesh = mesh, .node = node });
+    }
+
+    // Forwarded to TextureStreamer::requestScreenSize by the render stage, which owns the streamer.
+    void requestTextureSize(const StreamedTextureHandle texture, const float screen_size_in_pixels) {
+        m_texture_size_requests.push_back(
+                TextureSizeRequest{ .texture = texture, .screen_size_in_pixels = screen_size_in_pixels });
+    }
+
+    [[nodiscard]] auto getRenderGraph() noexcept -> RenderGraph& {
+        return *m_render_graph;
+    }
+
+    [[nodiscard]] auto getInstances() const noexcept -> std::span<const InstanceSubmission> {
+        return m_instances;
+    }
+
+    [[nodiscard]] auto getNodeUpdates() const noexcept -> std::span<const NodeTransformUpdate> {
+        return m_node_updates;
+    }
+
+    [[nodiscard]] auto getNodes() const noexcept -> std::span<const NodeSubmission> {
+        return m_nodes;
+    }
+
+    [[nodiscard]] auto getTextureSizeRequests() const noexcept -> std::span<const TextureSizeRequest> {
+        return m_texture_size_requests;
+    }
+
+    [[nodiscard]] auto getDeltaTime() const noexcept -> float {
+        return m_dt;
+    }
+
+    // CPU milliseconds spent filling the snapshot, consumed by frame pacing.
+    void setSimulationTime(const float simulation_time_ms) noexcept {
+        m_simulation_time_ms = simulation_time_ms;
+    }
+
+    [[nodiscard]] auto getSimulationTime() const noexcept -> float {
+        return m_simulation_time_ms;
+    }
+
+private:
+    float m_dt{ 0.0f };
+    float m_simulation_time_ms{ 0.0f };
+    std::optional<RenderGraph> m_render_graph{ std::in_place };
+    std::vector<InstanceSubmission> m_instances;
+    std::vector<NodeTransformUpdate> m_node_updates;
+    std::vector<NodeSubmission> m_nodes;
+    std::vector<TextureSizeRequest> m_texture_size_requests;
+};
+
+// Double-buffered handoff between one simulation and one render thread. Each side owns one slot at a time and only
+// synchronises through the slot state, so the simulation of frame N + 1 overlaps recording of frame N.
+export class FrameSnapshotQueue {
+    enum struct SlotState : uint8_t {
+        free,
+        ready,
+        stopped
+    };
+
+    struct Slot {
+        FrameSnapshot snapshot;
+        std::atomic<SlotState> state{ SlotState::free };
+    };
+
+public:
+    // Waits until the render stage has released the slot. Null once stopped.
+    [[nodiscard]] auto beginWrite() -> FrameSnapshot*;
+    void publish();
+
+    // Waits until the simulation stage has published a snapshot. Null once stopped.
+    [[nodiscard]] auto beginRead() -> FrameSnapshot*;
+    void release();
+
+    // Wakes up both stages; every later begin returns null.
+    void stop();
+
+private:
+    std::array<Slot, 2> m_slots;
+    uint32_t m_write_index{ 0 };
+    uint32_t m_read_index{ 0 };
+};
+
+}// namespace th
@@ -0,0 +1,166 @@
+export module th.render_system.passes:depth_prepass;
+
+import std;
+import glm;
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+import th.render_system.render_graph;
+import th.render_system.vulkan;
+
+import :mypass;
+
+namespace th {
+
+export constexpr auto g_depth_format = vk::Format::eD32Sfloat;
+
+// Maps the [0, 1] depth range of the projection to [1, 0]. With a float depth buffer this spreads the precision
+// evenly over the view distance; passes then test with eGreater and clear depth to 0.
+export [[nodiscard]] auto reverseDepth(const glm::mat4& view_projection) -> glm::mat4 {
+    auto reverse = glm::mat4(1.0f);
+    reverse[2][2] = -1.0f;
+    reverse[3][2] = 1.0f;
+    return reverse * view_projection;
+}
+
+// Lays down the depth of the opaque meshes so colour passes can test with eEqual and shade every pixel once. The depth
+// target is published to the render graph as "depth" for later passes to test against or sample.
+export class DepthPrePass {
+public:
+    DepthPrePass(const vk::raii::Device& device, const vma::raii::Allocator& allocator,
+                 GpuMemoryTracker& memory_tracker, DeferredDeletionQueue& deletion_queue,
+                 PipelineCompiler& pipeline_compiler, BindlessDescriptorHeap& bindless_heap,
+                 const FrameArena& frame_arena, const Logger& logger)
+        : m_bindless_heap{ bindless_heap },
+          m_depth_target{ allocator,
+                          memory_tracker,
+                          device,
+                          deletion_queue,
+                          VulkanImageMemoryCreator(g_depth_format,
+                                                   vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                                           | vk::ImageUsageFlagBits::eSampled,
+                                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                   vk::ImageAspectFlagBits::eDepth,
+                                                   vk::SampleCountFlagBits::e1,
+                                                   1),
+                          "depth" } {
+        try {
+            auto pipeline_builder = VulkanGraphicsPipelineBuilder{};
+            pipeline_builder.setMultisampling(vk::SampleCountFlagBits::e1)
+                    .setColorAttachmentFormats({})
+                    .setDepthAttachmentFormat(g_depth_format)
+                    .enableDepthStencil(vk::PipelineDepthStencilStateCreateInfo{
+                            .depthTestEnable = vk::True,
+                            .depthWriteEnable = vk::True,
+                            .depthCompareOp = vk::CompareOp::eGreater,
+                            .depthBoundsTestEnable = vk::False,
+                            .stencilTestEnable = vk::False,
+                            .minDepthBounds = 0.0f,
+                            .maxDepthBounds = 1.0f })
+                    .setCullMode(vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise)
+                    .setInputTopology(vk::PrimitiveTopology::eTriangleList);
+            m_pipeline = pipeline_compiler.compileGraphicsPipeline(GraphicsPipelineRequest{
+                    .shader_name = "depth_prepass",
+                    .stages = { ShaderStageRequest{ .stage = vk::ShaderStageFlagBits::eVertex } },
+                    .builder = pipeline_builder,
+                    .pipeline_layout = m_bindless_heap.getPipelineLayout(),
+            });
+
+            m_frame_arena_index = m_bindless_heap.registerStorageBuffer(frame_arena.getDescriptorBufferInfo());
+        } catch (std::exception& e) {
+            logger.warn("{}", e.what());
+        }
+    }
+
+    DepthPrePass(const DepthPrePass&) = delete;
+    DepthPrePass(DepthPrePass&&) = delete;
+    auto operator=(const DepthPrePass&) -> DepthPrePass& = delete;
+    auto operator=(DepthPrePass&&) -> DepthPrePass& = delete;
+
+    ~DepthPrePass() {
+        m_bindless_heap.release(BindlessResourceType::storage_buffer, m_frame_arena_index);
+    }
+
+    // The depth target follows the resolution of color_target. view_projection has to be reversed, see reverseDepth.
+    auto setup(RenderGraph& render_graph, const RenderTarget& color_target, const glm::mat4& view_projection)
+            -> RenderGraphResource {
+        const auto depth = render_graph.addTextureResource("depth", m_depth_target);
+        render_graph.addPass("depth_prepass",
+                             [depth, view_projection, &color_target, this](RenderGraphBuilder& builder)
+                                     -> execute_function {
+            // Resized here as the setup runs on the render thread, once the frames using the old image are known.
+            m_depth_target.resize(color_target.getResolution());
+            builder.write(depth,
+                          ImageTransition{
+                                  .layout = vk::ImageLayout::eDepthAttachmentOptimal,
+                                  .pipeline_stage = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+                                                    | vk::PipelineStageFlagBits2::eLateFragmentTests,
+                                  .access_flag_bits = vk::AccessFlagBits2::eDepthStencilAttachmentRead
+                                                      | vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+                          });
+
+            return [=, this](const RenderGraphContext& context, const vk::CommandBuffer command_buffer) -> void {
+                const auto depth_attachment = vk::RenderingAttachmentInfo{
+                    .imageView = m_depth_target.getImageView(),
+                    .imageLayout = vk::ImageLayout::eDepthAttachmentOptimal,
+                    .resolveMode = vk::ResolveModeFlagBits::eNone,
+                    .loadOp = vk::AttachmentLoadOp::eClear,
+                    .storeOp = vk::AttachmentStoreOp::eStore,
+                    .clearValue = vk::ClearValue(vk::ClearDepthStencilValue{ .depth = 0.0f, .stencil = 0 }),
+                };
+                setCommandBufferFrameSize(command_buffer, m_depth_target.getResolution());
+                command_buffer.beginRendering(vk::RenderingInfo{
+                        .renderArea = vk::Rect2D{ .offset = vk::Offset2D{ .x = 0, .y = 0 },
+                                                  .extent = m_depth_target.getResolution() },
+                        .layerCount = 1,
+                        .viewMask = 0,
+                        .colorAttachmentCount = 0,
+                        .pDepthAttachment = &depth_attachment,
+                });
+
+                // Until the pipeline finishes compiling the pass only clears the depth, which the equal test of the
+                // colour passes then rejects.
+                if (m_pipeline.isReady()) {
+                    const auto camera = context.frame_arena.push(view_projection);
+                    draw(PassDrawContext{ .command_buffer = command_buffer,
+                                          .frame_index = context.frame_index,
+                                          .mesh_batches = context.mesh_batches,
+                                          .instance_transforms = context.instance_transforms,
+                                          .camera_offset = camera.offset });
+                }
+
+                command_buffer.endRendering();
+            };
+        });
+        return depth;
+    }
+
+private:
+    void draw(const PassDrawContext& pass_draw_context) const {
+        const auto& [command_buffer, frame_index, mesh_batches, instance_transforms, camera_offset] = pass_draw_context;
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.getPipeline());
+        m_bindless_heap.bind(command_buffer, vk::PipelineBindPoint::eGraphics);
+        for (const auto& [mesh, first_instance, instance_count] : mesh_batches) {
+            const auto push_constant = GpuDrawPushConstants{
+                .address = mesh->address,
+                .frame_arena_index = m_frame_arena_index.index,
+                .camera_offset = camera_offset,
+                .transform_buffer = instance_transforms.transforms,
+                .instance_node_buffer = instance_transforms.instance_nodes,
+                .first_instance = first_instance,
+            };
+            m_bindless_heap.pushConstants(command_buffer, push_constant);
+            command_buffer.bindIndexBuffer(mesh->getIndexBuffer(), 0, vk::IndexType::eUint32);
+            command_buffer.drawIndexed(mesh->indices_size, instance_count, 0, 0, 0);
+        }
+    }
+
+private:
+    BindlessDescriptorHeap& m_bindless_heap;
+    VulkanImageTarget m_depth_target;
+    PipelineHandle m_pipeline;
+    BindlessIndex m_frame_arena_index;
+};
+
+}// namespace th
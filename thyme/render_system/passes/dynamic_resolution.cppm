@@ -0,0 +1,101 @@
+export module th.render_system.passes:dynamic_resolution;
+
+import std;
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+import th.render_system.dynamic_resolution;
+import th.render_system.render_graph;
+import th.render_system.renderer;
+import th.render_system.vulkan;
+
+namespace th {
+
+// Renders the scene into an offscreen target at a fraction of the output resolution and blits it up to the output.
+// The fraction follows the GPU frame time, see DynamicResolutionController.
+export class DynamicResolutionPass {
+public:
+    DynamicResolutionPass(const vk::raii::Device& device, const vma::raii::Allocator& allocator,
+                          GpuMemoryTracker& memory_tracker, DeferredDeletionQueue& deletion_queue,
+                          const Renderer& renderer, const vk::Format format, const DynamicResolutionSettings& settings,
+                          const Logger& logger)
+        : m_renderer{ renderer }, m_logger{ logger }, m_controller{ settings },
+          m_scene_target{ allocator,
+                          memory_tracker,
+                          device,
+                          deletion_queue,
+                          VulkanImageMemoryCreator(format,
+                                                   vk::ImageUsageFlagBits::eColorAttachment
+                                                           | vk::ImageUsageFlagBits::eTransferSrc
+                                                           | vk::ImageUsageFlagBits::eSampled,
+                                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                   vk::ImageAspectFlagBits::eColor,
+                                                   vk::SampleCountFlagBits::e1,
+                                                   1),
+                          "scene color" } {}
+
+    // Scene passes render into the target, which keeps its size for the frame once the graph is compiled.
+    [[nodiscard]] auto getSceneTarget() const noexcept -> const RenderTarget& {
+        return m_scene_target;
+    }
+
+    // Publishes the scene target as "scene_color". The scene passes have to be added between setup and upscale.
+    auto setup(RenderGraph& render_graph, const RenderTarget& output_target) -> RenderGraphResource {
+        const auto scene = render_graph.addTextureResource("scene_color", m_scene_target);
+        render_graph.addPass("dynamic_resolution", [&output_target, this](RenderGraphBuilder&) -> execute_function {
+            // The GPU time is collected on the render thread, where the setup runs as well.
+            const auto previous_scale = m_controller.getScale();
+            if (const auto scale = m_controller.update(m_renderer.getGpuFrameTime()); scale != previous_scale) {
+                m_logger.debug("Render scale {:.2f} -> {:.2f} at {:.2f} ms GPU time",
+                               previous_scale,
+                               scale,
+                               m_controller.getAverageGpuTime());
+            }
+            m_scene_target.resize(m_controller.getRenderResolution(output_target.getResolution()));
+            return [](const RenderGraphContext&, vk::CommandBuffer) -> void {};
+        });
+        return scene;
+    }
+
+    void upscale(RenderGraph& render_graph, const RenderGraphResource scene, const RenderGraphResource output) const {
+        render_graph.addPass("upscale", [scene, output](RenderGraphBuilder& builder) -> execute_function {
+            builder.read(scene,
+                         ImageTransition{
+                                 .layout = vk::ImageLayout::eTransferSrcOptimal,
+                                 .pipeline_stage = vk::PipelineStageFlagBits2::eBlit,
+                                 .access_flag_bits = vk::AccessFlagBits2::eTransferRead,
+                         });
+            builder.write(output,
+                          ImageTransition{
+                                  .layout = vk::ImageLayout::eTransferDstOptimal,
+                                  .pipeline_stage = vk::PipelineStageFlagBits2::eBlit,
+                                  .access_flag_bits = vk::AccessFlagBits2::eTransferWrite,
+                          });
+
+            return [=](const RenderGraphContext& context, const vk::CommandBuffer command_buffer) -> void {
+                const auto& scene_target = std::get<RenderGraphPersistentTarget>(context.targets[scene.id]).target;
+                const auto& output_target = std::get<RenderGraphPersistentTarget>(context.targets[output.id]).target;
+                const auto scene_resolution = scene_target.getResolution();
+                const auto output_resolution = output_target.getResolution();
+                blitImage(command_buffer,
+                          scene_target.getImage(),
+                          vk::Extent3D(scene_resolution.width, scene_resolution.height, 1),
+                          output_target.getImage(),
+                          vk::Extent3D(output_resolution.width, output_resolution.height, 1));
+            };
+        });
+    }
+
+    [[nodiscard]] auto getController() const noexcept -> const DynamicResolutionController& {
+        return m_controller;
+    }
+
+private:
+    const Renderer& m_renderer;
+    const Logger& m_logger;
+    DynamicResolutionController m_controller;
+    VulkanImageTarget m_scene_target;
+};
+
+}// namespace th
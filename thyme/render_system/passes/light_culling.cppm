@@ -0,0 +1,246 @@
+export module th.render_system.passes:light_culling;
+
+import std;
+import glm;
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+import th.scene.camera;
+import th.render_system.render_graph;
+import th.render_system.vulkan;
+
+namespace th {
+
+// Mirrors shaders/slang/clustered_lighting.slang.
+export struct GpuPointLight {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;
+    float intensity;
+};
+
+export struct GpuClusteredLightingConstants {
+    vk::DeviceAddress lights;
+    vk::DeviceAddress clusters;
+    uint32_t frame_arena_index;
+    uint32_t params_offset;
+};
+
+export struct GpuClusterParams {
+    glm::mat4 view;
+    glm::vec4 camera_position;
+    // Tiles along x and y, depth slices, and the capacity of a cluster's light list.
+    glm::uvec4 grid;
+    // Tangents of the horizontal and vertical half fov, near and far planes.
+    glm::vec4 frustum;
+    // Screen size in pixels, scale and bias mapping the log of the view distance to a depth slice.
+    glm::vec4 slicing;
+    uint32_t light_count;
+};
+
+export struct LightClusterSettings {
+    uint32_t tiles_x{ 16 };
+    uint32_t tiles_y{ 9 };
+    uint32_t depth_slices{ 24 };
+    // Lights past this count in a cluster are dropped from it.
+    uint32_t max_lights_per_cluster{ 128 };
+    // Lights past this count in the scene are ignored.
+    uint32_t max_lights{ 4096 };
+};
+
+// Camera state the clusters are built from.
+export struct ClusterView {
+    glm::mat4 view;
+    glm::vec3 position;
+    float tan_half_fov_y;
+    float aspect_ratio;
+    float znear;
+    float zfar;
+};
+
+export [[nodiscard]] auto makeClusterView(const FpsCamera& camera) -> ClusterView {
+    const auto* perspective = std::get_if<PerspectiveCameraArguments>(&camera.getProjectionArguments());
+    if (perspective == nullptr) {
+        throw std::runtime_error("Clustered lighting needs a perspective camera");
+    }
+    return ClusterView{
+        .view = camera.getViewMatrix(),
+        .position = camera.getPosition(),
+        .tan_half_fov_y = std::tan(glm::radians(perspective->fov) * 0.5f),
+        .aspect_ratio = perspective->aspect_ratio,
+        .znear = perspective->znear,
+        .zfar = perspective->zfar,
+    };
+}
+
+// What a shading pass needs to find the lights binned for a frame, see ClusteredLightCulling::pushLightingConstants.
+export struct LightClusterFrame {
+    ClusterView view;
+    uint32_t light_count;
+};
+
+// Clustered forward lighting. The view frustum is split into froxels, screen tiles times exponential depth slices,
+// and a compute pass lists the point lights overlapping each of them. Shading passes then only loop over the lights
+// of the fragment's cluster, so their cost follows the lights touching a pixel rather than the lights in the scene.
+// Lights are uploaded every frame into their own region of a host visible buffer; the cluster lists live in a single
+// device local buffer which is rebuilt once the previous frame's shading finished reading it.
+export class ClusteredLightCulling {
+public:
+    ClusteredLightCulling(const vk::raii::Device& device, const vma::raii::Allocator& allocator,
+                          GpuMemoryTracker& memory_tracker, PipelineCompiler& pipeline_compiler,
+                          BindlessDescriptorHeap& bindless_heap, const FrameArena& frame_arena,
+                          const uint32_t frames_in_flight_count, const LightClusterSettings& settings,
+                          const Logger& logger)
+        : m_bindless_heap{ bindless_heap }, m_settings{ settings },
+          m_light_buffer{ allocator.createBuffer(
+                  vk::BufferCreateInfo{
+                          .size = sizeof(GpuPointLight) * settings.max_lights * frames_in_flight_count,
+                          .usage = vk::BufferUsageFlagBits::eStorageBuffer
+                                   | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                          .sharingMode = vk::SharingMode::eExclusive,
+                  },
+                  vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eHostAccessSequentialWrite,
+                                             .usage = vma::MemoryUsage::eCpuToGpu }) },
+          m_light_memory_tag{ memory_tracker.track(
+                  *m_light_buffer.getAllocation(), GpuMemoryCategory::lighting, "point lights") },
+          m_mapped_lights{ static_cast<GpuPointLight*>(m_light_buffer.getAllocation().map()) },
+          m_lights_address{ device.getBufferAddress(vk::BufferDeviceAddressInfo{ .buffer = m_light_buffer }) },
+          m_cluster_buffer{ allocator.createBuffer(
+                  vk::BufferCreateInfo{
+                          .size = sizeof(uint32_t) * getClusterCount() * (1 + settings.max_lights_per_cluster),
+                          .usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
+                                   | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                          .sharingMode = vk::SharingMode::eExclusive,
+                  },
+                  vma::AllocationCreateInfo{ .usage = vma::MemoryUsage::eAutoPreferDevice }) },
+          m_cluster_memory_tag{ memory_tracker.track(
+                  *m_cluster_buffer.getAllocation(), GpuMemoryCategory::lighting, "light clusters") },
+          m_clusters_address{ device.getBufferAddress(vk::BufferDeviceAddressInfo{ .buffer = m_cluster_buffer }) } {
+        try {
+            m_pipeline = pipeline_compiler.compileComputePipeline(ComputePipelineRequest{
+                    .shader_name = "light_culling",
+                    .pipeline_layout = m_bindless_heap.getPipelineLayout(),
+            });
+
+            m_frame_arena_index = m_bindless_heap.registerStorageBuffer(frame_arena.getDescriptorBufferInfo());
+        } catch (std::exception& e) {
+            logger.warn("{}", e.what());
+        }
+    }
+
+    ClusteredLightCulling(const ClusteredLightCulling&) = delete;
+    ClusteredLightCulling(ClusteredLightCulling&&) = delete;
+    auto operator=(const ClusteredLightCulling&) -> ClusteredLightCulling& = delete;
+    auto operator=(ClusteredLightCulling&&) -> ClusteredLightCulling& = delete;
+
+    ~ClusteredLightCulling() {
+        m_bindless_heap.release(BindlessResourceType::storage_buffer, m_frame_arena_index);
+        m_light_buffer.getAllocation().unmap();
+    }
+
+    [[nodiscard]] auto getClusterCount() const noexcept -> uint32_t {
+        return m_settings.tiles_x * m_settings.tiles_y * m_settings.depth_slices;
+    }
+
+    // The clusters cover the resolution of color_target. Pass the returned frame to the shading passes of the same
+    // render graph, which have to be added after this one.
+    auto setup(RenderGraph& render_graph, std::vector<GpuPointLight> lights, const ClusterView& view,
+               const RenderTarget& color_target) -> LightClusterFrame {
+        if (lights.size() > m_settings.max_lights) {
+            lights.resize(m_settings.max_lights);
+        }
+        const auto frame = LightClusterFrame{ .view = view, .light_count = static_cast<uint32_t>(lights.size()) };
+        render_graph.addPass("light_culling",
+                             [frame, lights = std::move(lights), &color_target, this](RenderGraphBuilder&)
+                                     -> execute_function {
+            return [=, this](const RenderGraphContext& context, const vk::CommandBuffer command_buffer) -> void {
+                std::ranges::copy(lights, m_mapped_lights + context.frame_index * m_settings.max_lights);
+
+                // The render graph only tracks images, the cluster lists are synchronised here. The first barrier
+                // keeps the previous frame's shading reads ahead of the rebuild, the second publishes the lists.
+                const auto before_culling = vk::MemoryBarrier2{
+                    .srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+                    .srcAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+                    .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eClear,
+                    .dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eTransferWrite,
+                };
+                command_buffer.pipelineBarrier2(
+                        vk::DependencyInfo{ .memoryBarrierCount = 1, .pMemoryBarriers = &before_culling });
+
+                if (m_pipeline.isReady()) {
+                    const auto lighting = pushLightingConstants(
+                            context.frame_arena, context.frame_index, frame, color_target.getResolution());
+                    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline.getPipeline());
+                    m_bindless_heap.bind(command_buffer, vk::PipelineBindPoint::eCompute);
+                    m_bindless_heap.pushConstants(command_buffer, lighting);
+                    command_buffer.dispatch((getClusterCount() + group_size - 1) / group_size, 1, 1);
+                } else {
+                    // Until the pipeline finishes compiling every cluster is left empty.
+                    command_buffer.fillBuffer(m_cluster_buffer, 0, sizeof(uint32_t) * getClusterCount(), 0);
+                }
+
+                const auto after_culling = vk::MemoryBarrier2{
+                    .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eClear,
+                    .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eTransferWrite,
+                    .dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+                    .dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead,
+                };
+                command_buffer.pipelineBarrier2(
+                        vk::DependencyInfo{ .memoryBarrierCount = 1, .pMemoryBarriers = &after_culling });
+            };
+        });
+        return frame;
+    }
+
+    // Pushes the cluster parameters of the frame into the arena. Every pass reading the clusters calls this with the
+    // same arguments and gets the layout the culling pass used.
+    [[nodiscard]] auto pushLightingConstants(FrameArena& frame_arena, const uint32_t frame_index,
+                                             const LightClusterFrame& frame, const vk::Extent2D resolution) const
+            -> GpuClusteredLightingConstants {
+        const auto& view = frame.view;
+        const auto slice_scale = static_cast<float>(m_settings.depth_slices) / std::log(view.zfar / view.znear);
+        const auto params = frame_arena.push(GpuClusterParams{
+                .view = view.view,
+                .camera_position = glm::vec4(view.position, 1.0f),
+                .grid = glm::uvec4(m_settings.tiles_x,
+                                   m_settings.tiles_y,
+                                   m_settings.depth_slices,
+                                   m_settings.max_lights_per_cluster),
+                .frustum = glm::vec4(view.tan_half_fov_y * view.aspect_ratio, view.tan_half_fov_y, view.znear,
+                                     view.zfar),
+                .slicing = glm::vec4(static_cast<float>(resolution.width),
+                                     static_cast<float>(resolution.height),
+                                     slice_scale,
+                                     -slice_scale * std::log(view.znear)),
+                .light_count = frame.light_count,
+        });
+        return GpuClusteredLightingConstants{
+            .lights = m_lights_address + sizeof(GpuPointLight) * m_settings.max_lights * frame_index,
+            .clusters = m_clusters_address,
+            .frame_arena_index = m_frame_arena_index.index,
+            .params_offset = params.offset,
+        };
+    }
+
+private:
+    // numthreads of shaders/slang/light_culling.slang.
+    static constexpr auto group_size = uint32_t{ 64 };
+
+    BindlessDescriptorHeap& m_bindless_heap;
+    LightClusterSettings m_settings;
+
+    vma::raii::Buffer m_light_buffer;
+    GpuMemoryTag m_light_memory_tag;
+    GpuPointLight* m_mapped_lights;
+    vk::DeviceAddress m_lights_address;
+
+    vma::raii::Buffer m_cluster_buffer;
+    GpuMemoryTag m_cluster_memory_tag;
+    vk::DeviceAddress m_clusters_address;
+
+    PipelineHandle m_pipeline;
+    BindlessIndex m_frame_arena_index;
+};
+
+}// namespace th
@@ -0,0 +1,82 @@
+export module th.render_system.passes:msaa;
+
+import std;
+import vulkan;
+import vk_mem_alloc;
+
+import th.render_system.render_graph;
+import th.render_system.vulkan;
+
+namespace th {
+
+export struct MultisampleResources {
+    RenderGraphResource color;
+    RenderGraphResource depth;
+};
+
+// Multisampled colour and depth attachments for a pass resolving into a single sampled target. Their contents never
+// outlive the pass: it clears them on load, resolves the colour through resolveImageView and discards both on store.
+// The images are created as transient attachments, so on tiled GPUs the samples stay in tile memory and the images
+// can be placed in lazily allocated memory which is never backed.
+export class MultisampleTargets {
+public:
+    MultisampleTargets(const vk::raii::Device& device, const vma::raii::Allocator& allocator,
+                       GpuMemoryTracker& memory_tracker, DeferredDeletionQueue& deletion_queue,
+                       const vk::Format color_format, const vk::Format depth_format,
+                       const vk::SampleCountFlagBits samples)
+        : m_samples{ samples },
+          m_color_target{ allocator,
+                          memory_tracker,
+                          device,
+                          deletion_queue,
+                          VulkanImageMemoryCreator(color_format,
+                                                   vk::ImageUsageFlagBits::eColorAttachment
+                                                           | vk::ImageUsageFlagBits::eTransientAttachment,
+                                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                   vk::ImageAspectFlagBits::eColor,
+                                                   samples,
+                                                   1),
+                          "msaa color" },
+          m_depth_target{ allocator,
+                          memory_tracker,
+                          device,
+                          deletion_queue,
+                          VulkanImageMemoryCreator(depth_format,
+                                                   vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                                           | vk::ImageUsageFlagBits::eTransientAttachment,
+                                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                   vk::ImageAspectFlagBits::eDepth,
+                                                   samples,
+                                                   1),
+                          "msaa depth" } {}
+
+    [[nodiscard]] auto getSamples() const noexcept -> vk::SampleCountFlagBits {
+        return m_samples;
+    }
+
+    // No image is created until the first setup, so the targets cost nothing while multisampling is off.
+    [[nodiscard]] auto isEnabled() const noexcept -> bool {
+        return m_samples != vk::SampleCountFlagBits::e1;
+    }
+
+    // Publishes the targets as "msaa_color" and "msaa_depth", following the resolution of resolve_target.
+    auto setup(RenderGraph& render_graph, const RenderTarget& resolve_target) -> MultisampleResources {
+        const auto resources = MultisampleResources{
+            .color = render_graph.addTextureResource("msaa_color", m_color_target),
+            .depth = render_graph.addTextureResource("msaa_depth", m_depth_target),
+        };
+        render_graph.addPass("msaa_targets", [&resolve_target, this](RenderGraphBuilder&) -> execute_function {
+            m_color_target.resize(resolve_target.getResolution());
+            m_depth_target.resize(resolve_target.getResolution());
+            return [](const RenderGraphContext&, vk::CommandBuffer) -> void {};
+        });
+        return resources;
+    }
+
+private:
+    vk::SampleCountFlagBits m_samples;
+    VulkanImageTarget m_color_target;
+    VulkanImageTarget m_depth_target;
+};
+
+}// namespace th
@@ -1,176 +1,237 @@
 export module th.render_system.passes:mypass;
 
 import std;
+import glm;
 import vulkan;
 
 import th.core.logger;
 import th.render_system.render_graph;
 import th.render_system.vulkan;
 
+import :light_culling;
+
 namespace th {
 
 export struct PassDrawContext {
     vk::CommandBuffer command_buffer;
     uint32_t frame_index;
-    std::span<const GpuStaticMesh> meshes;
+    std::span<const GpuMeshBatch> mesh_batches;
+    GpuInstanceTransforms instance_transforms;
+    uint32_t camera_offset;
 };
 
 export struct GpuDrawPushConstants {
     vk::DeviceAddress address;
+    uint32_t frame_arena_index;
+    uint32_t camera_offset;
+    uint32_t transform_buffer;
+    uint32_t instance_node_buffer;
+    uint32_t first_instance;
 };
 
-export class MyPass {
-public:
-    MyPass([[maybe_unused]] vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
-           const vk::Format format, std::span<const vk::DescriptorBufferInfo> camera_descriptor_buffer_info,
-           const Logger& logger) {
-        try {
-            const auto slang_shader = compileSlangShader("triangle2");
-
-            const auto shader_module = createShaderModule(device, std::span{ slang_shader }, logger);
-            const auto vertex_shader_stage_info = vk::PipelineShaderStageCreateInfo{
-                .stage = vk::ShaderStageFlagBits::eVertex, .module = shader_module, .pName = "main"
-            };
-
-            const auto frag_shader_stage_info = vk::PipelineShaderStageCreateInfo{
-                .stage = vk::ShaderStageFlagBits::eFragment, .module = shader_module, .pName = "main"
-            };
-
-            constexpr auto ubo_binding =
-                    vk::DescriptorSetLayoutBinding{ .binding = 0,
-                                                    .descriptorType = vk::DescriptorType::eUniformBuffer,
-                                                    .descriptorCount = 1,
-                                                    .stageFlags = vk::ShaderStageFlagBits::eVertex };
-            const auto layout_info = vk::DescriptorSetLayoutCreateInfo{ .bindingCount = 1, .pBindings = &ubo_binding };
-
-            m_descriptor_set_layout = device.createDescriptorSetLayout(layout_info);
-
-            constexpr auto push_constants_buffer_range = vk::PushConstantRange{
-                .stageFlags = vk::ShaderStageFlagBits::eVertex,
-                .offset = 0,
-                .size = sizeof(GpuDrawPushConstants),
-            };
+// Mirrors ForwardPushConstants of shaders/slang/triangle2.slang. The albedo is left out while its texture is invalid.
+export struct GpuForwardPushConstants {
+    GpuDrawPushConstants draw;
+    GpuClusteredLightingConstants lighting;
+    uint32_t albedo_texture;
+    uint32_t albedo_sampler;
+};
 
-            m_pipeline_layout = device.createPipelineLayout(
-                    vk::PipelineLayoutCreateInfo{ .setLayoutCount = 1,
-                                                  .pSetLayouts = &*m_descriptor_set_layout,
-                                                  .pushConstantRangeCount = 1,
-                                                  .pPushConstantRanges = &push_constants_buffer_range });
+// Repeats across the mesh; the streamed image view covers only the resident mips, so the level of detail is not
+// clamped here.
+[[nodiscard]] static auto createAlbedoSampler(const vk::raii::PhysicalDevice& physical_device,
+                                              const vk::raii::Device& device) -> vk::raii::Sampler {
+    return device.createSampler(vk::SamplerCreateInfo{
+            .magFilter = vk::Filter::eLinear,
+            .minFilter = vk::Filter::eLinear,
+            .mipmapMode = vk::SamplerMipmapMode::eLinear,
+            .addressModeU = vk::SamplerAddressMode::eRepeat,
+            .addressModeV = vk::SamplerAddressMode::eRepeat,
+            .addressModeW = vk::SamplerAddressMode::eRepeat,
+            .mipLodBias = 0.0f,
+            .anisotropyEnable = vk::True,
+            .maxAnisotropy = physical_device.getProperties().limits.maxSamplerAnisotropy,
+            .compareEnable = vk::False,
+            .compareOp = vk::CompareOp::eAlways,
+            .minLod = 0.0f,
+            .maxLod = vk::LodClampNone,
+            .borderColor = vk::BorderColor::eIntOpaqueBlack,
+            .unnormalizedCoordinates = vk::False,
+    });
+}
 
+// Single sampled, the pass tests against the depth of a DepthPrePass. Multisampled, color and depth come from
+// MultisampleTargets: the pass writes its own depth, as the transient depth cannot be kept from an earlier pass, and
+// resolves color into resolve.
+export struct MyPassTargets {
+    RenderGraphResource color;
+    RenderGraphResource depth;
+    std::optional<RenderGraphResource> resolve;
+};
 
+export class MyPass {
+public:
+    MyPass(vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+           PipelineCompiler& pipeline_compiler, BindlessDescriptorHeap& bindless_heap, const FrameArena& frame_arena,
+           const uint32_t frames_in_flight_count, const vk::Format format, const vk::Format depth_format,
+           const vk::SampleCountFlagBits samples, const Logger& logger)
+        : m_bindless_heap{ bindless_heap }, m_albedo_sampler{ createAlbedoSampler(physical_device, device) },
+          m_frame_albedo_textures(frames_in_flight_count) {
+        const auto multisampled = samples != vk::SampleCountFlagBits::e1;
+        try {
             const auto color_formats = std::array{ format };
-            const auto pipeline_rendering_create_info = vk::PipelineRenderingCreateInfo{
-                .colorAttachmentCount = static_cast<std::uint32_t>(color_formats.size()),
-                .pColorAttachmentFormats = color_formats.data(),
-            };
-            const auto shader_stages = std::vector{ vertex_shader_stage_info, frag_shader_stage_info };
-            m_pipeline =
-                    VulkanGraphicsPipelineBuilder{}
-                            .setMultisampling(vk::SampleCountFlagBits::e1)
-                            .setColorAttachmentFormats(color_formats)
-                            .disableDepthTest()
-                            // .setDepthAttachmentFormat(pipeline_rendering_create_info.depthAttachmentFormat)
-                            .enableBlending(vk::PipelineColorBlendAttachmentState{
-                                    .blendEnable = vk::False,
-                                    .srcColorBlendFactor = vk::BlendFactor::eOne,
-                                    .dstColorBlendFactor = vk::BlendFactor::eZero,
-                                    .colorBlendOp = vk::BlendOp::eAdd,
-                                    .srcAlphaBlendFactor = vk::BlendFactor::eOne,
-                                    .dstAlphaBlendFactor = vk::BlendFactor::eZero,
-                                    .alphaBlendOp = vk::BlendOp::eAdd,
-                                    .colorWriteMask = vk::ColorComponentFlagBits::eA | vk::ColorComponentFlagBits::eR
-                                                      | vk::ColorComponentFlagBits::eG
-                                                      | vk::ColorComponentFlagBits::eB })
-                            .disableDepthTest()
-                            /*.enableDepthStencil(
-                                    vk::PipelineDepthStencilStateCreateInfo{ .depthTestEnable = vk::True,
-                                                                             .depthWriteEnable = vk::True,
-                                                                             .depthCompareOp = vk::CompareOp::eLess,
-                                                                             .depthBoundsTestEnable = vk::False,
-                                                                             .stencilTestEnable = vk::False,
-                                                                             .front = {},
-                                                                             .back = {},
-                                                                             .minDepthBounds = 0.0f,
-                                                                             .maxDepthBounds = 1.0f })*/
-                            .setCullMode(vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise)
-                            .setShaders(shader_stages)
-                            .setInputTopology(vk::PrimitiveTopology::eTriangleList)
-                            // .setVertexInputState(vertex_input_state_create_info)
-                            .build(device, *m_pipeline_layout);
-
-            // descriptor sets
-            const auto pool_size = vk::DescriptorPoolSize{ .type = vk::DescriptorType::eUniformBuffer,
-                                                           .descriptorCount = static_cast<uint32_t>(
-                                                                   camera_descriptor_buffer_info.size()) };
-            m_descriptor_pool = device.createDescriptorPool(vk::DescriptorPoolCreateInfo{
-                    .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-                    .maxSets = static_cast<uint32_t>(camera_descriptor_buffer_info.size()),
-                    .poolSizeCount = 1,
-                    .pPoolSizes = &pool_size });
-
-            const auto layouts = std::vector(camera_descriptor_buffer_info.size(), *m_descriptor_set_layout);
-            m_descriptor_sets = device.allocateDescriptorSets(
-                    vk::DescriptorSetAllocateInfo{ .descriptorPool = m_descriptor_pool,
-                                                   .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
-                                                   .pSetLayouts = layouts.data() });
-            for (const auto& [buffer_info, descriptor_set] :
-                 std::views::zip(camera_descriptor_buffer_info, m_descriptor_sets)) {
-
-                const auto descriptor_write = vk::WriteDescriptorSet{
-                    .dstSet = descriptor_set,
-                    .dstBinding = 0,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eUniformBuffer,
-                    .pBufferInfo = &buffer_info,
-                };
-                device.updateDescriptorSets({ descriptor_write }, {});
-            }
+            auto pipeline_builder = VulkanGraphicsPipelineBuilder{};
+            pipeline_builder.setMultisampling(samples)
+                    .setColorAttachmentFormats(color_formats)
+                    .setDepthAttachmentFormat(depth_format)
+                    .enableBlending(vk::PipelineColorBlendAttachmentState{
+                            .blendEnable = vk::False,
+                            .srcColorBlendFactor = vk::BlendFactor::eOne,
+                            .dstColorBlendFactor = vk::BlendFactor::eZero,
+                            .colorBlendOp = vk::BlendOp::eAdd,
+                            .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+                            .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+                            .alphaBlendOp = vk::BlendOp::eAdd,
+                            .colorWriteMask = vk::ColorComponentFlagBits::eA | vk::ColorComponentFlagBits::eR
+                                              | vk::ColorComponentFlagBits::eG
+                                              | vk::ColorComponentFlagBits::eB })
+                    // Single sampled, the depth pre-pass already wrote the nearest depth and only the visible
+                    // fragment passes.
+                    .enableDepthStencil(vk::PipelineDepthStencilStateCreateInfo{
+                            .depthTestEnable = vk::True,
+                            .depthWriteEnable = multisampled ? vk::True : vk::False,
+                            .depthCompareOp = multisampled ? vk::CompareOp::eGreater : vk::CompareOp::eEqual,
+                            .depthBoundsTestEnable = vk::False,
+                            .stencilTestEnable = vk::False,
+                            .minDepthBounds = 0.0f,
+                            .maxDepthBounds = 1.0f })
+                    .setCullMode(vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise)
+                    .setInputTopology(vk::PrimitiveTopology::eTriangleList);
+            // .setVertexInputState(vertex_input_state_create_info)
+            m_pipeline = pipeline_compiler.compileGraphicsPipeline(GraphicsPipelineRequest{
+                    .shader_name = "triangle2",
+                    .stages = { ShaderStageRequest{ .stage = vk::ShaderStageFlagBits::eVertex },
+                                ShaderStageRequest{ .stage = vk::ShaderStageFlagBits::eFragment } },
+                    .builder = pipeline_builder,
+                    .pipeline_layout = m_bindless_heap.getPipelineLayout(),
+            });
+
+            m_frame_arena_index = m_bindless_heap.registerStorageBuffer(frame_arena.getDescriptorBufferInfo());
+            m_albedo_sampler_index = m_bindless_heap.registerSampler(m_albedo_sampler);
         } catch (std::exception& e) {
             logger.warn("{}", e.what());
         }
     }
 
-    void draw(const PassDrawContext& pass_draw_context) const {
-        const auto& [command_buffer, frame_index, meshes] = pass_draw_context;
-        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_pipeline);
-        command_buffer.bindDescriptorSets(
-                vk::PipelineBindPoint::eGraphics, *m_pipeline_layout, 0, *m_descriptor_sets[frame_index], nullptr);
-        for (const auto& mesh : meshes) {
-            const auto push_constant = GpuDrawPushConstants{ .address = mesh.address };
-            command_buffer.pushConstants2(vk::PushConstantsInfo{ .layout = m_pipeline_layout,
-                                                                 .stageFlags = vk::ShaderStageFlagBits::eVertex,
-                                                                 .offset = 0,
-                                                                 .size = sizeof(push_constant),
-                                                                 .pValues = &push_constant });
-            command_buffer.bindIndexBuffer(mesh.index_buffer, 0, vk::IndexType::eUint32);
-            command_buffer.drawIndexed(mesh.indices_size, 1, 0, 0, 0);
+    MyPass(const MyPass&) = delete;
+    MyPass(MyPass&&) = delete;
+    auto operator=(const MyPass&) -> MyPass& = delete;
+    auto operator=(MyPass&&) -> MyPass& = delete;
+
+    ~MyPass() {
+        m_bindless_heap.release(BindlessResourceType::storage_buffer, m_frame_arena_index);
+        m_bindless_heap.release(BindlessResourceType::sampler, m_albedo_sampler_index);
+        for (const auto albedo_texture : m_frame_albedo_textures) {
+            m_bindless_heap.release(BindlessResourceType::sampled_image, albedo_texture);
         }
-        command_buffer.draw(3, 1, 0, 0);
     }
 
-    void setup(RenderGraph& render_graph, const RenderGraphResource resource) const {
-        render_graph.addPass("triangle2", [resource, this](RenderGraphBuilder& builder) -> execute_function {
-            builder.write(resource,
-                          ImageTransition{
-                                  .layout = vk::ImageLayout::eColorAttachmentOptimal,
-                                  .pipeline_stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-                                  .access_flag_bits = vk::AccessFlagBits2::eColorAttachmentWrite,
-                          });
-
-            return [=](const RenderGraphContext& context, const vk::CommandBuffer command_buffer) -> void {
-                const auto texture = std::get<RenderGraphPersistentTarget>(context.targets[resource.id]);
+    void draw(const PassDrawContext& pass_draw_context, const GpuClusteredLightingConstants& lighting,
+              const BindlessIndex albedo_texture) const {
+        const auto& [command_buffer, frame_index, mesh_batches, instance_transforms, camera_offset] = pass_draw_context;
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.getPipeline());
+        m_bindless_heap.bind(command_buffer, vk::PipelineBindPoint::eGraphics);
+        for (const auto& [mesh, first_instance, instance_count] : mesh_batches) {
+            const auto push_constant = GpuForwardPushConstants{
+                .draw =
+                        GpuDrawPushConstants{
+                                .address = mesh->address,
+                                .frame_arena_index = m_frame_arena_index.index,
+                                .camera_offset = camera_offset,
+                                .transform_buffer = instance_transforms.transforms,
+                                .instance_node_buffer = instance_transforms.instance_nodes,
+                                .first_instance = first_instance,
+                        },
+                .lighting = lighting,
+                .albedo_texture = albedo_texture.index,
+                .albedo_sampler = m_albedo_sampler_index.index,
+            };
+            m_bindless_heap.pushConstants(command_buffer, push_constant);
+            command_buffer.bindIndexBuffer(mesh->getIndexBuffer(), 0, vk::IndexType::eUint32);
+            command_buffer.drawIndexed(mesh->indices_size, instance_count, 0, 0, 0);
+        }
+    }
+
+    // The meshes are lit by the lights binned by light_culling for the frame and take their albedo from
+    // albedo_texture once its mip tail is resident. Without a resolve target, depth has to hold the depth of the same
+    // meshes drawn with the same view_projection, see DepthPrePass.
+    void setup(RenderGraph& render_graph, const MyPassTargets& targets, const glm::mat4& view_projection,
+               const ClusteredLightCulling& light_culling, const LightClusterFrame& lights,
+               const TextureStreamer& texture_streamer, const StreamedTextureHandle albedo_texture) {
+        render_graph.addPass("triangle2",
+                             [targets, view_projection, &light_culling, lights, &texture_streamer, albedo_texture,
+                              this](RenderGraphBuilder& builder) -> execute_function {
+            const auto color_transition = ImageTransition{
+                .layout = vk::ImageLayout::eColorAttachmentOptimal,
+                .pipeline_stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+                .access_flag_bits = vk::AccessFlagBits2::eColorAttachmentWrite,
+            };
+            if (targets.resolve) {
+                builder.write(targets.depth,
+                              ImageTransition{
+                                      .layout = vk::ImageLayout::eDepthAttachmentOptimal,
+                                      .pipeline_stage = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+                                                        | vk::PipelineStageFlagBits2::eLateFragmentTests,
+                                      .access_flag_bits = vk::AccessFlagBits2::eDepthStencilAttachmentRead
+                                                          | vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+                              });
+                // The resolve runs in the colour attachment output stage, like the colour writes.
+                builder.write(*targets.resolve, color_transition);
+            } else {
+                builder.read(targets.depth,
+                             ImageTransition{
+                                     .layout = vk::ImageLayout::eDepthReadOnlyOptimal,
+                                     .pipeline_stage = vk::PipelineStageFlagBits2::eEarlyFragmentTests
+                                                       | vk::PipelineStageFlagBits2::eLateFragmentTests,
+                                     .access_flag_bits = vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+                             });
+            }
+            builder.write(targets.color, color_transition);
+
+            return [=, &light_culling, &texture_streamer](const RenderGraphContext& context,
+                                                           const vk::CommandBuffer command_buffer) -> void {
+                const auto texture = std::get<RenderGraphPersistentTarget>(context.targets[targets.color.id]);
+                const auto depth_texture = std::get<RenderGraphPersistentTarget>(context.targets[targets.depth.id]);
                 constexpr auto clear_color_values = vk::ClearValue(vk::ClearColorValue(1.0f, 0.0f, 1.0f, 1.0f));
-                const auto color_attachment = vk::RenderingAttachmentInfo{
+                auto color_attachment = vk::RenderingAttachmentInfo{
                     .imageView = texture.target.getImageView(),
                     .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
                     .resolveMode = vk::ResolveModeFlagBits::eNone,
-                    /*.resolveImageView = m_resolve_color_image_memory.getImageView(),
-                    .resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal,*/
                     .loadOp = vk::AttachmentLoadOp::eClear,
                     .storeOp = vk::AttachmentStoreOp::eStore,
                     .clearValue = clear_color_values,
                 };
+                auto depth_attachment = vk::RenderingAttachmentInfo{
+                    .imageView = depth_texture.target.getImageView(),
+                    .imageLayout = vk::ImageLayout::eDepthReadOnlyOptimal,
+                    .resolveMode = vk::ResolveModeFlagBits::eNone,
+                    .loadOp = vk::AttachmentLoadOp::eLoad,
+                    .storeOp = vk::AttachmentStoreOp::eNone,
+                };
+                if (targets.resolve) {
+                    // The samples are only needed until the resolve, so they never have to leave tile memory.
+                    const auto& resolve_texture =
+                            std::get<RenderGraphPersistentTarget>(context.targets[targets.resolve->id]);
+                    color_attachment.resolveMode = vk::ResolveModeFlagBits::eAverage;
+                    color_attachment.resolveImageView = resolve_texture.target.getImageView();
+                    color_attachment.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+                    color_attachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+                    depth_attachment.imageLayout = vk::ImageLayout::eDepthAttachmentOptimal;
+                    depth_attachment.loadOp = vk::AttachmentLoadOp::eClear;
+                    depth_attachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+                    depth_attachment.clearValue =
+                            vk::ClearValue(vk::ClearDepthStencilValue{ .depth = 0.0f, .stencil = 0 });
+                }
                 const auto rendering_info = vk::RenderingInfo{
                     .renderArea = vk::Rect2D{ .offset = vk::Offset2D{ .x = 0, .y = 0 },
                                               .extent = texture.target.getResolution() },
@@ -178,12 +239,24 @@ public:
                     .viewMask = 0,
                     .colorAttachmentCount = 1,
                     .pColorAttachments = &color_attachment,
+                    .pDepthAttachment = &depth_attachment,
                 };
+                setCommandBufferFrameSize(command_buffer, texture.target.getResolution());
                 command_buffer.beginRendering(rendering_info);
 
-                draw(PassDrawContext{ .command_buffer = command_buffer,
-                                      .frame_index = context.frame_index,
-                                      .meshes = context.meshes });
+                // Until the pipeline finishes compiling the pass only clears its target.
+                if (m_pipeline.isReady()) {
+                    const auto camera = context.frame_arena.push(view_projection);
+                    const auto lighting = light_culling.pushLightingConstants(
+                            context.frame_arena, context.frame_index, lights, texture.target.getResolution());
+                    draw(PassDrawContext{ .command_buffer = command_buffer,
+                                          .frame_index = context.frame_index,
+                                          .mesh_batches = context.mesh_batches,
+                                          .instance_transforms = context.instance_transforms,
+                                          .camera_offset = camera.offset },
+                         lighting,
+                         updateFrameAlbedoTexture(context.frame_index, texture_streamer.getImageView(albedo_texture)));
+                }
 
                 command_buffer.endRendering();
             };
@@ -191,11 +264,29 @@ public:
     }
 
 private:
-    vk::raii::PipelineLayout m_pipeline_layout = nullptr;
-    vk::raii::Pipeline m_pipeline = nullptr;
-    vk::raii::DescriptorSetLayout m_descriptor_set_layout = nullptr;
-    vk::raii::DescriptorPool m_descriptor_pool = nullptr;
-    std::vector<vk::raii::DescriptorSet> m_descriptor_sets;
+    // The streamer swaps the view whenever a mip is streamed in or evicted. Each frame in flight has its own slot,
+    // whose last user has completed by the time it is pointed at this frame's view.
+    [[nodiscard]] auto updateFrameAlbedoTexture(const uint32_t frame_index, const vk::ImageView image_view)
+            -> BindlessIndex {
+        if (!image_view) {
+            return BindlessIndex{};
+        }
+        auto& albedo_texture = m_frame_albedo_textures[frame_index];
+        if (albedo_texture.isValid()) {
+            m_bindless_heap.updateSampledImage(albedo_texture, image_view);
+        } else {
+            albedo_texture = m_bindless_heap.registerSampledImage(image_view);
+        }
+        return albedo_texture;
+    }
+
+private:
+    BindlessDescriptorHeap& m_bindless_heap;
+    PipelineHandle m_pipeline;
+    BindlessIndex m_frame_arena_index;
+    vk::raii::Sampler m_albedo_sampler;
+    BindlessIndex m_albedo_sampler_index;
+    std::vector<BindlessIndex> m_frame_albedo_textures;
 };
 
 }// namespace th
@@ -1,3 +1,8 @@
 export module th.render_system.passes;
 
+export import :depth_prepass;
+export import :dynamic_resolution;
+export import :light_culling;
+export import :msaa;
 export import :mypass;
+export import :post_process;
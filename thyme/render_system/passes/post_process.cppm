@@ -0,0 +1,217 @@
+export module th.render_system.passes:post_process;
+
+import std;
+import glm;
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+import th.render_system.render_graph;
+import th.render_system.vulkan;
+
+namespace th {
+
+// Scene colour ahead of post-processing; the float format keeps the range above 1 for the tonemap.
+export constexpr auto g_hdr_color_format = vk::Format::eR16G16B16A16Sfloat;
+
+// In the order the effects are applied, see shaders/slang/post_process.slang.
+export enum struct PostEffect : uint32_t {
+    sharpen = 0,
+    color_grading = 1,
+    vignette = 2,
+    tonemap = 3,
+};
+
+[[nodiscard]] constexpr auto toShaderFeature(const PostEffect effect) -> std::string_view {
+    switch (effect) {
+        case PostEffect::sharpen: return "POST_SHARPEN";
+        case PostEffect::color_grading: return "POST_COLOR_GRADING";
+        case PostEffect::vignette: return "POST_VIGNETTE";
+        case PostEffect::tonemap: return "POST_TONEMAP";
+    }
+    std::unreachable();
+}
+
+export struct PostProcessSettings {
+    float sharpen_strength{ 0.25f };
+    float exposure{ 1.0f };
+    float contrast{ 1.0f };
+    float saturation{ 1.0f };
+    glm::vec3 color_filter{ 1.0f };
+    float vignette_intensity{ 0.35f };
+    // Distances from the centre, 1 being a corner, where the vignette starts and how far it fades in.
+    float vignette_radius{ 0.6f };
+    float vignette_smoothness{ 0.5f };
+};
+
+// Mirrors PostProcessConstants of shaders/slang/post_process.slang.
+export struct GpuPostProcessConstants {
+    glm::vec4 scalars;
+    glm::vec4 color_filter;
+    glm::vec4 vignette;
+    uint32_t input_image;
+    uint32_t output_image;
+};
+
+// Full-screen effects fused into a single compute dispatch. The enabled effects select a variant of one kernel, each
+// combination compiled as its own SPIR-V with the effects of the others left out, so the image is read and written
+// once however many effects run. Variants are compiled when the render graph first uses them.
+export class PostProcessChain {
+public:
+    PostProcessChain(const vk::raii::Device& device, const vma::raii::Allocator& allocator,
+                     GpuMemoryTracker& memory_tracker, DeferredDeletionQueue& deletion_queue,
+                     PipelineCompiler& pipeline_compiler, BindlessDescriptorHeap& bindless_heap,
+                     const uint32_t frames_in_flight_count, const Logger& logger)
+        : m_pipeline_compiler{ pipeline_compiler }, m_bindless_heap{ bindless_heap }, m_logger{ logger },
+          m_output_target{ allocator,
+                           memory_tracker,
+                           device,
+                           deletion_queue,
+                           VulkanImageMemoryCreator(g_hdr_color_format,
+                                                    vk::ImageUsageFlagBits::eStorage
+                                                            | vk::ImageUsageFlagBits::eTransferSrc
+                                                            | vk::ImageUsageFlagBits::eTransferDst,
+                                                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                    vk::ImageAspectFlagBits::eColor,
+                                                    vk::SampleCountFlagBits::e1,
+                                                    1),
+                           "post color" },
+          m_frame_images(frames_in_flight_count) {}
+
+    PostProcessChain(const PostProcessChain&) = delete;
+    PostProcessChain(PostProcessChain&&) = delete;
+    auto operator=(const PostProcessChain&) -> PostProcessChain& = delete;
+    auto operator=(PostProcessChain&&) -> PostProcessChain& = delete;
+
+    ~PostProcessChain() {
+        for (const auto& [input, output] : m_frame_images) {
+            m_bindless_heap.release(BindlessResourceType::sampled_image, input);
+            m_bindless_heap.release(BindlessResourceType::storage_image, output);
+        }
+    }
+
+    // Applies effects to input, in the order of PostEffect whatever their order here, and publishes the result as
+    // "post_color" at the resolution of input_target. The input has to be sampled. Without effects it is returned as
+    // is and no pass is added.
+    auto setup(RenderGraph& render_graph, const RenderGraphResource input, const RenderTarget& input_target,
+               const std::span<const PostEffect> effects, const PostProcessSettings& settings) -> RenderGraphResource {
+        if (effects.empty()) {
+            return input;
+        }
+        const auto features = effects | std::views::transform(toShaderFeature) | std::ranges::to<std::vector>();
+        const auto variant = m_features.getVariant(features);
+        const auto constants = GpuPostProcessConstants{
+            .scalars = glm::vec4(settings.sharpen_strength, settings.exposure, settings.contrast, settings.saturation),
+            .color_filter = glm::vec4(settings.color_filter, 1.0f),
+            .vignette = glm::vec4(settings.vignette_intensity, settings.vignette_radius, settings.vignette_smoothness,
+                                  0.0f),
+            .input_image = BindlessIndex::invalid,
+            .output_image = BindlessIndex::invalid,
+        };
+        const auto output = render_graph.addTextureResource("post_color", m_output_target);
+        render_graph.addPass("post_process",
+                             [input, output, variant, constants, &input_target, this](RenderGraphBuilder& builder)
+                                     -> execute_function {
+            m_output_target.resize(input_target.getResolution());
+            const auto pipeline = getPipeline(variant);
+            builder.read(input,
+                         ImageTransition{
+                                 .layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                                 .pipeline_stage = vk::PipelineStageFlagBits2::eComputeShader,
+                                 .access_flag_bits = vk::AccessFlagBits2::eShaderSampledRead,
+                         });
+            // The clear covers the frames before the kernel is compiled.
+            builder.write(output,
+                          ImageTransition{
+                                  .layout = vk::ImageLayout::eGeneral,
+                                  .pipeline_stage = vk::PipelineStageFlagBits2::eComputeShader
+                                                    | vk::PipelineStageFlagBits2::eClear,
+                                  .access_flag_bits = vk::AccessFlagBits2::eShaderStorageWrite
+                                                      | vk::AccessFlagBits2::eTransferWrite,
+                          });
+
+            return [=, this](const RenderGraphContext& context, const vk::CommandBuffer command_buffer) -> void {
+                if (!pipeline.isReady()) {
+                    command_buffer.clearColorImage(m_output_target.getImage(),
+                                                   vk::ImageLayout::eGeneral,
+                                                   vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f),
+                                                   vk::ImageSubresourceRange{
+                                                           .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                           .baseMipLevel = 0,
+                                                           .levelCount = 1,
+                                                           .baseArrayLayer = 0,
+                                                           .layerCount = 1,
+                                                   });
+                    return;
+                }
+                const auto& input_image = std::get<RenderGraphPersistentTarget>(context.targets[input.id]).target;
+                const auto [input_index, output_index] =
+                        updateFrameImages(context.frame_index, input_image.getImageView());
+                auto push_constants = constants;
+                push_constants.input_image = input_index.index;
+                push_constants.output_image = output_index.index;
+
+                const auto resolution = m_output_target.getResolution();
+                command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline.getPipeline());
+                m_bindless_heap.bind(command_buffer, vk::PipelineBindPoint::eCompute);
+                m_bindless_heap.pushConstants(command_buffer, push_constants);
+                command_buffer.dispatch((resolution.width + group_size - 1) / group_size,
+                                        (resolution.height + group_size - 1) / group_size,
+                                        1);
+            };
+        });
+        return output;
+    }
+
+private:
+    struct FrameImages {
+        BindlessIndex input;
+        BindlessIndex output;
+    };
+
+    [[nodiscard]] auto getPipeline(const uint64_t variant) -> PipelineHandle {
+        if (const auto it = m_pipelines.find(variant); it != m_pipelines.end()) {
+            return it->second;
+        }
+        auto pipeline = PipelineHandle{};
+        try {
+            pipeline = m_pipeline_compiler.compileComputePipeline(ComputePipelineRequest{
+                    .shader_name = "post_process",
+                    .defines = m_features.getDefines(variant),
+                    .pipeline_layout = m_bindless_heap.getPipelineLayout(),
+            });
+        } catch (std::exception& e) {
+            m_logger.warn("{}", e.what());
+        }
+        m_pipelines.emplace(variant, pipeline);
+        return pipeline;
+    }
+
+    // Each frame in flight has its own slots. The frame last using them has completed by the time the slots are
+    // pointed at this frame's images, which may have been recreated by a resize since.
+    [[nodiscard]] auto updateFrameImages(const uint32_t frame_index, const vk::ImageView input) -> FrameImages {
+        auto& [input_index, output_index] = m_frame_images[frame_index];
+        if (input_index.isValid()) {
+            m_bindless_heap.updateSampledImage(input_index, input);
+            m_bindless_heap.updateStorageImage(output_index, m_output_target.getImageView());
+        } else {
+            input_index = m_bindless_heap.registerSampledImage(input);
+            output_index = m_bindless_heap.registerStorageImage(m_output_target.getImageView());
+        }
+        return m_frame_images[frame_index];
+    }
+
+private:
+    // numthreads of shaders/slang/post_process.slang.
+    static constexpr auto group_size = uint32_t{ 8 };
+
+    PipelineCompiler& m_pipeline_compiler;
+    BindlessDescriptorHeap& m_bindless_heap;
+    const Logger& m_logger;
+    ShaderFeatureSet m_features{ { "POST_SHARPEN", "POST_COLOR_GRADING", "POST_VIGNETTE", "POST_TONEMAP" } };
+    std::unordered_map<uint64_t, PipelineHandle> m_pipelines;
+    VulkanImageTarget m_output_target;
+    std::vector<FrameImages> m_frame_images;
+};
+
+}// namespace th
@@ -27,28 +27,34 @@ void th::RenderGraph::compile() {
         RenderGraphBuilder render_graph_builder;
         const auto execute_pass = setup(render_graph_builder);
         auto& [exec, dependency_tracker] = m_execute_passes.emplace_back(execute_pass, DependencyTracker{});
-        for (const auto resources = render_graph_builder.getWriteDependency2();
-             auto& [handle, transition] : resources) {
-            auto& texture = m_resources[handle.id];
-            std::visit(
-                    [&dependency_tracker, transition](auto&& arg) {
-                        using T = std::decay_t<decltype(arg)>;
-                        if constexpr (std::is_same_v<T, RenderGraphPersistentTarget>) {
-                            dependency_tracker.addImageBarrier(arg.target.getImageMemoryBarrier(transition));
-                        }
-                    },
-                    texture);
-        }
+        const auto add_barriers = [this, &dependency_tracker](const auto resources) {
+            for (auto& [handle, transition] : resources) {
+                auto& texture = m_resources[handle.id];
+                std::visit(
+                        [&dependency_tracker, transition](auto&& arg) {
+                            using T = std::decay_t<decltype(arg)>;
+                            if constexpr (std::is_same_v<T, RenderGraphPersistentTarget>) {
+                                dependency_tracker.addImageBarrier(arg.target.getImageMemoryBarrier(transition));
+                            }
+                        },
+                        texture);
+            }
+        };
+        add_barriers(render_graph_builder.getReadDependency2());
+        add_barriers(render_graph_builder.getWriteDependency2());
     }
 }
 void th::RenderGraph::execute(const vk::CommandBuffer command_buffer,
                               const uint32_t frame_index,
-                              const std::span<const GpuStaticMesh>
-                                      meshes) {
+                              const std::span<const GpuMeshBatch> mesh_batches,
+                              const GpuInstanceTransforms instance_transforms,
+                              FrameArena& frame_arena) {
     const RenderGraphContext render_graph_context{
         .frame_index = frame_index,
         .targets = m_resources,
-        .meshes = meshes,
+        .mesh_batches = mesh_batches,
+        .instance_transforms = instance_transforms,
+        .frame_arena = frame_arena,
     };
     for (auto& [exec, dependencies] : m_execute_passes) {
         dependencies.flush(command_buffer);
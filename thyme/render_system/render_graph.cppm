@@ -36,6 +36,13 @@ public:
         return resource;
     }
 
+    // For resources an earlier pass wrote, e.g. depth tested without writes or sampled. The transition makes the
+    // earlier writes visible.
+    auto read(RenderGraphResource resource, const ImageTransition& transition) -> RenderGraphResource {
+        m_read_textures_2.emplace_back(resource, transition);
+        return resource;
+    }
+
     auto getReadDependency() -> std::span<const std::string> {
         return m_read_textures;
     }
@@ -46,12 +53,16 @@ public:
     auto getWriteDependency2() -> std::span<const RenderGraphImageResource2> {
         return m_write_textures_2;
     }
+    auto getReadDependency2() -> std::span<const RenderGraphImageResource2> {
+        return m_read_textures_2;
+    }
 
 private:
     std::vector<std::string> m_read_textures;
     std::vector<RenderGraphImageResource> m_write_textures;
 
     std::vector<RenderGraphImageResource2> m_write_textures_2;
+    std::vector<RenderGraphImageResource2> m_read_textures_2;
 };
 
 struct RenderGraphTextureCreateInfo {
@@ -82,7 +93,9 @@ using RenderGraphTarget = std::variant<RenderGraphPersistentTarget, RenderGraphT
 struct RenderGraphContext {
     uint32_t frame_index;
     std::span<const RenderGraphTarget> targets;
-    std::span<const GpuStaticMesh> meshes;
+    std::span<const GpuMeshBatch> mesh_batches;
+    GpuInstanceTransforms instance_transforms;
+    FrameArena& frame_arena;
 };
 
 using execute_function = std::function<void(const RenderGraphContext&, vk::CommandBuffer)>;
@@ -112,7 +125,8 @@ public:
     void compile();
 
     void execute(const vk::CommandBuffer command_buffer, const uint32_t frame_index,
-                 const std::span<const GpuStaticMesh> meshes);
+                 const std::span<const GpuMeshBatch> mesh_batches, GpuInstanceTransforms instance_transforms,
+                 FrameArena& frame_arena);
 
 private:
     [[nodiscard]] auto getResourceIfExist(std::string_view texture_name) -> std::expected<RenderGraphResource, std::monostate>;
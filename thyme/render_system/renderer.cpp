@@ -4,28 +4,274 @@ module th.render_system.renderer;
 
 namespace th {
 
-Renderer::Renderer(const vk::raii::Device& device,
-                   const std::uint32_t graphic_queue_index, const std::uint32_t max_frames_in_flight, Logger& logger)
+// Per-pass constants only, per-instance data lives in its own buffers sized from the scene.
+constexpr auto frame_arena_size = vk::DeviceSize{ 4 * 1024 * 1024 };
+
+// Rows of the world matrix kept per transform, the last one is always (0, 0, 0, 1).
+constexpr auto transform_rows = 3uz;
+
+static void writeTransform(const glm::mat4& world, glm::vec4* const rows) {
+    const auto transposed = glm::transpose(world);
+    std::copy_n(&transposed[0], transform_rows, rows);
+}
+
+Renderer::Renderer(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                   const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                   BindlessDescriptorHeap& bindless_heap, const std::uint32_t graphic_queue_index,
+                   const std::uint32_t max_frames_in_flight, Logger& logger)
     : m_command_pool(device.createCommandPool(
               vk::CommandPoolCreateInfo{ .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
                                          .queueFamilyIndex = graphic_queue_index })),
-      m_queue(device.getQueue(graphic_queue_index, 0)),
-      m_command_buffers_pool(device, m_command_pool, m_queue, max_frames_in_flight, logger) {
+      m_queue(device.getQueue(graphic_queue_index, 0)), m_mesh_pool(createMeshBufferPool(allocator)),
+      m_command_buffers_pool(device, m_command_pool, m_queue, max_frames_in_flight, logger),
+      m_frame_arena(
+              allocator, memory_tracker, physical_device, device, max_frames_in_flight, frame_arena_size, logger),
+      m_gpu_timer(physical_device, device, graphic_queue_index, max_frames_in_flight, logger),
+      m_frames_in_flight(max_frames_in_flight), m_slot_frame_serials(max_frames_in_flight, 0),
+      m_transform_buffer(allocator,
+                         memory_tracker,
+                         bindless_heap,
+                         m_deletion_queue,
+                         max_frames_in_flight,
+                         "node transforms",
+                         logger),
+      m_instance_node_buffer(allocator,
+                             memory_tracker,
+                             bindless_heap,
+                             m_deletion_queue,
+                             max_frames_in_flight,
+                             "instance nodes",
+                             logger),
+      m_allocator{ allocator }, m_memory_tracker{ memory_tracker }, m_device{ device }, m_logger{ logger },
+      m_frame_node_updates(max_frames_in_flight),
+      m_defragmenter(allocator,
+                     *m_mesh_pool,
+                     device,
+                     graphic_queue_index,
+                     m_deletion_queue,
+                     DefragmentationSettings{},
+                     logger) {}
+
+auto Renderer::addMesh(const vma::raii::Allocator& allocator, const vk::Device device,
+                       const std::span<const uint32_t> indices, const std::span<const Vertex> vertices) -> MeshHandle {
+    if (const auto it = m_mesh_handles.find(hashMeshContent(indices, vertices)); it != m_mesh_handles.end()) {
+        ++m_mesh_references[it->second.index];
+        return it->second;
+    }
+    return addMesh(GpuStaticMesh::create(
+            allocator, m_memory_tracker, device, m_command_pool, m_queue, indices, vertices, *m_mesh_pool));
+}
+
+auto Renderer::addMesh(GpuStaticMesh&& mesh) -> MeshHandle {
+    if (const auto it = m_mesh_handles.find(mesh.content_hash); it != m_mesh_handles.end()) {
+        m_logger.debug("Mesh {:016x} is already resident, sharing it", mesh.content_hash);
+        ++m_mesh_references[it->second.index];
+        return it->second;
+    }
+    const auto content_hash = mesh.content_hash;
+    const auto handle = m_meshes.insert(std::move(mesh));
+    m_mesh_handles.emplace(content_hash, handle);
+    if (handle.index >= m_instances.size()) {
+        m_instances.resize(handle.index + 1);
+        m_mesh_references.resize(handle.index + 1);
+    }
+    m_mesh_references[handle.index] = 1;
+    registerMeshAllocations(handle);
+    return handle;
+}
+
+auto Renderer::removeMesh(const MeshHandle mesh) -> bool {
+    auto* const gpu_mesh = m_meshes.get(mesh);
+    if (gpu_mesh == nullptr) {
+        return false;
+    }
+    if (--m_mesh_references[mesh.index] > 0) {
+        return true;
+    }
+    if (const auto it = m_mesh_handles.find(gpu_mesh->content_hash); it != m_mesh_handles.end() && it->second == mesh) {
+        m_mesh_handles.erase(it);
+    }
+    m_instances[mesh.index].clear();
+    unregisterMeshAllocations(*gpu_mesh);
+    m_defragmenter.retire(std::move(*gpu_mesh));
+    m_meshes.erase(mesh);
+    return true;
+}
+
+void Renderer::replaceMesh(const MeshHandle mesh, const vma::raii::Allocator& allocator, const vk::Device device,
+                           const std::span<const uint32_t> indices, const std::span<const Vertex> vertices) {
+    replaceMesh(mesh,
+                GpuStaticMesh::create(
+                        allocator, m_memory_tracker, device, m_command_pool, m_queue, indices, vertices, *m_mesh_pool));
+}
+
+void Renderer::replaceMesh(const MeshHandle mesh, GpuStaticMesh&& new_mesh) {
+    auto* const gpu_mesh = m_meshes.get(mesh);
+    if (gpu_mesh == nullptr) {
+        throw std::out_of_range(std::format("Cannot replace removed mesh {}:{}", mesh.index, mesh.generation));
+    }
+    if (const auto it = m_mesh_handles.find(gpu_mesh->content_hash); it != m_mesh_handles.end() && it->second == mesh) {
+        m_mesh_handles.erase(it);
+    }
+    // Content equal to another resident mesh stays a separate mesh, every holder of the handle expects the new data.
+    m_mesh_handles.try_emplace(new_mesh.content_hash, mesh);
+    unregisterMeshAllocations(*gpu_mesh);
+    m_defragmenter.retire(std::move(*gpu_mesh));
+    *gpu_mesh = std::move(new_mesh);
+    registerMeshAllocations(mesh);
+}
+
+void Renderer::registerMeshAllocations(const MeshHandle mesh) {
+    const auto& gpu_mesh = m_meshes.at(mesh);
+    for (const auto type : { GpuMeshBufferType::vertex, GpuMeshBufferType::index }) {
+        const auto allocation = gpu_mesh.getAllocation(type);
+        m_defragmenter.registerAllocation(
+                allocation,
+                [this, mesh, type, allocation](const vk::CommandBuffer command_buffer,
+                                               const vma::Allocation destination) -> std::move_only_function<void()> {
+            auto buffer = m_meshes.at(mesh).relocate(m_allocator, m_device, command_buffer, type, destination);
+            return [this, mesh, type, allocation, buffer = std::move(buffer)]() mutable {
+                // The mesh may have been removed or replaced while its copy was in flight.
+                auto* const moved_mesh = m_meshes.get(mesh);
+                if (moved_mesh != nullptr && moved_mesh->getAllocation(type) == allocation) {
+                    m_deletion_queue.retire(moved_mesh->commitRelocation(m_device, type, std::move(buffer)));
+                }
+            };
+        });
+    }
+}
+
+void Renderer::unregisterMeshAllocations(const GpuStaticMesh& mesh) {
+    m_defragmenter.unregisterAllocation(mesh.getAllocation(GpuMeshBufferType::vertex));
+    m_defragmenter.unregisterAllocation(mesh.getAllocation(GpuMeshBufferType::index));
 }
 
 void Renderer::beginFrame(const vk::raii::Device& device, const vk::Semaphore frame_semaphore) {
+    // Waiting on the frame's fence also makes its arena region free to overwrite.
     m_command_buffers_pool.waitFor(device, frame_semaphore);
+    const auto frame_index = getCurrentFrameIndex();
+    const auto capacity = getFramesInFlightCount();
+    m_completed_frame_serial = std::max(m_completed_frame_serial, m_slot_frame_serials[frame_index]);
+    if (m_frames_in_flight < capacity) {
+        // The submission m_frames_in_flight frames back has to finish as well, queue order covers the older ones.
+        const auto oldest_index = (frame_index + capacity - m_frames_in_flight) % capacity;
+        m_command_buffers_pool.wait(device, oldest_index);
+        m_completed_frame_serial = std::max(m_completed_frame_serial, m_slot_frame_serials[oldest_index]);
+    }
+    m_deletion_queue.collect(m_completed_frame_serial);
+    m_defragmenter.update();
+    m_frame_arena.reset(frame_index);
+    if (const auto gpu_frame_time = m_gpu_timer.collect(frame_index); gpu_frame_time.has_value()) {
+        m_gpu_frame_time = gpu_frame_time;
+    }
 }
 
 void Renderer::draw(const vk::raii::Device& device, RenderGraph& render_graph, vk::Extent2D resolution) {
     render_graph.compile();
     const auto command_buffer = m_command_buffers_pool.get().getBuffer(device);
     setCommandBufferFrameSize(command_buffer, resolution);
-    render_graph.execute(command_buffer, getCurrentFrameIndex(), m_meshes);
+    const auto instance_transforms = buildMeshBatches();
+    m_gpu_timer.begin(command_buffer, getCurrentFrameIndex());
+    render_graph.execute(command_buffer, getCurrentFrameIndex(), m_mesh_batches, instance_transforms, m_frame_arena);
+    m_gpu_timer.end(command_buffer, getCurrentFrameIndex());
 }
 
 void Renderer::endFrame(const vk::Semaphore frame_render_semaphore) {
+    const auto frame_serial = m_deletion_queue.submitFrame();
+    m_slot_frame_serials[getCurrentFrameIndex()] = frame_serial;
     m_command_buffers_pool.submit(frame_render_semaphore);
+    m_memory_tracker.endFrame(static_cast<uint32_t>(frame_serial));
+}
+
+void Renderer::updateNodeTransforms(const std::span<const NodeTransformUpdate> updates) {
+    for (const auto& [node, world] : updates) {
+        if (node.id >= m_node_count) {
+            m_node_count = node.id + 1;
+            m_node_transforms.resize(m_node_count * transform_rows);
+        }
+        writeTransform(world, &m_node_transforms[node.id * transform_rows]);
+        for (auto& [nodes, all] : m_frame_node_updates) {
+            if (!all) {
+                nodes.push_back(node.id);
+            }
+        }
+    }
+}
+
+auto Renderer::buildMeshBatches() -> GpuInstanceTransforms {
+    m_mesh_batches.clear();
+    const auto frame_index = getCurrentFrameIndex();
+    const auto transient_count = m_transient_transforms.size();
+    auto& node_updates = m_frame_node_updates[frame_index];
+    if (m_transform_buffer.reserve(frame_index,
+                                   (m_node_count + transient_count) * transform_rows * sizeof(glm::vec4))) {
+        node_updates.all = true;
+    }
+    const auto transforms = std::span{ reinterpret_cast<glm::vec4*>(m_transform_buffer.getData(frame_index).data()),
+                                       (m_node_count + transient_count) * transform_rows };
+    uploadNodeTransforms(transforms, node_updates);
+    for (auto i = 0uz; i < transient_count; ++i) {
+        writeTransform(m_transient_transforms[i], &transforms[(m_node_count + i) * transform_rows]);
+    }
+    m_transient_transforms.clear();
+
+    auto instance_count = 0uz;
+    for (const auto& instances : m_instances) {
+        instance_count += instances.size();
+    }
+    if (instance_count == 0) {
+        return {};
+    }
+
+    m_instance_node_buffer.reserve(frame_index, instance_count * sizeof(uint32_t));
+    auto* const instance_nodes = reinterpret_cast<uint32_t*>(m_instance_node_buffer.getData(frame_index).data());
+    auto first_instance = 0uz;
+    for (auto mesh_index = 0uz; mesh_index < m_meshes.size(); ++mesh_index) {
+        auto& instances = m_instances[m_meshes.getHandle(mesh_index).index];
+        if (instances.empty()) {
+            continue;
+        }
+        for (auto i = 0uz; i < instances.size(); ++i) {
+            const auto instance = instances[i];
+            instance_nodes[first_instance + i] =
+                    (instance & transient_instance_bit) != 0 ? m_node_count + (instance & ~transient_instance_bit)
+                                                             : instance;
+        }
+        m_mesh_batches.push_back(GpuMeshBatch{ .mesh = &*std::next(m_meshes.begin(), mesh_index),
+                                               .first_instance = static_cast<uint32_t>(first_instance),
+                                               .instance_count = static_cast<uint32_t>(instances.size()) });
+        first_instance += instances.size();
+        instances.clear();
+    }
+    return GpuInstanceTransforms{ .transforms = m_transform_buffer.getBindlessIndex(frame_index).index,
+                                  .instance_nodes = m_instance_node_buffer.getBindlessIndex(frame_index).index };
+}
+
+// The frame's previous use has completed, so its buffer only lacks the nodes updated since. They are sorted and
+// written as runs of consecutive nodes, and a frame that missed more updates than there are nodes rewrites them all.
+void Renderer::uploadNodeTransforms(const std::span<glm::vec4> transforms, FrameNodeUpdates& node_updates) const {
+    auto& [nodes, all] = node_updates;
+    if (all || nodes.size() >= m_node_count) {
+        std::ranges::copy(m_node_transforms, transforms.begin());
+    } else {
+        std::ranges::sort(nodes);
+        const auto [first_duplicate, last] = std::ranges::unique(nodes);
+        nodes.erase(first_duplicate, last);
+        for (auto begin = 0uz; begin < nodes.size();) {
+            auto end = begin + 1;
+            while (end < nodes.size() && nodes[end] == nodes[end - 1] + 1) {
+                ++end;
+            }
+            const auto offset = nodes[begin] * transform_rows;
+            const auto count = (end - begin) * transform_rows;
+            std::copy_n(m_node_transforms.begin() + static_cast<std::ptrdiff_t>(offset),
+                        count,
+                        transforms.begin() + static_cast<std::ptrdiff_t>(offset));
+            begin = end;
+        }
+    }
+    nodes.clear();
+    all = false;
 }
 
 }// namespace th
@@ -1,11 +1,15 @@
 export module th.render_system.renderer;
 
 import std;
+import glm;
 import vk_mem_alloc;
 import vulkan;
 
 import th.render_system.vulkan;
 import th.core.logger;
+import th.core.slot_map;
+import th.scene.model;
+import th.scene.scene_graph;
 import th.render_system.render_graph;
 import th.render_system.vulkan;
 
@@ -14,19 +18,59 @@ namespace th {
 export template <typename T>
 class UniformBuffer;
 
+// Stays valid while the mesh is replaced; a removed mesh leaves its handles stale rather than dangling.
+export using MeshHandle = SlotMapHandle<GpuStaticMesh>;
+
+export struct NodeTransformUpdate {
+    SceneNodeHandle node;
+    glm::mat4 world;
+};
+
 export class Renderer {
 public:
-    Renderer(const vk::raii::Device& device, std::uint32_t graphic_queue_index, std::uint32_t max_frames_in_flight,
-             Logger& logger);
+    Renderer(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+             const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+             BindlessDescriptorHeap& bindless_heap, std::uint32_t graphic_queue_index,
+             std::uint32_t max_frames_in_flight, Logger& logger);
 
     [[nodiscard]] auto getCurrentFrameIndex() const noexcept -> uint32_t {
         return m_command_buffers_pool.currentIndex();
     }
 
+    // Capacity of the per-frame resources, the upper bound of setFramesInFlight.
     [[nodiscard]] auto getFramesInFlightCount() const noexcept -> uint32_t {
         return static_cast<uint32_t>(m_command_buffers_pool.size());
     }
 
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> uint32_t {
+        return m_frames_in_flight;
+    }
+
+    // Limits how many frames the CPU may record ahead of the GPU. Fewer frames lower the input latency, more let the
+    // CPU and GPU overlap. Takes effect from the next beginFrame without waiting for the device to idle.
+    void setFramesInFlight(const uint32_t frames_in_flight) noexcept {
+        m_frames_in_flight = std::clamp(frames_in_flight, 1u, getFramesInFlightCount());
+    }
+
+    // GPU time of the most recently completed frame, if the queue supports timestamps.
+    [[nodiscard]] auto getGpuFrameTime() const noexcept -> std::optional<float> {
+        return m_gpu_frame_time;
+    }
+
+    // Per-frame constants pushed here are valid until the same frame index comes round again.
+    [[nodiscard]] auto getFrameArena() noexcept -> FrameArena& {
+        return m_frame_arena;
+    }
+
+    // Objects retired here are destroyed once the frames recorded so far have completed on the GPU.
+    [[nodiscard]] auto getDeletionQueue() noexcept -> DeferredDeletionQueue& {
+        return m_deletion_queue;
+    }
+
+    [[nodiscard]] auto getMemoryTracker() noexcept -> GpuMemoryTracker& {
+        return m_memory_tracker;
+    }
+
     template <typename T>
     [[nodiscard]] auto createUniformBuffer(const vma::raii::Allocator& allocator) -> UniformBuffer<T>;
 
@@ -34,24 +78,119 @@ public:
     void draw(const vk::raii::Device& device, RenderGraph& render_graph, vk::Extent2D resolution);
     void endFrame(vk::Semaphore frame_render_semaphore);
 
-    void addMesh(GpuStaticMesh&& mesh) {
-        m_meshes.push_back(std::forward<GpuStaticMesh>(mesh));
+    // The command buffer of the current frame, for uploads recorded between beginFrame and draw.
+    [[nodiscard]] auto getCommandBuffer(const vk::raii::Device& device) -> vk::CommandBuffer {
+        return m_command_buffers_pool.get().getBuffer(device);
+    }
+
+    // Uploads the mesh unless a mesh with the same content is already resident, in which case its handle is returned.
+    // Shared meshes are reference counted, each addMesh has to be paired with a removeMesh.
+    [[nodiscard]] auto addMesh(const vma::raii::Allocator& allocator, vk::Device device,
+                               std::span<const uint32_t> indices, std::span<const Vertex> vertices) -> MeshHandle;
+    auto addMesh(GpuStaticMesh&& mesh) -> MeshHandle;
+
+    // The buffers of removed or replaced meshes are destroyed once the frames in flight that may draw them completed.
+    // Like addMesh these must be called from the thread recording frames. Returns false if the handle is stale.
+    auto removeMesh(MeshHandle mesh) -> bool;
+    void replaceMesh(MeshHandle mesh, const vma::raii::Allocator& allocator, vk::Device device,
+                     std::span<const uint32_t> indices, std::span<const Vertex> vertices);
+    void replaceMesh(MeshHandle mesh, GpuStaticMesh&& new_mesh);
+
+    // Compacts the mesh allocations incrementally over the next frames, see GpuMemoryDefragmenter.
+    void defragmentMemory() {
+        m_defragmenter.start();
     }
 
+    [[nodiscard]] auto getDefragmenter() noexcept -> GpuMemoryDefragmenter& {
+        return m_defragmenter;
+    }
+
+    [[nodiscard]] auto containsMesh(const MeshHandle mesh) const noexcept -> bool {
+        return m_meshes.contains(mesh);
+    }
+
+    // Scene node transforms persist across frames in a buffer per frame in flight, so only the nodes passed here are
+    // uploaded, to each of those buffers the next time its frame is recorded.
+    void updateNodeTransforms(std::span<const NodeTransformUpdate> updates);
+
+    // Queues one instance of the mesh drawn with the transform of the node for the next draw. All instances of a mesh
+    // are issued as a single draw. Instances of removed meshes, or of nodes without a transform yet, are dropped.
+    void drawNode(const MeshHandle mesh, const SceneNodeHandle node) {
+        if (m_meshes.contains(mesh) && node.id < m_node_count) {
+            m_instances[mesh.index].push_back(node.id);
+        }
+    }
+
+    // Same as drawNode for a transform that is not part of the scene; it is uploaded with the frame.
+    void drawInstance(const MeshHandle mesh, const glm::mat4& world) {
+        if (m_meshes.contains(mesh)) {
+            const auto transient_index = static_cast<uint32_t>(m_transient_transforms.size());
+            m_instances[mesh.index].push_back(transient_instance_bit | transient_index);
+            m_transient_transforms.push_back(world);
+        }
+    }
 
     vk::raii::CommandPool m_command_pool;
 private:
     vk::raii::Queue m_queue;
+    // Mesh buffers, including the ones waiting in the deletion queue, are allocated from it.
+    vma::raii::Pool m_mesh_pool;
     VulkanCommandBuffersPool2 m_command_buffers_pool;
-
-    std::vector<GpuStaticMesh> m_meshes;
+    FrameArena m_frame_arena;
+    GpuFrameTimer m_gpu_timer;
+    uint32_t m_frames_in_flight;
+    std::optional<float> m_gpu_frame_time;
+    DeferredDeletionQueue m_deletion_queue;
+    // Serial of the frame last submitted from each command buffer slot.
+    std::vector<uint64_t> m_slot_frame_serials;
+    uint64_t m_completed_frame_serial{ 0 };
+    // Node transforms followed by the frame's transient transforms, and the index of every instance's transform. The
+    // frame arena only holds the small per-pass constants.
+    FrameStorageBuffer m_transform_buffer;
+    FrameStorageBuffer m_instance_node_buffer;
+
+    struct FrameNodeUpdates {
+        std::vector<uint32_t> nodes;
+        // Set while the frame's transform buffer holds nothing, either new or reallocated.
+        bool all{ true };
+    };
+
+    // Marks instances drawn with a transient transform, the other bits index m_transient_transforms.
+    static constexpr auto transient_instance_bit = uint32_t{ 1 } << 31;
+
+    [[nodiscard]] auto buildMeshBatches() -> GpuInstanceTransforms;
+    void uploadNodeTransforms(std::span<glm::vec4> transforms, FrameNodeUpdates& node_updates) const;
+    void registerMeshAllocations(MeshHandle mesh);
+    void unregisterMeshAllocations(const GpuStaticMesh& mesh);
+
+    const vma::raii::Allocator& m_allocator;
+    GpuMemoryTracker& m_memory_tracker;
+    const vk::raii::Device& m_device;
+    Logger& m_logger;
+
+    SlotMap<GpuStaticMesh> m_meshes;
+    std::unordered_map<uint64_t, MeshHandle> m_mesh_handles;
+    // Indexed by the slot of the mesh handle, the node or transient transform of each instance. Instances are cleared
+    // every frame but keep their capacity.
+    std::vector<std::vector<uint32_t>> m_instances;
+    std::vector<glm::mat4> m_transient_transforms;
+    // The first three rows of every node's world matrix, the source of the uploads to the frames' transform buffers.
+    std::vector<glm::vec4> m_node_transforms;
+    uint32_t m_node_count{ 0 };
+    // Nodes updated since each frame in flight was last recorded.
+    std::vector<FrameNodeUpdates> m_frame_node_updates;
+    std::vector<uint32_t> m_mesh_references;
+    std::vector<GpuMeshBatch> m_mesh_batches;
+    // Declared last: a pass still running at shutdown has to end before the meshes free their allocations.
+    GpuMemoryDefragmenter m_defragmenter;
 };
 
 template <typename T>
 class UniformBuffer {
 public:
     UniformBuffer(Renderer& renderer, const vma::raii::Allocator& allocator)
-        : m_renderer(renderer), m_uniform_buffer_array(allocator, renderer.getFramesInFlightCount()) {}
+        : m_renderer(renderer),
+          m_uniform_buffer_array(allocator, renderer.getMemoryTracker(), renderer.getFramesInFlightCount()) {}
 
     void update(const T& value) {
         m_uniform_buffer_array.update(value, m_renderer.getCurrentFrameIndex());
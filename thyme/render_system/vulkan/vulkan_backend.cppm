@@ -8,15 +8,26 @@ import vulkan;
 import th.core.logger;
 
 export import :gui;
+export import :bindless;
 export import :buffer;
 export import :command_buffers;
+export import :deletion_queue;
 export import :device;
+export import :frame_arena;
+export import :frame_storage_buffer;
+export import :gpu_timer;
 export import :framework;
 export import :graphic_context;
 export import :graphic_pipeline;
+export import :memory_defragmenter;
+export import :memory_tracker;
 export import :model;
+export import :pipeline_cache;
+export import :pipeline_compiler;
 export import :shader;
+export import :shader_cache;
 export import :swapchain;
 export import :texture;
+export import :texture_streaming;
 export import :uniform_buffer_object;
 export import :utils;
@@ -0,0 +1,213 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+constexpr auto toDescriptorType(const BindlessResourceType type) -> vk::DescriptorType {
+    switch (type) {
+        case BindlessResourceType::sampled_image: return vk::DescriptorType::eSampledImage;
+        case BindlessResourceType::storage_image: return vk::DescriptorType::eStorageImage;
+        case BindlessResourceType::sampler: return vk::DescriptorType::eSampler;
+        case BindlessResourceType::storage_buffer: return vk::DescriptorType::eStorageBuffer;
+    }
+    std::unreachable();
+}
+
+constexpr auto toString(const BindlessResourceType type) -> std::string_view {
+    switch (type) {
+        case BindlessResourceType::sampled_image: return "sampled image";
+        case BindlessResourceType::storage_image: return "storage image";
+        case BindlessResourceType::sampler: return "sampler";
+        case BindlessResourceType::storage_buffer: return "storage buffer";
+    }
+    std::unreachable();
+}
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(const vk::raii::PhysicalDevice& physical_device,
+                                               const vk::raii::Device& device, const BindlessHeapSettings& settings,
+                                               Logger& logger)
+    : m_device{ device }, m_logger{ logger } {
+    const auto properties_chain =
+            physical_device.getProperties2<vk::PhysicalDeviceProperties2,
+                                           vk::PhysicalDeviceDescriptorIndexingProperties>();
+    const auto& limits = properties_chain.get<vk::PhysicalDeviceProperties2>().properties.limits;
+    const auto& indexing = properties_chain.get<vk::PhysicalDeviceDescriptorIndexingProperties>();
+
+    const auto capacities = std::array{
+        std::min({ settings.max_sampled_images,
+                   indexing.maxDescriptorSetUpdateAfterBindSampledImages,
+                   indexing.maxPerStageDescriptorUpdateAfterBindSampledImages }),
+        std::min({ settings.max_storage_images,
+                   indexing.maxDescriptorSetUpdateAfterBindStorageImages,
+                   indexing.maxPerStageDescriptorUpdateAfterBindStorageImages }),
+        std::min({ settings.max_samplers,
+                   indexing.maxDescriptorSetUpdateAfterBindSamplers,
+                   indexing.maxPerStageDescriptorUpdateAfterBindSamplers }),
+        std::min({ settings.max_storage_buffers,
+                   indexing.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                   indexing.maxPerStageDescriptorUpdateAfterBindStorageBuffers }),
+    };
+
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 4>{};
+    auto pool_sizes = std::array<vk::DescriptorPoolSize, 4>{};
+    for (uint32_t binding{ 0 }; binding < bindings.size(); ++binding) {
+        const auto type = toDescriptorType(static_cast<BindlessResourceType>(binding));
+        bindings[binding] = vk::DescriptorSetLayoutBinding{
+            .binding = binding,
+            .descriptorType = type,
+            .descriptorCount = capacities[binding],
+            .stageFlags = vk::ShaderStageFlagBits::eAll,
+        };
+        pool_sizes[binding] = vk::DescriptorPoolSize{ .type = type, .descriptorCount = capacities[binding] };
+        m_free_lists[binding] = FreeList{ capacities[binding] };
+    }
+
+    constexpr auto binding_flags = vk::DescriptorBindingFlagBits::ePartiallyBound
+                                   | vk::DescriptorBindingFlagBits::eUpdateAfterBind
+                                   | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+    const auto bindings_flags = std::array{ vk::DescriptorBindingFlags{ binding_flags },
+                                            vk::DescriptorBindingFlags{ binding_flags },
+                                            vk::DescriptorBindingFlags{ binding_flags },
+                                            vk::DescriptorBindingFlags{ binding_flags } };
+    const auto layout_create_info = vk::StructureChain{
+        vk::DescriptorSetLayoutCreateInfo{ .flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+                                           .bindingCount = static_cast<uint32_t>(bindings.size()),
+                                           .pBindings = bindings.data() },
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo{ .bindingCount = static_cast<uint32_t>(bindings_flags.size()),
+                                                       .pBindingFlags = bindings_flags.data() }
+    };
+    m_descriptor_set_layout =
+            device.createDescriptorSetLayout(layout_create_info.get<vk::DescriptorSetLayoutCreateInfo>());
+
+    m_descriptor_pool = device.createDescriptorPool(vk::DescriptorPoolCreateInfo{
+            .flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind
+                     | vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+            .pPoolSizes = pool_sizes.data() });
+
+    auto descriptor_sets = device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+            .descriptorPool = m_descriptor_pool, .descriptorSetCount = 1, .pSetLayouts = &*m_descriptor_set_layout });
+    m_descriptor_set = std::move(descriptor_sets.front());
+
+    const auto push_constants_range = vk::PushConstantRange{
+        .stageFlags = push_constants_stages,
+        .offset = 0,
+        .size = std::min(settings.push_constants_size, limits.maxPushConstantsSize),
+    };
+    m_pipeline_layout = device.createPipelineLayout(vk::PipelineLayoutCreateInfo{
+            .setLayoutCount = 1,
+            .pSetLayouts = &*m_descriptor_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &push_constants_range,
+    });
+
+    m_logger.debug("Bindless heap created with {} sampled images, {} storage images, {} samplers, {} storage buffers",
+                   capacities[0],
+                   capacities[1],
+                   capacities[2],
+                   capacities[3]);
+}
+
+auto BindlessDescriptorHeap::registerSampledImage(const vk::ImageView image_view, const vk::ImageLayout image_layout)
+        -> BindlessIndex {
+    const auto index = allocate(BindlessResourceType::sampled_image);
+    updateSampledImage(index, image_view, image_layout);
+    return index;
+}
+
+auto BindlessDescriptorHeap::registerStorageImage(const vk::ImageView image_view, const vk::ImageLayout image_layout)
+        -> BindlessIndex {
+    const auto index = allocate(BindlessResourceType::storage_image);
+    updateStorageImage(index, image_view, image_layout);
+    return index;
+}
+
+auto BindlessDescriptorHeap::registerSampler(const vk::Sampler sampler) -> BindlessIndex {
+    const auto index = allocate(BindlessResourceType::sampler);
+    const auto image_info = vk::DescriptorImageInfo{ .sampler = sampler };
+    write(BindlessResourceType::sampler, index, &image_info, nullptr);
+    return index;
+}
+
+auto BindlessDescriptorHeap::registerStorageBuffer(const vk::DescriptorBufferInfo& buffer_info) -> BindlessIndex {
+    const auto index = allocate(BindlessResourceType::storage_buffer);
+    updateStorageBuffer(index, buffer_info);
+    return index;
+}
+
+void BindlessDescriptorHeap::updateSampledImage(const BindlessIndex index, const vk::ImageView image_view,
+                                                const vk::ImageLayout image_layout) {
+    const auto image_info = vk::DescriptorImageInfo{ .imageView = image_view, .imageLayout = image_layout };
+    write(BindlessResourceType::sampled_image, index, &image_info, nullptr);
+}
+
+void BindlessDescriptorHeap::updateStorageImage(const BindlessIndex index, const vk::ImageView image_view,
+                                                const vk::ImageLayout image_layout) {
+    const auto image_info = vk::DescriptorImageInfo{ .imageView = image_view, .imageLayout = image_layout };
+    write(BindlessResourceType::storage_image, index, &image_info, nullptr);
+}
+
+void BindlessDescriptorHeap::updateStorageBuffer(const BindlessIndex index,
+                                                 const vk::DescriptorBufferInfo& buffer_info) {
+    write(BindlessResourceType::storage_buffer, index, nullptr, &buffer_info);
+}
+
+void BindlessDescriptorHeap::release(const BindlessResourceType type, const BindlessIndex index) {
+    if (!index.isValid()) {
+        return;
+    }
+    std::scoped_lock lock{ m_mutex };
+    m_free_lists[std::to_underlying(type)].release(index.index);
+}
+
+void BindlessDescriptorHeap::bind(const vk::CommandBuffer command_buffer,
+                                  const vk::PipelineBindPoint bind_point) const {
+    command_buffer.bindDescriptorSets(bind_point, *m_pipeline_layout, 0, *m_descriptor_set, nullptr);
+}
+
+auto BindlessDescriptorHeap::allocate(const BindlessResourceType type) -> BindlessIndex {
+    std::scoped_lock lock{ m_mutex };
+    auto& free_list = m_free_lists[std::to_underlying(type)];
+    const auto index = free_list.allocate();
+    if (!index.has_value()) {
+        throw std::runtime_error(std::format(
+                "Bindless heap is out of {} slots (capacity {})", toString(type), free_list.getCapacity()));
+    }
+    return BindlessIndex{ .index = *index };
+}
+
+void BindlessDescriptorHeap::write(const BindlessResourceType type, const BindlessIndex index,
+                                   const vk::DescriptorImageInfo* image_info,
+                                   const vk::DescriptorBufferInfo* buffer_info) const {
+    m_device.updateDescriptorSets(
+            vk::WriteDescriptorSet{
+                    .dstSet = m_descriptor_set,
+                    .dstBinding = std::to_underlying(type),
+                    .dstArrayElement = index.index,
+                    .descriptorCount = 1,
+                    .descriptorType = toDescriptorType(type),
+                    .pImageInfo = image_info,
+                    .pBufferInfo = buffer_info,
+            },
+            {});
+}
+
+auto BindlessDescriptorHeap::FreeList::allocate() -> std::optional<uint32_t> {
+    if (!m_free.empty()) {
+        const auto index = m_free.back();
+        m_free.pop_back();
+        return index;
+    }
+    if (m_next < m_capacity) {
+        return m_next++;
+    }
+    return std::nullopt;
+}
+
+void BindlessDescriptorHeap::FreeList::release(const uint32_t index) {
+    m_free.push_back(index);
+}
+
+}// namespace th
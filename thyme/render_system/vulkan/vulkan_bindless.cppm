@@ -0,0 +1,134 @@
+export module th.render_system.vulkan:bindless;
+
+import std;
+
+import vulkan;
+
+import th.core.logger;
+
+import :deletion_queue;
+
+namespace th {
+
+export enum struct BindlessResourceType : uint32_t {
+    sampled_image = 0,
+    storage_image = 1,
+    sampler = 2,
+    storage_buffer = 3,
+};
+
+// Index of a resource inside its array of the bindless heap, as read by shaders.
+export struct BindlessIndex {
+    static constexpr auto invalid = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{ invalid };
+
+    [[nodiscard]] auto isValid() const noexcept -> bool {
+        return index != invalid;
+    }
+};
+
+export struct BindlessHeapSettings {
+    uint32_t max_sampled_images{ 16384 };
+    uint32_t max_storage_images{ 1024 };
+    uint32_t max_samplers{ 256 };
+    uint32_t max_storage_buffers{ 16384 };
+    uint32_t push_constants_size{ 128 };
+};
+
+// Single global descriptor set holding every resource in partially bound, update-after-bind arrays, see
+// shaders/slang/bindless.slang. Bind it once per command buffer; draws then address resources by index, usually
+// through push constants, and materials are plain structs of indices in a storage buffer.
+// Released indices are reused immediately, so a resource may only be released once no frame in flight uses it;
+// releaseDeferred takes care of that.
+export class BindlessDescriptorHeap {
+public:
+    BindlessDescriptorHeap(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                           const BindlessHeapSettings& settings, Logger& logger);
+
+    [[nodiscard]] auto registerSampledImage(vk::ImageView image_view,
+                                            vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal)
+            -> BindlessIndex;
+    [[nodiscard]] auto registerStorageImage(vk::ImageView image_view,
+                                            vk::ImageLayout image_layout = vk::ImageLayout::eGeneral)
+            -> BindlessIndex;
+    [[nodiscard]] auto registerSampler(vk::Sampler sampler) -> BindlessIndex;
+    [[nodiscard]] auto registerStorageBuffer(const vk::DescriptorBufferInfo& buffer_info) -> BindlessIndex;
+
+    // Points an already registered slot at a different resource, e.g. a resized render target.
+    void updateSampledImage(BindlessIndex index, vk::ImageView image_view,
+                            vk::ImageLayout image_layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+    void updateStorageImage(BindlessIndex index, vk::ImageView image_view,
+                            vk::ImageLayout image_layout = vk::ImageLayout::eGeneral);
+    void updateStorageBuffer(BindlessIndex index, const vk::DescriptorBufferInfo& buffer_info);
+
+    void release(BindlessResourceType type, BindlessIndex index);
+    void releaseDeferred(const BindlessResourceType type, const BindlessIndex index,
+                         DeferredDeletionQueue& deletion_queue) {
+        deletion_queue.defer([this, type, index] { release(type, index); });
+    }
+
+    void bind(vk::CommandBuffer command_buffer, vk::PipelineBindPoint bind_point) const;
+
+    void pushConstants(const vk::CommandBuffer command_buffer, const std::span<const std::byte> data) const {
+        command_buffer.pushConstants2(vk::PushConstantsInfo{ .layout = m_pipeline_layout,
+                                                             .stageFlags = push_constants_stages,
+                                                             .offset = 0,
+                                                             .size = static_cast<uint32_t>(data.size()),
+                                                             .pValues = data.data() });
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void pushConstants(const vk::CommandBuffer command_buffer, const T& value) const {
+        pushConstants(command_buffer, std::as_bytes(std::span{ &value, 1 }));
+    }
+
+    [[nodiscard]] auto getDescriptorSetLayout() const noexcept -> vk::DescriptorSetLayout {
+        return m_descriptor_set_layout;
+    }
+
+    // Shared by every pipeline using the heap: set 0 is the heap, the push constant range is visible to all stages.
+    [[nodiscard]] auto getPipelineLayout() const noexcept -> vk::PipelineLayout {
+        return m_pipeline_layout;
+    }
+
+    static constexpr auto push_constants_stages =
+            vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute;
+
+private:
+    class FreeList {
+    public:
+        explicit FreeList(const uint32_t capacity = 0) : m_capacity{ capacity } {}
+
+        [[nodiscard]] auto allocate() -> std::optional<uint32_t>;
+        void release(uint32_t index);
+
+        [[nodiscard]] auto getCapacity() const noexcept -> uint32_t {
+            return m_capacity;
+        }
+
+    private:
+        uint32_t m_capacity;
+        uint32_t m_next{ 0 };
+        std::vector<uint32_t> m_free;
+    };
+
+    [[nodiscard]] auto allocate(BindlessResourceType type) -> BindlessIndex;
+    void write(BindlessResourceType type, BindlessIndex index, const vk::DescriptorImageInfo* image_info,
+               const vk::DescriptorBufferInfo* buffer_info) const;
+
+private:
+    const vk::raii::Device& m_device;
+    Logger& m_logger;
+
+    vk::raii::DescriptorSetLayout m_descriptor_set_layout{ nullptr };
+    vk::raii::DescriptorPool m_descriptor_pool{ nullptr };
+    vk::raii::DescriptorSet m_descriptor_set{ nullptr };
+    vk::raii::PipelineLayout m_pipeline_layout{ nullptr };
+
+    std::mutex m_mutex;
+    std::array<FreeList, 4> m_free_lists;
+};
+
+}// namespace th
@@ -10,28 +10,48 @@ import :utils;
 
 namespace th {
 
-[[nodiscard]] auto createVertexBuffer(const vma::raii::Allocator& allocator, const uint32_t size) -> vma::raii::Buffer {
-    return allocator.createBuffer(
-            vk::BufferCreateInfo{
-                    .size = size,
-                    .usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer
-                             | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                    .sharingMode = vk::SharingMode::eExclusive,
-            },
-            vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eMapped,
-                                       .usage = vma::MemoryUsage::eGpuOnly });
+// Transfer source as well, so the defragmenter can copy them when moving their memory.
+[[nodiscard]] auto getVertexBufferCreateInfo(const vk::DeviceSize size) -> vk::BufferCreateInfo {
+    return vk::BufferCreateInfo{
+        .size = size,
+        .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+                 | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+        .sharingMode = vk::SharingMode::eExclusive,
+    };
 }
 
-export [[nodiscard]] auto createIndexBuffer(const vma::raii::Allocator& allocator, const size_t size)
-        -> vma::raii::Buffer {
-    return allocator.createBuffer(
-            vk::BufferCreateInfo{
-                    .size = size,
-                    .usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
-                    .sharingMode = vk::SharingMode::eExclusive,
-            },
-            vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eMapped,
-                                       .usage = vma::MemoryUsage::eGpuOnly });
+[[nodiscard]] auto getIndexBufferCreateInfo(const vk::DeviceSize size) -> vk::BufferCreateInfo {
+    return vk::BufferCreateInfo{
+        .size = size,
+        .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+                 | vk::BufferUsageFlagBits::eIndexBuffer,
+        .sharingMode = vk::SharingMode::eExclusive,
+    };
+}
+
+// Vertex and index buffers share a pool, so defragmentation can be limited to mesh memory.
+export [[nodiscard]] auto createMeshBufferPool(const vma::raii::Allocator& allocator) -> vma::raii::Pool {
+    auto buffer_create_info = getVertexBufferCreateInfo(1);
+    buffer_create_info.usage |= getIndexBufferCreateInfo(1).usage;
+    const auto memory_type_index = (*allocator).findMemoryTypeIndexForBufferInfo(
+            buffer_create_info, vma::AllocationCreateInfo{ .usage = vma::MemoryUsage::eGpuOnly });
+    return allocator.createPool(vma::PoolCreateInfo{ .memoryTypeIndex = memory_type_index });
+}
+
+[[nodiscard]] auto createVertexBuffer(const vma::raii::Allocator& allocator, const uint32_t size,
+                                      const vma::Pool pool = nullptr) -> vma::raii::Buffer {
+    return allocator.createBuffer(getVertexBufferCreateInfo(size),
+                                  vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eMapped,
+                                                             .usage = vma::MemoryUsage::eGpuOnly,
+                                                             .pool = pool });
+}
+
+export [[nodiscard]] auto createIndexBuffer(const vma::raii::Allocator& allocator, const size_t size,
+                                            const vma::Pool pool = nullptr) -> vma::raii::Buffer {
+    return allocator.createBuffer(getIndexBufferCreateInfo(size),
+                                  vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eMapped,
+                                                             .usage = vma::MemoryUsage::eGpuOnly,
+                                                             .pool = pool });
 }
 
 export [[nodiscard]] auto createStagingBuffer(const vma::raii::Allocator& allocator, const size_t size)
@@ -74,6 +74,16 @@ void VulkanCommandBuffer2::waitFor(const vk::raii::Device& device, vk::Semaphore
     m_depend_semaphores.emplace_back(std::move(depend_semaphore));
 }
 
+void VulkanCommandBuffer2::wait(const vk::raii::Device& device) const {
+    if (m_state != State::Submitted) {
+        return;
+    }
+    if (device.waitForFences({ m_fence }, vk::True, std::numeric_limits<uint64_t>::max()) != vk::Result::eSuccess) {
+        m_logger.error("Failed to wait for a complete fence");
+        throw std::runtime_error("Failed to wait for a complete fence");
+    }
+}
+
 VulkanCommandBuffersPool2::VulkanCommandBuffersPool2(const vk::raii::Device& device, const vk::CommandPool command_pool,
                                                    const vk::Queue graphic_queue, const std::size_t capacity,
                                                    Logger& logger) {
@@ -28,6 +28,8 @@ public:
     void start(const vk::raii::Device& device);
     void submit(vk::PipelineStageFlags stage, vk::Semaphore semaphore);
     void waitFor(const vk::raii::Device& device, vk::Semaphore depend_semaphore);
+    // Blocks until the last submission has finished, leaving the buffer submitted.
+    void wait(const vk::raii::Device& device) const;
 
     [[nodiscard]] auto isSubmitted() const -> bool {
         return m_state == State::Submitted;
@@ -67,6 +69,10 @@ public:
         current.waitFor(device, depend_semaphore);
     }
 
+    void wait(const vk::raii::Device& device, const std::uint32_t index) const {
+        m_command_buffers[index].wait(device);
+    }
+
      void submit(const vk::Semaphore semaphore) {
         get().submit(vk::PipelineStageFlagBits::eColorAttachmentOutput, semaphore);
         m_current = (m_current + 1) % static_cast<std::uint32_t>(m_command_buffers.size());
@@ -0,0 +1,74 @@
+export module th.render_system.vulkan:deletion_queue;
+
+import std;
+
+namespace th {
+
+// Keeps GPU objects alive until every frame that may still use them has completed, so they can be replaced while
+// frames keep flowing instead of idling the device. Objects retired while frame N is being recorded are destroyed
+// once the frame owner reports that frame N has completed. Retiring is safe from any thread.
+export class DeferredDeletionQueue {
+public:
+    DeferredDeletionQueue() = default;
+    DeferredDeletionQueue(const DeferredDeletionQueue&) = delete;
+    DeferredDeletionQueue(DeferredDeletionQueue&&) = delete;
+    auto operator=(const DeferredDeletionQueue&) -> DeferredDeletionQueue& = delete;
+    auto operator=(DeferredDeletionQueue&&) -> DeferredDeletionQueue& = delete;
+    ~DeferredDeletionQueue() {
+        flush();
+    }
+
+    // Takes ownership of a RAII object, e.g. a vk::raii handle or a VMA buffer, and destroys it once retired.
+    template <typename T>
+    void retire(T object) {
+        defer([object = std::move(object)] {});
+    }
+
+    // Runs release once retired, for resources without an owning object such as bindless heap slots.
+    void defer(std::move_only_function<void()> release) {
+        std::scoped_lock lock{ m_mutex };
+        m_entries.push_back(Entry{ .frame_serial = m_frame_serial, .release = std::move(release) });
+    }
+
+    // Closes the frame being recorded and returns its serial, which the owner later passes to collect.
+    auto submitFrame() -> uint64_t {
+        std::scoped_lock lock{ m_mutex };
+        return m_frame_serial++;
+    }
+
+    void collect(const uint64_t completed_frame_serial) {
+        auto released = std::vector<Entry>{};
+        {
+            std::scoped_lock lock{ m_mutex };
+            while (!m_entries.empty() && m_entries.front().frame_serial <= completed_frame_serial) {
+                released.push_back(std::move(m_entries.front()));
+                m_entries.pop_front();
+            }
+        }
+        for (auto& entry : released) {
+            entry.release();
+        }
+    }
+
+    // Releases everything regardless of frames, only valid once the device is idle.
+    void flush() {
+        collect(std::numeric_limits<uint64_t>::max());
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t {
+        std::scoped_lock lock{ m_mutex };
+        return m_entries.size();
+    }
+
+private:
+    struct Entry {
+        uint64_t frame_serial;
+        std::move_only_function<void()> release;
+    };
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_entries;
+    uint64_t m_frame_serial{ 1 };
+};
+
+}// namespace th
@@ -11,6 +11,9 @@ static constexpr auto g_sDeviceExtensions = std::array{ vk::KHRSwapchainExtensio
                                                         vk::KHRSynchronization2ExtensionName,
                                                         vk::KHRBufferDeviceAddressExtensionName };
 
+// Enabled when the device supports them.
+static constexpr auto g_sOptionalDeviceExtensions = std::array{ vk::EXTMemoryBudgetExtensionName };
+
 static auto deviceHasAllRequiredExtensions(const vk::PhysicalDevice physical_device) -> bool {
     const auto& available_device_extensions = physical_device.enumerateDeviceExtensionProperties();
     return std::ranges::all_of(g_sDeviceExtensions, [&available_device_extensions](const auto& extension) {
@@ -20,6 +23,13 @@ static auto deviceHasAllRequiredExtensions(const vk::PhysicalDevice physical_dev
     });
 }
 
+auto isDeviceExtensionSupported(const vk::PhysicalDevice physical_device, const std::string_view extension) -> bool {
+    return std::ranges::any_of(physical_device.enumerateDeviceExtensionProperties(),
+                               [extension](const vk::ExtensionProperties& properties) {
+                                   return extension == std::string_view(properties.extensionName);
+                               });
+}
+
 auto getMaxUsableSampleCount(const vk::PhysicalDevice device) noexcept -> vk::SampleCountFlagBits {
     const auto counts = device.getProperties().limits.framebufferColorSampleCounts
                         & device.getProperties().limits.framebufferDepthSampleCounts;
@@ -45,8 +55,23 @@ auto getMaxUsableSampleCount(const vk::PhysicalDevice device) noexcept -> vk::Sa
 }
 
 [[nodiscard]] auto hasRequiredFeatures(const vk::PhysicalDevice physical_device) noexcept -> bool {
-    const auto& features = physical_device.getFeatures();
-    return features.samplerAnisotropy;
+    const auto features_chain =
+            physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    const auto& features = features_chain.get<vk::PhysicalDeviceFeatures2>().features;
+    const auto& vulkan12_features = features_chain.get<vk::PhysicalDeviceVulkan12Features>();
+    // Required by the bindless descriptor heap.
+    const auto has_descriptor_indexing = vulkan12_features.descriptorIndexing
+                                         && vulkan12_features.shaderSampledImageArrayNonUniformIndexing
+                                         && vulkan12_features.shaderStorageBufferArrayNonUniformIndexing
+                                         && vulkan12_features.shaderStorageImageArrayNonUniformIndexing
+                                         && vulkan12_features.descriptorBindingSampledImageUpdateAfterBind
+                                         && vulkan12_features.descriptorBindingStorageImageUpdateAfterBind
+                                         && vulkan12_features.descriptorBindingStorageBufferUpdateAfterBind
+                                         && vulkan12_features.descriptorBindingUpdateUnusedWhilePending
+                                         && vulkan12_features.descriptorBindingPartiallyBound
+                                         && vulkan12_features.runtimeDescriptorArray;
+    // The storage images of the bindless heap are declared without a format.
+    return features.samplerAnisotropy && features.shaderStorageImageWriteWithoutFormat && has_descriptor_indexing;
 }
 
 static auto hasRequiredQueues(const vk::PhysicalDevice physical_device,
@@ -94,7 +119,8 @@ auto createLogicalDevice(const vk::raii::PhysicalDevice& physical_device, uint32
             .fillModeNonSolid = physical_device_features.fillModeNonSolid,
             .wideLines = physical_device_features.wideLines,
             .largePoints = physical_device_features.largePoints,
-            .samplerAnisotropy = physical_device_features.samplerAnisotropy
+            .samplerAnisotropy = physical_device_features.samplerAnisotropy,
+            .shaderStorageImageWriteWithoutFormat = physical_device_features.shaderStorageImageWriteWithoutFormat
         }
     };
 
@@ -102,8 +128,19 @@ auto createLogicalDevice(const vk::raii::PhysicalDevice& physical_device, uint32
         .shaderDrawParameters = true
     };
 
-    constexpr auto vulkan12_features =
-            vk::PhysicalDeviceVulkan12Features{ .descriptorIndexing = true, .bufferDeviceAddress = true };
+    constexpr auto vulkan12_features = vk::PhysicalDeviceVulkan12Features{
+        .descriptorIndexing = true,
+        .shaderSampledImageArrayNonUniformIndexing = true,
+        .shaderStorageBufferArrayNonUniformIndexing = true,
+        .shaderStorageImageArrayNonUniformIndexing = true,
+        .descriptorBindingSampledImageUpdateAfterBind = true,
+        .descriptorBindingStorageImageUpdateAfterBind = true,
+        .descriptorBindingStorageBufferUpdateAfterBind = true,
+        .descriptorBindingUpdateUnusedWhilePending = true,
+        .descriptorBindingPartiallyBound = true,
+        .runtimeDescriptorArray = true,
+        .bufferDeviceAddress = true,
+    };
 
     constexpr auto vulkan13_features =
             vk::PhysicalDeviceVulkan13Features{ .synchronization2 = true, .dynamicRendering = true };
@@ -111,11 +148,18 @@ auto createLogicalDevice(const vk::raii::PhysicalDevice& physical_device, uint32
 
     const auto feature_chain = vk::StructureChain{ features, vulkan11_features, vulkan12_features, vulkan13_features };
 
+    auto extensions = std::vector<const char*>(g_sDeviceExtensions.begin(), g_sDeviceExtensions.end());
+    for (const auto* extension : g_sOptionalDeviceExtensions) {
+        if (isDeviceExtensionSupported(physical_device, extension)) {
+            extensions.push_back(extension);
+        }
+    }
+
     const auto device_create_info = vk::StructureChain(
             vk::DeviceCreateInfo{ .queueCreateInfoCount = static_cast<uint32_t>(device_queue_create_infos.size()),
                                   .pQueueCreateInfos = device_queue_create_infos.data(),
-                                  .enabledExtensionCount = static_cast<uint32_t>(g_sDeviceExtensions.size()),
-                                  .ppEnabledExtensionNames = g_sDeviceExtensions.data() },
+                                  .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
+                                  .ppEnabledExtensionNames = extensions.data() },
             feature_chain.get<vk::PhysicalDeviceFeatures2>());
     return vk::raii::Device(physical_device, device_create_info.get<vk::DeviceCreateInfo>());
 }
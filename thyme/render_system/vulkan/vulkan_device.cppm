@@ -11,6 +11,8 @@ import :utils;
 namespace th {
 
 export [[nodiscard]] auto getMaxUsableSampleCount(vk::PhysicalDevice device) noexcept -> vk::SampleCountFlagBits;
+export [[nodiscard]] auto isDeviceExtensionSupported(vk::PhysicalDevice physical_device, std::string_view extension)
+        -> bool;
 export [[nodiscard]] auto filterDevices(std::span<const vk::raii::PhysicalDevice> physical_devices,
                                         vk::SurfaceKHR surface) -> std::vector<vk::raii::PhysicalDevice>;
 
@@ -0,0 +1,67 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+[[nodiscard]] static constexpr auto alignUp(const vk::DeviceSize value, const vk::DeviceSize alignment) noexcept
+        -> vk::DeviceSize {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+[[nodiscard]] static auto getArenaAlignment(const vk::raii::PhysicalDevice& physical_device) -> vk::DeviceSize {
+    const auto& limits = physical_device.getProperties().limits;
+    // 16 bytes keeps float4 loads aligned even on devices reporting smaller offset alignments.
+    return std::max({ limits.minUniformBufferOffsetAlignment,
+                      limits.minStorageBufferOffsetAlignment,
+                      vk::DeviceSize{ 16 } });
+}
+
+FrameArena::FrameArena(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                       const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                       const uint32_t max_frames_in_flight, const vk::DeviceSize frame_size, Logger& logger)
+    : m_logger{ logger }, m_alignment{ getArenaAlignment(physical_device) },
+      m_frame_size{ alignUp(frame_size, m_alignment) },
+      m_buffer{ allocator.createBuffer(
+              vk::BufferCreateInfo{
+                      .size = m_frame_size * max_frames_in_flight,
+                      .usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+                               | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                      .sharingMode = vk::SharingMode::eExclusive,
+              },
+              vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eHostAccessSequentialWrite,
+                                         .usage = vma::MemoryUsage::eCpuToGpu }) },
+      m_memory_tag{ memory_tracker.track(*m_buffer.getAllocation(), GpuMemoryCategory::frame_arena, "frame arena") },
+      m_mapped_memory{ static_cast<std::byte*>(m_buffer.getAllocation().map()) },
+      m_address{ device.getBufferAddress(vk::BufferDeviceAddressInfo{ .buffer = m_buffer }) } {
+    m_logger.debug("Frame arena created with {} regions of {} bytes", max_frames_in_flight, m_frame_size);
+}
+
+FrameArena::~FrameArena() {
+    m_buffer.getAllocation().unmap();
+}
+
+void FrameArena::reset(const uint32_t frame_index) noexcept {
+    m_frame_begin = m_frame_size * frame_index;
+    m_head.store(m_frame_begin, std::memory_order_relaxed);
+}
+
+auto FrameArena::allocate(const vk::DeviceSize size) -> FrameArenaAllocation {
+    // Every push is rounded to the alignment, so the head stays aligned without a compare-exchange loop.
+    const auto aligned_size = alignUp(std::max(size, vk::DeviceSize{ 1 }), m_alignment);
+    const auto offset = m_head.fetch_add(aligned_size, std::memory_order_relaxed);
+    if (offset + aligned_size > m_frame_begin + m_frame_size) {
+        throw std::runtime_error(std::format(
+                "Frame arena is out of memory, {} bytes requested with {} of {} bytes used",
+                size,
+                offset - m_frame_begin,
+                m_frame_size));
+    }
+    return FrameArenaAllocation{
+        .offset = static_cast<uint32_t>(offset),
+        .address = m_address + offset,
+        .data = std::span{ m_mapped_memory + offset, static_cast<std::size_t>(size) },
+    };
+}
+
+}// namespace th
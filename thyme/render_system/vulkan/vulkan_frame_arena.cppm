@@ -0,0 +1,88 @@
+export module th.render_system.vulkan:frame_arena;
+
+import std;
+
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+
+import :memory_tracker;
+
+namespace th {
+
+export struct FrameArenaAllocation {
+    // Offset from the start of the arena buffer, usable as a dynamic offset or with the bindless heap.
+    uint32_t offset;
+    vk::DeviceAddress address;
+    std::span<std::byte> data;
+};
+
+// Linear allocator for per-pass and per-draw constants. A single persistently mapped buffer is split into one region
+// per frame in flight; pushes only bump an offset and the region is rewound once the frame's fence has signalled.
+export class FrameArena {
+public:
+    FrameArena(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+               const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+               uint32_t max_frames_in_flight, vk::DeviceSize frame_size, Logger& logger);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+    auto operator=(const FrameArena&) -> FrameArena& = delete;
+    auto operator=(FrameArena&&) -> FrameArena& = delete;
+    ~FrameArena();
+
+    // Must only be called once the GPU has finished the previous use of the frame's region.
+    void reset(uint32_t frame_index) noexcept;
+
+    [[nodiscard]] auto allocate(vk::DeviceSize size) -> FrameArenaAllocation;
+
+    auto push(const std::span<const std::byte> data) -> FrameArenaAllocation {
+        const auto allocation = allocate(data.size());
+        std::ranges::copy(data, allocation.data.begin());
+        return allocation;
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto push(const T& value) -> FrameArenaAllocation {
+        return push(std::as_bytes(std::span{ &value, 1 }));
+    }
+
+    [[nodiscard]] auto getBuffer() const noexcept -> vk::Buffer {
+        return m_buffer;
+    }
+
+    // Covers the whole buffer, for binding the arena once as a storage buffer and addressing pushes by offset.
+    [[nodiscard]] auto getDescriptorBufferInfo() const noexcept -> vk::DescriptorBufferInfo {
+        return vk::DescriptorBufferInfo{ .buffer = m_buffer, .offset = 0, .range = vk::WholeSize };
+    }
+
+    [[nodiscard]] auto getAlignment() const noexcept -> vk::DeviceSize {
+        return m_alignment;
+    }
+
+    [[nodiscard]] auto getFrameSize() const noexcept -> vk::DeviceSize {
+        return m_frame_size;
+    }
+
+    // Bytes pushed into the current frame so far.
+    [[nodiscard]] auto getUsedSize() const noexcept -> vk::DeviceSize {
+        return m_head.load(std::memory_order_relaxed) - m_frame_begin;
+    }
+
+private:
+    Logger& m_logger;
+
+    vk::DeviceSize m_alignment;
+    vk::DeviceSize m_frame_size;
+    vma::raii::Buffer m_buffer;
+    GpuMemoryTag m_memory_tag;
+    std::byte* m_mapped_memory;
+    vk::DeviceAddress m_address;
+
+    vk::DeviceSize m_frame_begin{ 0 };
+    std::atomic<vk::DeviceSize> m_head{ 0 };
+};
+
+}// namespace th
@@ -0,0 +1,58 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+FrameStorageBuffer::FrameStorageBuffer(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                                       BindlessDescriptorHeap& bindless_heap, DeferredDeletionQueue& deletion_queue,
+                                       const uint32_t max_frames_in_flight, std::string name, Logger& logger)
+    : m_allocator{ allocator }, m_memory_tracker{ memory_tracker }, m_bindless_heap{ bindless_heap },
+      m_deletion_queue{ deletion_queue }, m_name{ std::move(name) }, m_logger{ logger },
+      m_frames(max_frames_in_flight) {
+    for (auto& frame : m_frames) {
+        allocate(frame, initial_size);
+        frame.bindless_index = m_bindless_heap.registerStorageBuffer(
+                vk::DescriptorBufferInfo{ .buffer = frame.buffer, .offset = 0, .range = vk::WholeSize });
+    }
+}
+
+FrameStorageBuffer::~FrameStorageBuffer() {
+    for (const auto& frame : m_frames) {
+        m_bindless_heap.release(BindlessResourceType::storage_buffer, frame.bindless_index);
+    }
+}
+
+auto FrameStorageBuffer::reserve(const uint32_t frame_index, const vk::DeviceSize size) -> bool {
+    auto& frame = m_frames[frame_index];
+    if (size <= frame.data.size()) {
+        return false;
+    }
+    // The frame's previous use has completed, but the retired buffer is still left to the deletion queue rather than
+    // trusting that no other frame was recorded against it.
+    m_deletion_queue.retire(std::move(frame.buffer));
+    m_deletion_queue.retire(std::move(frame.memory_tag));
+    allocate(frame, std::bit_ceil(size));
+    m_bindless_heap.updateStorageBuffer(
+            frame.bindless_index,
+            vk::DescriptorBufferInfo{ .buffer = frame.buffer, .offset = 0, .range = vk::WholeSize });
+    m_logger.debug("{} of frame {} grown to {} bytes", m_name, frame_index, frame.data.size());
+    return true;
+}
+
+void FrameStorageBuffer::allocate(Frame& frame, const vk::DeviceSize size) {
+    frame.buffer = m_allocator.createBuffer(
+            vk::BufferCreateInfo{
+                    .size = size,
+                    .usage = vk::BufferUsageFlagBits::eStorageBuffer,
+                    .sharingMode = vk::SharingMode::eExclusive,
+            },
+            vma::AllocationCreateInfo{ .flags = vma::AllocationCreateFlagBits::eHostAccessSequentialWrite
+                                                | vma::AllocationCreateFlagBits::eMapped,
+                                       .usage = vma::MemoryUsage::eCpuToGpu });
+    frame.memory_tag = m_memory_tracker.track(*frame.buffer.getAllocation(), GpuMemoryCategory::instance_data, m_name);
+    const auto allocation_info = m_allocator.getAllocationInfo(*frame.buffer.getAllocation());
+    frame.data = std::span{ static_cast<std::byte*>(allocation_info.pMappedData), static_cast<std::size_t>(size) };
+}
+
+}// namespace th
@@ -0,0 +1,66 @@
+export module th.render_system.vulkan:frame_storage_buffer;
+
+import std;
+
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+
+import :bindless;
+import :deletion_queue;
+import :memory_tracker;
+
+namespace th {
+
+// Persistently mapped storage buffer per frame in flight, for data whose size follows the scene, such as per-instance
+// transforms. Each frame's buffer grows on demand and has its own bindless slot, so growing one never touches a buffer
+// an earlier frame in flight is still reading; the replaced buffer goes through the deletion queue.
+export class FrameStorageBuffer {
+public:
+    FrameStorageBuffer(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                       BindlessDescriptorHeap& bindless_heap, DeferredDeletionQueue& deletion_queue,
+                       uint32_t max_frames_in_flight, std::string name, Logger& logger);
+
+    FrameStorageBuffer(const FrameStorageBuffer&) = delete;
+    FrameStorageBuffer(FrameStorageBuffer&&) = delete;
+    auto operator=(const FrameStorageBuffer&) -> FrameStorageBuffer& = delete;
+    auto operator=(FrameStorageBuffer&&) -> FrameStorageBuffer& = delete;
+    ~FrameStorageBuffer();
+
+    // Makes the frame's buffer hold at least size bytes. Returns true if it had to be reallocated, the previous
+    // contents are lost then. Must only be called once the GPU has finished the previous use of the frame.
+    auto reserve(uint32_t frame_index, vk::DeviceSize size) -> bool;
+
+    [[nodiscard]] auto getData(const uint32_t frame_index) const noexcept -> std::span<std::byte> {
+        return m_frames[frame_index].data;
+    }
+
+    [[nodiscard]] auto getBindlessIndex(const uint32_t frame_index) const noexcept -> BindlessIndex {
+        return m_frames[frame_index].bindless_index;
+    }
+
+private:
+    struct Frame {
+        vma::raii::Buffer buffer{ nullptr };
+        GpuMemoryTag memory_tag;
+        std::span<std::byte> data;
+        BindlessIndex bindless_index;
+    };
+
+    void allocate(Frame& frame, vk::DeviceSize size);
+
+private:
+    // Small enough to keep idle frames cheap, large enough that a few hundred instances never grow it.
+    static constexpr auto initial_size = vk::DeviceSize{ 64 * 1024 };
+
+    const vma::raii::Allocator& m_allocator;
+    GpuMemoryTracker& m_memory_tracker;
+    BindlessDescriptorHeap& m_bindless_heap;
+    DeferredDeletionQueue& m_deletion_queue;
+    std::string m_name;
+    Logger& m_logger;
+    std::vector<Frame> m_frames;
+};
+
+}// namespace th
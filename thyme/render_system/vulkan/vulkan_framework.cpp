@@ -34,8 +34,10 @@ VulkanFramework::VulkanFramework(const InitInfo& info,
 [[nodiscard]] auto VulkanFramework::createInstance(const InitInfo& info,
                                                    const std::vector<std::string>& window_extensions) const
         -> vk::raii::Instance {
-    dumpExtensions();
-    dumpLayers();
+    if (m_logger.isEnabled(LogLevel::debug)) {
+        dumpExtensions();
+        dumpLayers();
+    }
 
     const auto enabled_extensions = mergeInstanceExtensions(g_defaultEnabledExtensions, window_extensions);
     if (!validateExtension(enabled_extensions)) {
@@ -90,16 +92,16 @@ VulkanFramework::VulkanFramework(const InitInfo& info,
 }
 
 void VulkanFramework::dumpExtensions() const {
-    m_logger.info("Vulkan extensions:");
+    m_logger.debug("Vulkan extensions:");
     for (const auto& extension : m_context.enumerateInstanceExtensionProperties()) {
-        m_logger.info("\t{}", std::string_view(extension.extensionName));
+        m_logger.debug("\t{}", std::string_view(extension.extensionName));
     }
 }
 
 void VulkanFramework::dumpLayers() const {
-    m_logger.info("Vulkan layers:");
+    m_logger.debug("Vulkan layers:");
     for (const auto& layer : m_context.enumerateInstanceLayerProperties()) {
-        m_logger.info("\t{}", std::string_view(layer.layerName));
+        m_logger.debug("\t{}", std::string_view(layer.layerName));
     }
 }
 
@@ -0,0 +1,55 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+GpuFrameTimer::GpuFrameTimer(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                             const uint32_t queue_family_index, const uint32_t max_frames_in_flight, Logger& logger)
+    : m_written(max_frames_in_flight, 0) {
+    const auto valid_bits = physical_device.getQueueFamilyProperties()[queue_family_index].timestampValidBits;
+    const auto timestamp_period = physical_device.getProperties().limits.timestampPeriod;
+    if (valid_bits == 0 || timestamp_period <= 0.0f) {
+        logger.warn("Queue family {} does not support timestamps, GPU frame times are unavailable",
+                    queue_family_index);
+        return;
+    }
+    m_timestamp_period = timestamp_period;
+    m_timestamp_mask = valid_bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{ 1 } << valid_bits) - 1;
+    m_query_pool = device.createQueryPool(vk::QueryPoolCreateInfo{
+            .queryType = vk::QueryType::eTimestamp,
+            .queryCount = 2 * max_frames_in_flight,
+    });
+}
+
+void GpuFrameTimer::begin(const vk::CommandBuffer command_buffer, const uint32_t frame_index) {
+    if (!isSupported()) {
+        return;
+    }
+    command_buffer.resetQueryPool(m_query_pool, 2 * frame_index, 2);
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, m_query_pool, 2 * frame_index);
+    m_written[frame_index] = 1;
+}
+
+void GpuFrameTimer::end(const vk::CommandBuffer command_buffer, const uint32_t frame_index) const {
+    if (!isSupported()) {
+        return;
+    }
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, m_query_pool, 2 * frame_index + 1);
+}
+
+auto GpuFrameTimer::collect(const uint32_t frame_index) -> std::optional<float> {
+    if (!isSupported() || m_written[frame_index] == 0) {
+        return std::nullopt;
+    }
+    m_written[frame_index] = 0;
+    const auto [result, timestamps] = m_query_pool.getResults<uint64_t>(
+            2 * frame_index, 2, 2 * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) {
+        return std::nullopt;
+    }
+    const auto ticks = (timestamps[1] - timestamps[0]) & m_timestamp_mask;
+    return static_cast<float>(static_cast<double>(ticks) * m_timestamp_period / 1'000'000.0);
+}
+
+}// namespace th
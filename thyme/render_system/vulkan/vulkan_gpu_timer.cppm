@@ -0,0 +1,35 @@
+export module th.render_system.vulkan:gpu_timer;
+
+import std;
+
+import vulkan;
+
+import th.core.logger;
+
+namespace th {
+
+// Measures the GPU time of whole frames with a pair of timestamps per frame in flight. A frame's timestamps are only
+// read back after its fence has signalled, so collecting them never stalls.
+export class GpuFrameTimer {
+public:
+    GpuFrameTimer(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                  uint32_t queue_family_index, uint32_t max_frames_in_flight, Logger& logger);
+
+    void begin(vk::CommandBuffer command_buffer, uint32_t frame_index);
+    void end(vk::CommandBuffer command_buffer, uint32_t frame_index) const;
+
+    // Milliseconds the GPU spent on the frame last recorded at frame_index. Call only once its fence has signalled.
+    [[nodiscard]] auto collect(uint32_t frame_index) -> std::optional<float>;
+
+    [[nodiscard]] auto isSupported() const noexcept -> bool {
+        return m_timestamp_period > 0.0f;
+    }
+
+private:
+    float m_timestamp_period{ 0.0f };
+    uint64_t m_timestamp_mask{ 0 };
+    vk::raii::QueryPool m_query_pool{ nullptr };
+    std::vector<uint8_t> m_written;
+};
+
+}// namespace th
@@ -183,16 +183,117 @@ void GradientPipeline::dispatch(const vk::CommandBuffer command_buffer) const {
 auto VulkanGraphicsPipelineBuilder::build(const vk::raii::Device& device, const vk::PipelineLayout& pipeline_layout,
                                           const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache) const
         -> vk::raii::Pipeline {
+    return createPipeline(device, pipeline_layout, pipeline_cache, nullptr);
+}
+
+auto VulkanGraphicsPipelineBuilder::build(const vk::raii::Device& device, const vk::PipelineLayout& pipeline_layout,
+                                          const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache,
+                                          vk::PipelineCreationFeedback& feedback) const -> vk::raii::Pipeline {
+    return createPipeline(device, pipeline_layout, pipeline_cache, &feedback);
+}
+
+auto VulkanGraphicsPipelineBuilder::hash(const vk::PipelineLayout pipeline_layout) const -> uint64_t {
+    auto hasher = Fnv1aHasher{};
+    hasher.addValue(static_cast<VkPipelineLayout>(pipeline_layout));
+    if (m_shader_code_hash.has_value()) {
+        hasher.addValue(*m_shader_code_hash);
+    }
+    for (const auto& stage : m_shader_stages) {
+        hasher.addValue(stage.flags).addValue(stage.stage).add(std::string_view{ stage.pName });
+        if (!m_shader_code_hash.has_value()) {
+            hasher.addValue(static_cast<VkShaderModule>(stage.module));
+        }
+        if (const auto* specialization_info = stage.pSpecializationInfo; specialization_info != nullptr) {
+            hasher.add(std::as_bytes(std::span{ specialization_info->pMapEntries, specialization_info->mapEntryCount }))
+                    .add(std::span{ static_cast<const std::byte*>(specialization_info->pData),
+                                    specialization_info->dataSize });
+        }
+    }
+    for (const auto format : m_color_attachment_formats) {
+        hasher.addValue(format);
+    }
+    hasher.addValue(m_rendering_create_info.viewMask)
+            .addValue(m_rendering_create_info.depthAttachmentFormat)
+            .addValue(m_rendering_create_info.stencilAttachmentFormat);
+
+    hasher.addValue(m_blend_attachment_state.blendEnable)
+            .addValue(m_blend_attachment_state.srcColorBlendFactor)
+            .addValue(m_blend_attachment_state.dstColorBlendFactor)
+            .addValue(m_blend_attachment_state.colorBlendOp)
+            .addValue(m_blend_attachment_state.srcAlphaBlendFactor)
+            .addValue(m_blend_attachment_state.dstAlphaBlendFactor)
+            .addValue(m_blend_attachment_state.alphaBlendOp)
+            .addValue(m_blend_attachment_state.colorWriteMask);
+
+    hasher.add(std::as_bytes(std::span{ m_vertex_binding_descriptions }))
+            .add(std::as_bytes(std::span{ m_vertex_attribute_descriptions }));
+
+    hasher.addValue(m_input_assembly_state_create_info.topology)
+            .addValue(m_input_assembly_state_create_info.primitiveRestartEnable);
+
+    hasher.addValue(m_rasterization_state_create_info.depthClampEnable)
+            .addValue(m_rasterization_state_create_info.rasterizerDiscardEnable)
+            .addValue(m_rasterization_state_create_info.polygonMode)
+            .addValue(m_rasterization_state_create_info.cullMode)
+            .addValue(m_rasterization_state_create_info.frontFace)
+            .addValue(m_rasterization_state_create_info.depthBiasEnable)
+            .addValue(m_rasterization_state_create_info.depthBiasConstantFactor)
+            .addValue(m_rasterization_state_create_info.depthBiasClamp)
+            .addValue(m_rasterization_state_create_info.depthBiasSlopeFactor)
+            .addValue(m_rasterization_state_create_info.lineWidth);
+
+    hasher.addValue(m_multisample_state_create_info.rasterizationSamples)
+            .addValue(m_multisample_state_create_info.sampleShadingEnable)
+            .addValue(m_multisample_state_create_info.minSampleShading)
+            .addValue(m_multisample_state_create_info.alphaToCoverageEnable)
+            .addValue(m_multisample_state_create_info.alphaToOneEnable);
+
+    hasher.addValue(m_depth_stencil_state_create_info.depthTestEnable)
+            .addValue(m_depth_stencil_state_create_info.depthWriteEnable)
+            .addValue(m_depth_stencil_state_create_info.depthCompareOp)
+            .addValue(m_depth_stencil_state_create_info.depthBoundsTestEnable)
+            .addValue(m_depth_stencil_state_create_info.stencilTestEnable)
+            .addValue(m_depth_stencil_state_create_info.front)
+            .addValue(m_depth_stencil_state_create_info.back)
+            .addValue(m_depth_stencil_state_create_info.minDepthBounds)
+            .addValue(m_depth_stencil_state_create_info.maxDepthBounds);
+    return hasher.getValue();
+}
+
+auto VulkanGraphicsPipelineBuilder::createPipeline(const vk::raii::Device& device,
+                                                   const vk::PipelineLayout& pipeline_layout,
+                                                   const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache,
+                                                   vk::PipelineCreationFeedback* feedback) const
+        -> vk::raii::Pipeline {
+    // Builders are copied into compile jobs, so the attachment formats and vertex input descriptions are re-pointed
+    // at this instance's storage.
+    auto rendering_create_info = m_rendering_create_info;
+    if (rendering_create_info.colorAttachmentCount != 0) {
+        rendering_create_info.pColorAttachmentFormats = m_color_attachment_formats.data();
+    }
+    auto vertex_input_state_create_info = m_vertex_input_state_create_info;
+    vertex_input_state_create_info.pVertexBindingDescriptions = m_vertex_binding_descriptions.data();
+    vertex_input_state_create_info.pVertexAttributeDescriptions = m_vertex_attribute_descriptions.data();
+    const auto feedback_create_info = vk::PipelineCreationFeedbackCreateInfo{
+        .pNext = &rendering_create_info,
+        .pPipelineCreationFeedback = feedback,
+    };
+    const void* next = feedback != nullptr ? static_cast<const void*>(&feedback_create_info) : &rendering_create_info;
+
     constexpr auto viewport_state = vk::PipelineViewportStateCreateInfo{
         .viewportCount = 1,
         .scissorCount = 1,
     };
 
+    // Depth-only pipelines have no colour attachments and so no blend states.
+    const auto blend_attachment_states =
+            std::vector(rendering_create_info.colorAttachmentCount, m_blend_attachment_state);
     const auto color_blend_state_create_info =
             vk::PipelineColorBlendStateCreateInfo{ .logicOpEnable = vk::False,
                                                    .logicOp = vk::LogicOp::eCopy,
-                                                   .attachmentCount = 1,
-                                                   .pAttachments = &m_blend_attachment_state,
+                                                   .attachmentCount =
+                                                           static_cast<uint32_t>(blend_attachment_states.size()),
+                                                   .pAttachments = blend_attachment_states.data(),
                                                    .blendConstants = std::array{ 0.0f, 0.0f, 0.0f, 0.0f } };
     constexpr auto dynamic_states = std::array{ vk::DynamicState::eViewport, vk::DynamicState::eScissor };
     const auto dynamic_state_create_info = vk::PipelineDynamicStateCreateInfo{
@@ -203,10 +304,10 @@ auto VulkanGraphicsPipelineBuilder::build(const vk::raii::Device& device, const
 
     return device.createGraphicsPipeline(pipeline_cache,
                                          vk::GraphicsPipelineCreateInfo{
-                                                 .pNext = &m_rendering_create_info,
+                                                 .pNext = next,
                                                  .stageCount = static_cast<uint32_t>(m_shader_stages.size()),
                                                  .pStages = m_shader_stages.data(),
-                                                 .pVertexInputState = &m_vertex_input_state_create_info,
+                                                 .pVertexInputState = &vertex_input_state_create_info,
                                                  .pInputAssemblyState = &m_input_assembly_state_create_info,
                                                  .pTessellationState = nullptr,
                                                  .pViewportState = &viewport_state,
@@ -310,7 +411,20 @@ auto VulkanGraphicsPipelineBuilder::enableDepthStencil(const vk::PipelineDepthSt
 
 auto VulkanGraphicsPipelineBuilder::setVertexInputState(const vk::PipelineVertexInputStateCreateInfo& info)
         -> VulkanGraphicsPipelineBuilder& {
+    // The caller's descriptions only have to outlive this call, like the attachment formats.
+    m_vertex_binding_descriptions.assign(info.pVertexBindingDescriptions,
+                                         info.pVertexBindingDescriptions + info.vertexBindingDescriptionCount);
+    m_vertex_attribute_descriptions.assign(info.pVertexAttributeDescriptions,
+                                           info.pVertexAttributeDescriptions + info.vertexAttributeDescriptionCount);
     m_vertex_input_state_create_info = info;
+    m_vertex_input_state_create_info.pVertexBindingDescriptions = m_vertex_binding_descriptions.data();
+    m_vertex_input_state_create_info.pVertexAttributeDescriptions = m_vertex_attribute_descriptions.data();
+    return *this;
+}
+
+auto VulkanGraphicsPipelineBuilder::setShaderCode(const std::span<const uint32_t> spir_v)
+        -> VulkanGraphicsPipelineBuilder& {
+    m_shader_code_hash = Fnv1aHasher{}.add(std::as_bytes(spir_v)).getValue();
     return *this;
 }
 
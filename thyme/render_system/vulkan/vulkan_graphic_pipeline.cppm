@@ -22,6 +22,15 @@ public:
                              const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache = nullptr) const
             -> vk::raii::Pipeline;
 
+    // Same as above, additionally reporting whether the pipeline came out of the pipeline cache.
+    [[nodiscard]] auto build(const vk::raii::Device& device, const vk::PipelineLayout& pipeline_layout,
+                             const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache,
+                             vk::PipelineCreationFeedback& feedback) const -> vk::raii::Pipeline;
+
+    // Hash of the complete pipeline state. Shaders are identified by the code passed to setShaderCode, or by their
+    // module handles when no code was given, which is only unique while those modules are alive.
+    [[nodiscard]] auto hash(vk::PipelineLayout pipeline_layout) const -> uint64_t;
+
     auto setShader(vk::PipelineShaderStageCreateInfo shader_stage_create_info) -> VulkanGraphicsPipelineBuilder&;
     auto setShaders(std::span<const vk::PipelineShaderStageCreateInfo> shader_stage_create_info_list)
             -> VulkanGraphicsPipelineBuilder&;
@@ -34,10 +43,19 @@ public:
     auto disableDepthTest() -> VulkanGraphicsPipelineBuilder&;
     auto enableDepthStencil(const vk::PipelineDepthStencilStateCreateInfo& info) -> VulkanGraphicsPipelineBuilder&;
     auto setVertexInputState(const vk::PipelineVertexInputStateCreateInfo& info) -> VulkanGraphicsPipelineBuilder&;
+    auto setShaderCode(std::span<const uint32_t> spir_v) -> VulkanGraphicsPipelineBuilder&;
+
+private:
+    [[nodiscard]] auto createPipeline(const vk::raii::Device& device, const vk::PipelineLayout& pipeline_layout,
+                                      const vk::Optional<const vk::raii::PipelineCache>& pipeline_cache,
+                                      vk::PipelineCreationFeedback* feedback) const -> vk::raii::Pipeline;
 
 private:
     std::vector<vk::Format> m_color_attachment_formats{ vk::Format::eA8B8G8R8UnormPack32 };
+    std::vector<vk::VertexInputBindingDescription> m_vertex_binding_descriptions;
+    std::vector<vk::VertexInputAttributeDescription> m_vertex_attribute_descriptions;
     std::vector<vk::PipelineShaderStageCreateInfo> m_shader_stages;
+    std::optional<uint64_t> m_shader_code_hash;
 
     vk::PipelineRenderingCreateInfo m_rendering_create_info;
     vk::PipelineColorBlendAttachmentState m_blend_attachment_state;
@@ -0,0 +1,151 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+GpuMemoryDefragmenter::GpuMemoryDefragmenter(const vma::raii::Allocator& allocator, const vma::Pool pool,
+                                             const vk::raii::Device& device, const uint32_t queue_family_index,
+                                             DeferredDeletionQueue& deletion_queue,
+                                             const DefragmentationSettings& settings, Logger& logger)
+    : m_allocator{ allocator }, m_pool{ pool }, m_device{ device }, m_deletion_queue{ deletion_queue },
+      m_settings{ settings }, m_logger{ logger }, m_queue{ device.getQueue(queue_family_index, 0) },
+      m_command_pool{ device.createCommandPool(
+              vk::CommandPoolCreateInfo{ .flags = vk::CommandPoolCreateFlagBits::eTransient
+                                                  | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+                                         .queueFamilyIndex = queue_family_index }) },
+      m_fence{ device, vk::FenceCreateInfo{} } {
+    m_command_buffer = std::move(device.allocateCommandBuffers(vk::CommandBufferAllocateInfo{
+                                                                       .commandPool = m_command_pool,
+                                                                       .level = vk::CommandBufferLevel::ePrimary,
+                                                                       .commandBufferCount = 1u,
+                                                               })
+                                         .front());
+}
+
+GpuMemoryDefragmenter::~GpuMemoryDefragmenter() {
+    if (m_state == State::copying || m_state == State::retiring) {
+        // Only reached at shutdown, waiting is fine and the owners are gone, so the commits are dropped.
+        static_cast<void>(m_device.waitForFences({ m_fence }, vk::True, std::numeric_limits<uint64_t>::max()));
+        m_commits.clear();
+        endPass();
+    }
+    if (m_state != State::idle) {
+        finish();
+    }
+}
+
+void GpuMemoryDefragmenter::registerAllocation(const vma::Allocation allocation, RelocateFunction relocate) {
+    m_clients.insert_or_assign(allocation, std::move(relocate));
+}
+
+void GpuMemoryDefragmenter::unregisterAllocation(const vma::Allocation allocation) {
+    m_clients.erase(allocation);
+}
+
+void GpuMemoryDefragmenter::start() {
+    if (m_state != State::idle || m_clients.empty()) {
+        return;
+    }
+    m_context = (*m_allocator).beginDefragmentation(vma::DefragmentationInfo{
+            .flags = vma::DefragmentationFlagBits::eAlgorithmBalanced,
+            .pool = m_pool,
+            .maxBytesPerPass = m_settings.max_bytes_per_pass,
+            .maxAllocationsPerPass = m_settings.max_allocations_per_pass,
+    });
+    m_state = State::planning;
+    m_logger.debug("GPU memory defragmentation started for {} allocations", m_clients.size());
+}
+
+void GpuMemoryDefragmenter::update() {
+    switch (m_state) {
+        case State::idle: return;
+        case State::planning: beginPass(); return;
+        case State::copying: {
+            if (m_fence.getStatus() != vk::Result::eSuccess) {
+                return;
+            }
+            m_device.resetFences({ m_fence });
+            for (auto& commit : m_commits) {
+                commit();
+            }
+            m_commits.clear();
+            // Frames recorded before the commits may still read the old resources, which live in the old memory.
+            m_pass_retired = std::make_shared<std::atomic<bool>>(false);
+            m_deletion_queue.defer([retired = m_pass_retired] { retired->store(true, std::memory_order_release); });
+            m_state = State::retiring;
+            return;
+        }
+        case State::retiring: {
+            if (m_pass_retired->load(std::memory_order_acquire)) {
+                endPass();
+            }
+            return;
+        }
+    }
+}
+
+void GpuMemoryDefragmenter::beginPass() {
+    const auto& allocator = *m_allocator;
+    if (allocator.beginDefragmentationPass(m_context, &m_pass) == vk::Result::eSuccess) {
+        finish();
+        return;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    m_command_buffer.begin(vk::CommandBufferBeginInfo{ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    for (auto& move : std::span{ m_pass.pMoves, m_pass.moveCount }) {
+        const auto client = m_clients.find(move.srcAllocation);
+        if (client == m_clients.end() || std::chrono::steady_clock::now() - start_time > m_settings.time_budget) {
+            move.operation = vma::DefragmentationMoveOperation::eIgnore;
+            continue;
+        }
+        m_commits.push_back(client->second(m_command_buffer, move.dstTmpAllocation));
+    }
+    constexpr auto copy_barrier = vk::MemoryBarrier2{
+        .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .dstAccessMask = vk::AccessFlagBits2::eMemoryRead,
+    };
+    m_command_buffer.pipelineBarrier2(vk::DependencyInfo{ .memoryBarrierCount = 1, .pMemoryBarriers = &copy_barrier });
+    m_command_buffer.end();
+    m_queue.submit(vk::SubmitInfo{ .commandBufferCount = 1u, .pCommandBuffers = &*m_command_buffer }, m_fence);
+    m_state = State::copying;
+}
+
+void GpuMemoryDefragmenter::endPass() {
+    m_command_buffer.reset();
+    const auto result = (*m_allocator).endDefragmentationPass(m_context, &m_pass);
+    releaseRetired();
+    m_state = result == vk::Result::eSuccess ? State::idle : State::planning;
+    if (m_state == State::idle) {
+        finish();
+    }
+}
+
+void GpuMemoryDefragmenter::finish() {
+    auto statistics = vma::DefragmentationStats{};
+    (*m_allocator).endDefragmentation(m_context, &statistics);
+    m_context = vma::DefragmentationContext{};
+    m_state = State::idle;
+    releaseRetired();
+    m_statistics.bytes_moved += statistics.bytesMoved;
+    m_statistics.bytes_freed += statistics.bytesFreed;
+    m_statistics.allocations_moved += statistics.allocationsMoved;
+    m_statistics.device_memory_blocks_freed += statistics.deviceMemoryBlocksFreed;
+    m_logger.info("GPU memory defragmentation moved {} allocations ({} bytes), freed {} blocks ({} bytes)",
+                  statistics.allocationsMoved,
+                  statistics.bytesMoved,
+                  statistics.deviceMemoryBlocksFreed,
+                  statistics.bytesFreed);
+}
+
+void GpuMemoryDefragmenter::releaseRetired() {
+    for (auto& retired : m_retired_during_pass) {
+        m_deletion_queue.defer(std::move(retired));
+    }
+    m_retired_during_pass.clear();
+}
+
+}// namespace th
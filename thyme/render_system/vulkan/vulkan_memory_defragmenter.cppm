@@ -0,0 +1,115 @@
+export module th.render_system.vulkan:memory_defragmenter;
+
+import std;
+
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+
+import :deletion_queue;
+
+namespace th {
+
+export struct DefragmentationSettings {
+    // CPU time a single update may spend recording moves, the remaining moves of the pass are skipped.
+    std::chrono::microseconds time_budget{ 500 };
+    vk::DeviceSize max_bytes_per_pass{ 16 * 1024 * 1024 };
+    uint32_t max_allocations_per_pass{ 64 };
+};
+
+export struct DefragmentationStatistics {
+    vk::DeviceSize bytes_moved{ 0 };
+    vk::DeviceSize bytes_freed{ 0 };
+    uint32_t allocations_moved{ 0 };
+    uint32_t device_memory_blocks_freed{ 0 };
+};
+
+// Called for an allocation chosen to move: binds a replacement resource to the destination memory and records the
+// copy into it. The returned function switches the owner over to the replacement once the copy has completed.
+export using RelocateFunction =
+        std::function<std::move_only_function<void()>(vk::CommandBuffer command_buffer, vma::Allocation destination)>;
+
+// Compacts long-lived allocations with VMA's incremental defragmentation, a pass per a few frames without stalling:
+//  1. a pass is planned and the copies of the registered allocations are recorded within the time budget,
+//  2. once the copies completed the owners switch to the moved resources and retire the old ones,
+//  3. once the frames that might still read the old resources completed the pass is ended and VMA frees the old memory.
+// Only the allocations of the given pool are considered, and of those only the registered ones are moved. A registered
+// allocation must not be freed during a pass moving it.
+export class GpuMemoryDefragmenter {
+public:
+    GpuMemoryDefragmenter(const vma::raii::Allocator& allocator, vma::Pool pool, const vk::raii::Device& device,
+                          uint32_t queue_family_index, DeferredDeletionQueue& deletion_queue,
+                          const DefragmentationSettings& settings, Logger& logger);
+
+    GpuMemoryDefragmenter(const GpuMemoryDefragmenter&) = delete;
+    GpuMemoryDefragmenter(GpuMemoryDefragmenter&&) = delete;
+    auto operator=(const GpuMemoryDefragmenter&) -> GpuMemoryDefragmenter& = delete;
+    auto operator=(GpuMemoryDefragmenter&&) -> GpuMemoryDefragmenter& = delete;
+    ~GpuMemoryDefragmenter();
+
+    void registerAllocation(vma::Allocation allocation, RelocateFunction relocate);
+    void unregisterAllocation(vma::Allocation allocation);
+
+    // For owners freeing registered allocations while a pass runs: the object is handed to the deletion queue once
+    // the pass has ended, or right away when idle.
+    template <typename T>
+    void retire(T object) {
+        if (m_state == State::idle) {
+            m_deletion_queue.retire(std::move(object));
+        } else {
+            m_retired_during_pass.emplace_back([object = std::move(object)] {});
+        }
+    }
+
+    // Starts compacting, the work is spread over the following updates.
+    void start();
+    // Call once per frame from the thread submitting frames. Never waits for the GPU.
+    void update();
+
+    [[nodiscard]] auto isRunning() const noexcept -> bool {
+        return m_state != State::idle;
+    }
+
+    [[nodiscard]] auto getStatistics() const noexcept -> const DefragmentationStatistics& {
+        return m_statistics;
+    }
+
+private:
+    enum struct State {
+        idle,
+        planning,
+        copying,
+        retiring
+    };
+
+    void beginPass();
+    void endPass();
+    void finish();
+    void releaseRetired();
+
+private:
+    const vma::raii::Allocator& m_allocator;
+    vma::Pool m_pool;
+    const vk::raii::Device& m_device;
+    DeferredDeletionQueue& m_deletion_queue;
+    DefragmentationSettings m_settings;
+    Logger& m_logger;
+
+    vk::raii::Queue m_queue;
+    vk::raii::CommandPool m_command_pool;
+    vk::raii::CommandBuffer m_command_buffer{ nullptr };
+    vk::raii::Fence m_fence;
+
+    std::unordered_map<vma::Allocation, RelocateFunction> m_clients;
+
+    State m_state{ State::idle };
+    vma::DefragmentationContext m_context{};
+    vma::DefragmentationPassMoveInfo m_pass{};
+    std::vector<std::move_only_function<void()>> m_commits;
+    std::vector<std::move_only_function<void()>> m_retired_during_pass;
+    std::shared_ptr<std::atomic<bool>> m_pass_retired;
+    DefragmentationStatistics m_statistics;
+};
+
+}// namespace th
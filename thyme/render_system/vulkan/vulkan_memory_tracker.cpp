@@ -0,0 +1,178 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+constexpr auto toString(const GpuMemoryCategory category) -> std::string_view {
+    switch (category) {
+        case GpuMemoryCategory::mesh: return "mesh";
+        case GpuMemoryCategory::texture: return "texture";
+        case GpuMemoryCategory::render_target: return "render target";
+        case GpuMemoryCategory::uniform_buffer: return "uniform buffer";
+        case GpuMemoryCategory::frame_arena: return "frame arena";
+        case GpuMemoryCategory::staging: return "staging";
+        case GpuMemoryCategory::lighting: return "lighting";
+        case GpuMemoryCategory::instance_data: return "instance data";
+    }
+    std::unreachable();
+}
+
+[[nodiscard]] static constexpr auto toMiB(const vk::DeviceSize bytes) noexcept -> double {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void GpuMemoryTag::reset() noexcept {
+    if (m_tracker != nullptr) {
+        std::exchange(m_tracker, nullptr)->release(m_id);
+    }
+}
+
+GpuMemoryTracker::GpuMemoryTracker(const vma::raii::Allocator& allocator,
+                                   const vk::raii::PhysicalDevice& physical_device, Logger& logger)
+    : m_allocator{ allocator }, m_logger{ logger }, m_memory_properties{ physical_device.getMemoryProperties() },
+      m_heap_tracked_bytes(m_memory_properties.memoryHeapCount, 0),
+      m_heap_peak_usage(m_memory_properties.memoryHeapCount, 0) {}
+
+GpuMemoryTracker::~GpuMemoryTracker() {
+    std::scoped_lock lock{ m_mutex };
+    if (m_entries.empty()) {
+        return;
+    }
+    m_logger.warn("{} GPU allocations of {} bytes are still tracked at shutdown", m_entries.size(), m_tracked_bytes);
+    for (const auto& entry : m_entries | std::views::values) {
+        m_logger.warn("Leaked {} allocation {} of {} bytes", toString(entry.category), entry.name, entry.size);
+    }
+}
+
+auto GpuMemoryTracker::track(const vma::Allocation allocation, const GpuMemoryCategory category,
+                             const std::string_view name) -> GpuMemoryTag {
+    auto entry = Entry{ .name = std::string{ name }, .category = category };
+    m_allocator.setAllocationName(allocation, entry.name.c_str());
+    const auto allocation_info = m_allocator.getAllocationInfo(allocation);
+    entry.heap = m_memory_properties.memoryTypes[allocation_info.memoryType].heapIndex;
+    entry.size = allocation_info.size;
+
+    std::scoped_lock lock{ m_mutex };
+    auto& category_statistics = m_categories[std::to_underlying(category)];
+    category_statistics.bytes += entry.size;
+    category_statistics.peak_bytes = std::max(category_statistics.peak_bytes, category_statistics.bytes);
+    ++category_statistics.allocation_count;
+    m_heap_tracked_bytes[entry.heap] += entry.size;
+    m_tracked_bytes += entry.size;
+    m_peak_tracked_bytes = std::max(m_peak_tracked_bytes, m_tracked_bytes);
+    m_current_churn.allocated_bytes += entry.size;
+    ++m_current_churn.allocations;
+
+    const auto id = m_next_id++;
+    m_entries.emplace(id, std::move(entry));
+    return GpuMemoryTag{ *this, id };
+}
+
+void GpuMemoryTracker::release(const uint64_t id) noexcept {
+    std::scoped_lock lock{ m_mutex };
+    const auto node = m_entries.extract(id);
+    if (node.empty()) {
+        return;
+    }
+    const auto& entry = node.mapped();
+    auto& category_statistics = m_categories[std::to_underlying(entry.category)];
+    category_statistics.bytes -= entry.size;
+    --category_statistics.allocation_count;
+    m_heap_tracked_bytes[entry.heap] -= entry.size;
+    m_tracked_bytes -= entry.size;
+    m_current_churn.freed_bytes += entry.size;
+    ++m_current_churn.frees;
+}
+
+void GpuMemoryTracker::endFrame(const uint32_t frame_index) {
+    // VMA refreshes the budgets it fetches from VK_EXT_memory_budget on frame index changes.
+    m_allocator.setCurrentFrameIndex(frame_index);
+    const auto budgets = m_allocator.getHeapBudgets();
+
+    std::scoped_lock lock{ m_mutex };
+    for (auto heap = 0uz; heap < m_heap_peak_usage.size(); ++heap) {
+        m_heap_peak_usage[heap] = std::max(m_heap_peak_usage[heap], budgets[heap].usage);
+    }
+    m_frame_churn = std::exchange(m_current_churn, GpuMemoryChurn{});
+    if (m_frame_churn.allocated_bytes + m_frame_churn.freed_bytes
+        > m_peak_frame_churn.allocated_bytes + m_peak_frame_churn.freed_bytes) {
+        m_peak_frame_churn = m_frame_churn;
+    }
+}
+
+auto GpuMemoryTracker::getStatistics() const -> GpuMemoryStatistics {
+    const auto budgets = m_allocator.getHeapBudgets();
+
+    std::scoped_lock lock{ m_mutex };
+    auto statistics = GpuMemoryStatistics{
+        .categories = m_categories,
+        .tracked_bytes = m_tracked_bytes,
+        .peak_tracked_bytes = m_peak_tracked_bytes,
+        .frame_churn = m_frame_churn,
+        .peak_frame_churn = m_peak_frame_churn,
+    };
+    for (uint32_t heap{ 0 }; heap < m_memory_properties.memoryHeapCount; ++heap) {
+        const auto& budget = budgets[heap];
+        statistics.heaps.push_back(GpuMemoryHeapStatistics{
+                .flags = m_memory_properties.memoryHeaps[heap].flags,
+                .size = m_memory_properties.memoryHeaps[heap].size,
+                .tracked_bytes = m_heap_tracked_bytes[heap],
+                .allocation_bytes = budget.statistics.allocationBytes,
+                .block_bytes = budget.statistics.blockBytes,
+                .usage = budget.usage,
+                .budget = budget.budget,
+                .peak_usage = std::max(m_heap_peak_usage[heap], budget.usage),
+        });
+    }
+    return statistics;
+}
+
+auto GpuMemoryTracker::buildJsonStatistics(const bool detailed) const -> std::string {
+    return m_allocator.buildStatsString(detailed ? vk::True : vk::False);
+}
+
+void GpuMemoryTracker::dumpJsonStatistics(const std::filesystem::path& path, const bool detailed) const {
+    const auto json = buildJsonStatistics(detailed);
+    std::ofstream file(path, std::ios::trunc);
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (!file) {
+        throw std::runtime_error(std::format("Could not write {}", path.string()));
+    }
+    m_logger.info("GPU memory statistics written to {}", path.string());
+}
+
+void GpuMemoryTracker::logStatistics() const {
+    const auto statistics = getStatistics();
+    m_logger.info("GPU memory tracked {:.2f} MiB, peak {:.2f} MiB, busiest frame allocated {:.2f} and freed {:.2f} MiB",
+                  toMiB(statistics.tracked_bytes),
+                  toMiB(statistics.peak_tracked_bytes),
+                  toMiB(statistics.peak_frame_churn.allocated_bytes),
+                  toMiB(statistics.peak_frame_churn.freed_bytes));
+    for (auto category = 0uz; category < gpu_memory_category_count; ++category) {
+        const auto& category_statistics = statistics.categories[category];
+        if (category_statistics.peak_bytes == 0) {
+            continue;
+        }
+        m_logger.info("  {}: {} allocations, {:.2f} MiB, peak {:.2f} MiB",
+                      toString(static_cast<GpuMemoryCategory>(category)),
+                      category_statistics.allocation_count,
+                      toMiB(category_statistics.bytes),
+                      toMiB(category_statistics.peak_bytes));
+    }
+    for (auto heap = 0uz; heap < statistics.heaps.size(); ++heap) {
+        const auto& heap_statistics = statistics.heaps[heap];
+        m_logger.info("  heap {}{}: tracked {:.2f} MiB, allocated {:.2f} MiB in {:.2f} MiB of blocks, usage {:.2f} MiB "
+                      "(peak {:.2f} MiB) of {:.2f} MiB budget",
+                      heap,
+                      heap_statistics.flags & vk::MemoryHeapFlagBits::eDeviceLocal ? " (device local)" : "",
+                      toMiB(heap_statistics.tracked_bytes),
+                      toMiB(heap_statistics.allocation_bytes),
+                      toMiB(heap_statistics.block_bytes),
+                      toMiB(heap_statistics.usage),
+                      toMiB(heap_statistics.peak_usage),
+                      toMiB(heap_statistics.budget));
+    }
+}
+
+}// namespace th
@@ -0,0 +1,155 @@
+export module th.render_system.vulkan:memory_tracker;
+
+import std;
+
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.logger;
+
+namespace th {
+
+export enum struct GpuMemoryCategory : uint32_t {
+    mesh = 0,
+    texture = 1,
+    render_target = 2,
+    uniform_buffer = 3,
+    frame_arena = 4,
+    staging = 5,
+    lighting = 6,
+    instance_data = 7,
+};
+
+export constexpr auto gpu_memory_category_count = std::size_t{ 8 };
+
+export struct GpuMemoryCategoryStatistics {
+    vk::DeviceSize bytes{ 0 };
+    vk::DeviceSize peak_bytes{ 0 };
+    uint32_t allocation_count{ 0 };
+};
+
+export struct GpuMemoryHeapStatistics {
+    vk::MemoryHeapFlags flags{};
+    vk::DeviceSize size{ 0 };
+    // Bytes of the tagged allocations placed in the heap.
+    vk::DeviceSize tracked_bytes{ 0 };
+    // VMA's view: bytes of all allocations of the process and of the device memory blocks holding them.
+    vk::DeviceSize allocation_bytes{ 0 };
+    vk::DeviceSize block_bytes{ 0 };
+    // The driver's view, which also covers other processes when VK_EXT_memory_budget is enabled.
+    vk::DeviceSize usage{ 0 };
+    vk::DeviceSize budget{ 0 };
+    vk::DeviceSize peak_usage{ 0 };
+};
+
+export struct GpuMemoryChurn {
+    vk::DeviceSize allocated_bytes{ 0 };
+    vk::DeviceSize freed_bytes{ 0 };
+    uint32_t allocations{ 0 };
+    uint32_t frees{ 0 };
+};
+
+export struct GpuMemoryStatistics {
+    std::array<GpuMemoryCategoryStatistics, gpu_memory_category_count> categories{};
+    std::vector<GpuMemoryHeapStatistics> heaps;
+    vk::DeviceSize tracked_bytes{ 0 };
+    vk::DeviceSize peak_tracked_bytes{ 0 };
+    // Allocations made and freed during the last completed frame, and during the busiest frame so far.
+    GpuMemoryChurn frame_churn;
+    GpuMemoryChurn peak_frame_churn;
+};
+
+export class GpuMemoryTracker;
+
+// Keeps an allocation accounted to its category for as long as the tag lives. Store it next to the resource owning the
+// allocation so both are moved and destroyed together, including through the deferred deletion queue.
+export class GpuMemoryTag {
+public:
+    GpuMemoryTag() = default;
+
+    GpuMemoryTag(const GpuMemoryTag&) = delete;
+    GpuMemoryTag(GpuMemoryTag&& other) noexcept
+        : m_tracker{ std::exchange(other.m_tracker, nullptr) }, m_id{ other.m_id } {}
+    auto operator=(const GpuMemoryTag&) -> GpuMemoryTag& = delete;
+    auto operator=(GpuMemoryTag&& other) noexcept -> GpuMemoryTag& {
+        if (this != &other) {
+            reset();
+            m_tracker = std::exchange(other.m_tracker, nullptr);
+            m_id = other.m_id;
+        }
+        return *this;
+    }
+    ~GpuMemoryTag() {
+        reset();
+    }
+
+    void reset() noexcept;
+
+private:
+    GpuMemoryTag(GpuMemoryTracker& tracker, const uint64_t id) noexcept : m_tracker{ &tracker }, m_id{ id } {}
+
+    GpuMemoryTracker* m_tracker{ nullptr };
+    uint64_t m_id{ 0 };
+
+    friend class GpuMemoryTracker;
+};
+
+// Accounts the GPU memory of tagged allocations per category and per heap, next to the heap budgets VMA reports, and
+// records the peak usage and the allocation churn of each frame. The debug names given to track() are also set on the
+// VMA allocations, so they appear in the JSON dump. Tags may be created and destroyed on any thread.
+export class GpuMemoryTracker {
+public:
+    GpuMemoryTracker(const vma::raii::Allocator& allocator, const vk::raii::PhysicalDevice& physical_device,
+                     Logger& logger);
+
+    GpuMemoryTracker(const GpuMemoryTracker&) = delete;
+    GpuMemoryTracker(GpuMemoryTracker&&) = delete;
+    auto operator=(const GpuMemoryTracker&) -> GpuMemoryTracker& = delete;
+    auto operator=(GpuMemoryTracker&&) -> GpuMemoryTracker& = delete;
+    ~GpuMemoryTracker();
+
+    [[nodiscard]] auto track(vma::Allocation allocation, GpuMemoryCategory category, std::string_view name)
+            -> GpuMemoryTag;
+
+    // Closes the churn window of the frame and samples the heap usage for the peaks. Call once per frame.
+    void endFrame(uint32_t frame_index);
+
+    [[nodiscard]] auto getStatistics() const -> GpuMemoryStatistics;
+
+    // VMA's statistics as JSON; the detailed map lists every allocation with its name.
+    [[nodiscard]] auto buildJsonStatistics(bool detailed = true) const -> std::string;
+    void dumpJsonStatistics(const std::filesystem::path& path, bool detailed = true) const;
+
+    void logStatistics() const;
+
+private:
+    struct Entry {
+        std::string name;
+        GpuMemoryCategory category;
+        uint32_t heap;
+        vk::DeviceSize size;
+    };
+
+    void release(uint64_t id) noexcept;
+
+private:
+    const vma::raii::Allocator& m_allocator;
+    Logger& m_logger;
+    vk::PhysicalDeviceMemoryProperties m_memory_properties;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    uint64_t m_next_id{ 0 };
+    std::array<GpuMemoryCategoryStatistics, gpu_memory_category_count> m_categories{};
+    std::vector<vk::DeviceSize> m_heap_tracked_bytes;
+    std::vector<vk::DeviceSize> m_heap_peak_usage;
+    vk::DeviceSize m_tracked_bytes{ 0 };
+    vk::DeviceSize m_peak_tracked_bytes{ 0 };
+    GpuMemoryChurn m_current_churn;
+    GpuMemoryChurn m_frame_churn;
+    GpuMemoryChurn m_peak_frame_churn;
+
+    friend class GpuMemoryTag;
+};
+
+}// namespace th
@@ -8,17 +8,21 @@ import th.scene.model;
 
 namespace th {
 
-auto GpuStaticMesh::create(const vma::raii::Allocator& allocator, const vk::Device device,
-                           const vk::CommandPool command_pool, const vk::Queue graphic_queue,
-                           const std::span<const uint32_t> indices, const std::span<const Vertex> vertices)
-        -> GpuStaticMesh {
+auto GpuStaticMesh::create(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                           const vk::Device device, const vk::CommandPool command_pool, const vk::Queue graphic_queue,
+                           const std::span<const uint32_t> indices, const std::span<const Vertex> vertices,
+                           const vma::Pool pool) -> GpuStaticMesh {
+    const auto content_hash = hashMeshContent(indices, vertices);
     const auto vertex_buffer_size = static_cast<uint32_t>(vertices.size()) * sizeof(Vertex);
-    auto vertex_buffer = createVertexBuffer(allocator, vertex_buffer_size);
+    auto vertex_buffer = createVertexBuffer(allocator, vertex_buffer_size, pool);
 
     const auto indices_buffer_size = static_cast<uint32_t>(indices.size()) * sizeof(uint32_t);
-    auto index_buffer = createIndexBuffer(allocator, indices_buffer_size);
+    auto index_buffer = createIndexBuffer(allocator, indices_buffer_size, pool);
 
     const auto staging_buffer = createStagingBuffer(allocator, vertex_buffer_size + indices_buffer_size);
+    const auto staging_memory_tag = memory_tracker.track(*staging_buffer.getAllocation(),
+                                                         GpuMemoryCategory::staging,
+                                                         std::format("mesh {:016x} staging", content_hash));
     const auto data = staging_buffer.getAllocation().map();
     std::memcpy(data, vertices.data(), vertex_buffer_size);
     std::memcpy(static_cast<char*>(data) + vertex_buffer_size, indices.data(), indices_buffer_size);
@@ -45,10 +49,51 @@ auto GpuStaticMesh::create(const vma::raii::Allocator& allocator, const vk::Devi
 
     const auto vertex_buffer_address = device.getBufferAddress(vk::BufferDeviceAddressInfo{ .buffer = *vertex_buffer });
 
+    auto vertex_memory_tag = memory_tracker.track(*vertex_buffer.getAllocation(),
+                                                  GpuMemoryCategory::mesh,
+                                                  std::format("mesh {:016x} vertices", content_hash));
+    auto index_memory_tag = memory_tracker.track(
+            *index_buffer.getAllocation(), GpuMemoryCategory::mesh, std::format("mesh {:016x} indices", content_hash));
+
     return { .vertex_buffer = std::move(vertex_buffer),
              .index_buffer = std::move(index_buffer),
+             .vertex_memory_tag = std::move(vertex_memory_tag),
+             .index_memory_tag = std::move(index_memory_tag),
+             .vertex_buffer_size = vertex_buffer_size,
+             .index_buffer_size = indices_buffer_size,
              .address = vertex_buffer_address,
-             .indices_size = static_cast<uint32_t>(indices.size()) };
+             .indices_size = static_cast<uint32_t>(indices.size()),
+             .content_hash = content_hash };
+}
+
+auto GpuStaticMesh::getAllocation(const GpuMeshBufferType type) const -> vma::Allocation {
+    return type == GpuMeshBufferType::vertex ? *vertex_buffer.getAllocation() : *index_buffer.getAllocation();
+}
+
+auto GpuStaticMesh::relocate(const vma::raii::Allocator& allocator, const vk::raii::Device& device,
+                             const vk::CommandBuffer command_buffer, const GpuMeshBufferType type,
+                             const vma::Allocation destination) const -> vk::raii::Buffer {
+    const auto is_vertex = type == GpuMeshBufferType::vertex;
+    const auto size = is_vertex ? vertex_buffer_size : index_buffer_size;
+    auto buffer = device.createBuffer(is_vertex ? getVertexBufferCreateInfo(size) : getIndexBufferCreateInfo(size));
+    (*allocator).bindBufferMemory(destination, *buffer);
+    const auto region = vk::BufferCopy2{ .srcOffset = 0, .dstOffset = 0, .size = size };
+    command_buffer.copyBuffer2(vk::CopyBufferInfo2{
+            .srcBuffer = is_vertex ? getVertexBuffer() : getIndexBuffer(),
+            .dstBuffer = *buffer,
+            .regionCount = 1,
+            .pRegions = &region,
+    });
+    return buffer;
+}
+
+auto GpuStaticMesh::commitRelocation(const vk::Device device, const GpuMeshBufferType type, vk::raii::Buffer&& buffer)
+        -> vk::raii::Buffer {
+    if (type == GpuMeshBufferType::index) {
+        return std::exchange(relocated_index_buffer, std::move(buffer));
+    }
+    address = device.getBufferAddress(vk::BufferDeviceAddressInfo{ .buffer = *buffer });
+    return std::exchange(relocated_vertex_buffer, std::move(buffer));
 }
 
 }// namespace th
\ No newline at end of file
@@ -6,27 +6,88 @@ import glm;
 import vulkan;
 import vk_mem_alloc;
 
+import th.core.utils;
 import th.scene.model;
 
+import :bindless;
 import :buffer;
 import :device;
+import :memory_tracker;
 import :uniform_buffer_object;
 import :texture;
 
 
 namespace th {
 
+// Meshes with equal content hashes are treated as the same mesh and drawn instanced.
+export [[nodiscard]] auto hashMeshContent(const std::span<const uint32_t> indices,
+                                          const std::span<const Vertex> vertices) -> uint64_t {
+    return Fnv1aHasher{}
+            .addValue(indices.size())
+            .add(std::as_bytes(indices))
+            .addValue(vertices.size())
+            .add(std::as_bytes(vertices))
+            .getValue();
+}
+
+export enum struct GpuMeshBufferType {
+    vertex,
+    index
+};
+
 export class GpuStaticMesh {
 public:
-    static [[nodiscard]] auto create(const vma::raii::Allocator& allocator, vk::Device device,
-                                     vk::CommandPool command_pool, vk::Queue graphic_queue,
-                                     std::span<const uint32_t> indices, std::span<const Vertex> vertices)
-            -> GpuStaticMesh;
+    // The buffers are allocated from pool when given, see createMeshBufferPool.
+    static [[nodiscard]] auto create(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                                     vk::Device device, vk::CommandPool command_pool, vk::Queue graphic_queue,
+                                     std::span<const uint32_t> indices, std::span<const Vertex> vertices,
+                                     vma::Pool pool = nullptr) -> GpuStaticMesh;
+
+    [[nodiscard]] auto getAllocation(GpuMeshBufferType type) const -> vma::Allocation;
+
+    // Defragmentation support: creates a copy of one of the buffers bound to the destination memory and records the
+    // copy. Once the copy completed commitRelocation switches to it and returns the buffer to retire.
+    [[nodiscard]] auto relocate(const vma::raii::Allocator& allocator, const vk::raii::Device& device,
+                                vk::CommandBuffer command_buffer, GpuMeshBufferType type,
+                                vma::Allocation destination) const -> vk::raii::Buffer;
+    [[nodiscard]] auto commitRelocation(vk::Device device, GpuMeshBufferType type, vk::raii::Buffer&& buffer)
+            -> vk::raii::Buffer;
+
+    [[nodiscard]] auto getVertexBuffer() const noexcept -> vk::Buffer {
+        return *relocated_vertex_buffer ? *relocated_vertex_buffer : *vertex_buffer;
+    }
+
+    [[nodiscard]] auto getIndexBuffer() const noexcept -> vk::Buffer {
+        return *relocated_index_buffer ? *relocated_index_buffer : *index_buffer;
+    }
 
     vma::raii::Buffer vertex_buffer{ nullptr };
     vma::raii::Buffer index_buffer{ nullptr };
+    // Bound to the memory the defragmenter moved the allocations to, the buffers above then only own the allocations.
+    vk::raii::Buffer relocated_vertex_buffer{ nullptr };
+    vk::raii::Buffer relocated_index_buffer{ nullptr };
+    GpuMemoryTag vertex_memory_tag;
+    GpuMemoryTag index_memory_tag;
+    vk::DeviceSize vertex_buffer_size{};
+    vk::DeviceSize index_buffer_size{};
     vk::DeviceAddress address{};
     std::size_t indices_size{};
+    uint64_t content_hash{};
+};
+
+// Affine transforms of a frame. The storage buffer at bindless index transforms holds the first three rows of the world
+// matrix of every scene node, followed by those of the frame's transient instances, as three consecutive float4. The
+// buffer at instance_nodes holds one uint per instance, the index of its transform.
+export struct GpuInstanceTransforms {
+    uint32_t transforms{ BindlessIndex::invalid };
+    uint32_t instance_nodes{ BindlessIndex::invalid };
+};
+
+// One instanced draw: instance_count instances starting at first_instance.
+export struct GpuMeshBatch {
+    const GpuStaticMesh* mesh;
+    uint32_t first_instance;
+    uint32_t instance_count;
 };
 
 }// namespace th
@@ -0,0 +1,136 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+VulkanPipelineCache::VulkanPipelineCache(const vk::raii::PhysicalDevice& physical_device,
+                                         const vk::raii::Device& device, std::filesystem::path file_path,
+                                         Logger& logger)
+    : m_file_path{ std::move(file_path) }, m_logger{ logger } {
+    const auto initial_data = loadInitialData(physical_device);
+    m_pipeline_cache = device.createPipelineCache(vk::PipelineCacheCreateInfo{
+            .initialDataSize = initial_data.size(),
+            .pInitialData = initial_data.data(),
+    });
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    try {
+        save();
+    } catch (const std::exception& e) {
+        m_logger.warn("Cannot save pipeline cache {}, {}", m_file_path.string(), e.what());
+    }
+}
+
+void VulkanPipelineCache::save() const {
+    const auto data = m_pipeline_cache.getData();
+    auto temporary_path = m_file_path;
+    temporary_path += ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            throw std::runtime_error(std::format("Could not write {}", temporary_path.string()));
+        }
+    }
+    std::filesystem::rename(temporary_path, m_file_path);
+    const auto statistics = getStatistics();
+    m_logger.debug("Saved pipeline cache {} ({} bytes), hit rate {:.2f} ({} hits, {} misses)",
+                   m_file_path.string(),
+                   data.size(),
+                   statistics.getHitRate(),
+                   statistics.hits,
+                   statistics.misses);
+}
+
+void VulkanPipelineCache::recordFeedback(const vk::PipelineCreationFeedback& feedback) noexcept {
+    if (!(feedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid)) {
+        return;
+    }
+    if (feedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit) {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+auto VulkanPipelineCache::loadInitialData(const vk::raii::PhysicalDevice& physical_device) const
+        -> std::vector<char> {
+    if (!std::filesystem::is_regular_file(m_file_path)) {
+        return {};
+    }
+    auto data = readFile<std::vector<char>>(m_file_path);
+    auto header = vk::PipelineCacheHeaderVersionOne{};
+    if (data.size() < sizeof(header)) {
+        m_logger.warn("Pipeline cache {} is truncated, discarding it", m_file_path.string());
+        return {};
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    const auto properties = physical_device.getProperties();
+    if (header.headerVersion != vk::PipelineCacheHeaderVersion::eOne || header.headerSize < sizeof(header)
+        || header.vendorID != properties.vendorID || header.deviceID != properties.deviceID
+        || header.pipelineCacheUUID != properties.pipelineCacheUUID) {
+        m_logger.info("Pipeline cache {} was created by another device or driver, discarding it",
+                      m_file_path.string());
+        return {};
+    }
+    return data;
+}
+
+auto GraphicsPipelineRegistry::getOrCreate(const VulkanGraphicsPipelineBuilder& builder,
+                                           const vk::PipelineLayout pipeline_layout) -> vk::Pipeline {
+    const auto key = builder.hash(pipeline_layout);
+    {
+        std::scoped_lock lock{ m_mutex };
+        if (const auto it = m_pipelines.find(key); it != m_pipelines.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return *it->second;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    auto feedback = vk::PipelineCreationFeedback{};
+    auto pipeline = builder.build(m_device, pipeline_layout, m_pipeline_cache.getCache(), feedback);
+    m_pipeline_cache.recordFeedback(feedback);
+
+    std::scoped_lock lock{ m_mutex };
+    return *m_pipelines.try_emplace(key, std::move(pipeline)).first->second;
+}
+
+auto GraphicsPipelineRegistry::getOrCreate(const vk::PipelineShaderStageCreateInfo& compute_stage,
+                                           const std::span<const uint32_t> spir_v,
+                                           const vk::PipelineLayout pipeline_layout) -> vk::Pipeline {
+    auto hasher = Fnv1aHasher{};
+    hasher.addValue(static_cast<VkPipelineLayout>(pipeline_layout))
+            .add(std::as_bytes(spir_v))
+            .addValue(compute_stage.stage)
+            .add(std::string_view{ compute_stage.pName });
+    if (const auto* specialization_info = compute_stage.pSpecializationInfo; specialization_info != nullptr) {
+        hasher.add(std::as_bytes(std::span{ specialization_info->pMapEntries, specialization_info->mapEntryCount }))
+                .add(std::span{ static_cast<const std::byte*>(specialization_info->pData),
+                                specialization_info->dataSize });
+    }
+    const auto key = hasher.getValue();
+    {
+        std::scoped_lock lock{ m_mutex };
+        if (const auto it = m_pipelines.find(key); it != m_pipelines.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return *it->second;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    auto feedback = vk::PipelineCreationFeedback{};
+    const auto feedback_create_info = vk::PipelineCreationFeedbackCreateInfo{ .pPipelineCreationFeedback = &feedback };
+    auto pipeline = m_device.createComputePipeline(m_pipeline_cache.getCache(),
+                                                   vk::ComputePipelineCreateInfo{
+                                                           .pNext = &feedback_create_info,
+                                                           .stage = compute_stage,
+                                                           .layout = pipeline_layout,
+                                                   });
+    m_pipeline_cache.recordFeedback(feedback);
+
+    std::scoped_lock lock{ m_mutex };
+    return *m_pipelines.try_emplace(key, std::move(pipeline)).first->second;
+}
+
+}// namespace th
@@ -0,0 +1,99 @@
+export module th.render_system.vulkan:pipeline_cache;
+
+import std;
+
+import vulkan;
+
+import th.core.logger;
+
+import :graphic_pipeline;
+
+namespace th {
+
+export struct PipelineCacheStatistics {
+    uint64_t hits{ 0 };
+    uint64_t misses{ 0 };
+
+    [[nodiscard]] auto getHitRate() const noexcept -> float {
+        const auto total = hits + misses;
+        return total == 0 ? 0.0f : static_cast<float>(hits) / static_cast<float>(total);
+    }
+};
+
+// Driver side pipeline cache persisted between runs. Data written by another driver, device or vendor is discarded
+// at load time, the driver would reject it anyway.
+export class VulkanPipelineCache {
+public:
+    VulkanPipelineCache(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                        std::filesystem::path file_path, Logger& logger);
+
+    VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+    VulkanPipelineCache(VulkanPipelineCache&&) = delete;
+    auto operator=(const VulkanPipelineCache&) -> VulkanPipelineCache& = delete;
+    auto operator=(VulkanPipelineCache&&) -> VulkanPipelineCache& = delete;
+    ~VulkanPipelineCache();
+
+    void save() const;
+
+    [[nodiscard]] auto getCache() const noexcept -> const vk::raii::PipelineCache& {
+        return m_pipeline_cache;
+    }
+
+    // Feeds creation feedback of a pipeline built with this cache into the hit statistics.
+    void recordFeedback(const vk::PipelineCreationFeedback& feedback) noexcept;
+
+    [[nodiscard]] auto getStatistics() const noexcept -> PipelineCacheStatistics {
+        return PipelineCacheStatistics{ .hits = m_hits.load(std::memory_order_relaxed),
+                                        .misses = m_misses.load(std::memory_order_relaxed) };
+    }
+
+private:
+    [[nodiscard]] auto loadInitialData(const vk::raii::PhysicalDevice& physical_device) const -> std::vector<char>;
+
+private:
+    std::filesystem::path m_file_path;
+    Logger& m_logger;
+    vk::raii::PipelineCache m_pipeline_cache{ nullptr };
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+};
+
+// Deduplicates graphics pipelines by the full builder state, so passes asking for an identical pipeline share one
+// vk::Pipeline. Compute pipelines share the registry. Keys include the raw layout handle, which the driver may hand
+// out again once the layout is destroyed, so every layout used here has to outlive the registry. The only one is that
+// of BindlessDescriptorHeap, declared ahead of the registry for that reason.
+export class GraphicsPipelineRegistry {
+public:
+    GraphicsPipelineRegistry(const vk::raii::Device& device, VulkanPipelineCache& pipeline_cache)
+        : m_device{ device }, m_pipeline_cache{ pipeline_cache } {}
+
+    [[nodiscard]] auto getOrCreate(const VulkanGraphicsPipelineBuilder& builder, vk::PipelineLayout pipeline_layout)
+            -> vk::Pipeline;
+
+    // Compute pipelines are keyed by the shader code, the stage's entry point and specialization, and the layout.
+    [[nodiscard]] auto getOrCreate(const vk::PipelineShaderStageCreateInfo& compute_stage,
+                                   std::span<const uint32_t> spir_v, vk::PipelineLayout pipeline_layout)
+            -> vk::Pipeline;
+
+    [[nodiscard]] auto getStatistics() const noexcept -> PipelineCacheStatistics {
+        return PipelineCacheStatistics{ .hits = m_hits.load(std::memory_order_relaxed),
+                                        .misses = m_misses.load(std::memory_order_relaxed) };
+    }
+
+    [[nodiscard]] auto getPipelineCache() const noexcept -> VulkanPipelineCache& {
+        return m_pipeline_cache;
+    }
+
+private:
+    const vk::raii::Device& m_device;
+    VulkanPipelineCache& m_pipeline_cache;
+
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, vk::raii::Pipeline> m_pipelines;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+};
+
+}// namespace th
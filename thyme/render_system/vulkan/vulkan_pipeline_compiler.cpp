@@ -0,0 +1,81 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+PipelineCompiler::PipelineCompiler(const vk::raii::Device& device, GraphicsPipelineRegistry& pipeline_registry,
+                                   JobSystem& job_system, Logger& logger)
+    : m_device{ device }, m_pipeline_registry{ pipeline_registry }, m_job_system{ job_system }, m_logger{ logger } {}
+
+PipelineCompiler::~PipelineCompiler() {
+    waitIdle();
+}
+
+auto PipelineCompiler::compileGraphicsPipeline(GraphicsPipelineRequest request) -> PipelineHandle {
+    return submit(Job{ .request = std::move(request), .state = std::make_shared<PipelineHandle::State>() });
+}
+
+auto PipelineCompiler::compileComputePipeline(ComputePipelineRequest request) -> PipelineHandle {
+    return submit(Job{ .request = std::move(request), .state = std::make_shared<PipelineHandle::State>() });
+}
+
+auto PipelineCompiler::submit(Job job) -> PipelineHandle {
+    auto state = job.state;
+    // std::function needs a copyable callable, the job is shared instead of moved in.
+    m_job_system.runBackground([this, job = std::make_shared<Job>(std::move(job))] { compile(*job); },
+                               &m_pending_jobs);
+    return PipelineHandle{ std::move(state) };
+}
+
+void PipelineCompiler::waitIdle() {
+    m_job_system.wait(m_pending_jobs);
+}
+
+void PipelineCompiler::compile(const Job& job) const {
+    const auto& [request, state] = job;
+    try {
+        state->pipeline = std::visit([this](const auto& typed_request) { return createPipeline(typed_request); },
+                                     request);
+        state->status.store(PipelineStatus::ready, std::memory_order_release);
+    } catch (const std::exception& e) {
+        const auto& shader_name =
+                std::visit([](const auto& typed_request) -> const std::string& { return typed_request.shader_name; },
+                           request);
+        m_logger.error("Cannot compile pipeline for shader {}, {}", shader_name, e.what());
+        state->status.store(PipelineStatus::failed, std::memory_order_release);
+    }
+    state->status.notify_all();
+}
+
+auto PipelineCompiler::createPipeline(const GraphicsPipelineRequest& request) const -> vk::Pipeline {
+    const auto spir_v = compileSlangShader(request.shader_name, request.defines);
+    // The module is only needed until the pipeline is created.
+    const auto shader_module = createShaderModule(m_device, std::span{ spir_v }, m_logger);
+    const auto shader_stages = request.stages | std::views::transform([&shader_module](const auto& stage) {
+                                   return vk::PipelineShaderStageCreateInfo{
+                                       .stage = stage.stage,
+                                       .module = shader_module,
+                                       .pName = stage.entry_point.c_str(),
+                                       .pSpecializationInfo = stage.specialization_constants.getInfo(),
+                                   };
+                               })
+                               | std::ranges::to<std::vector>();
+    auto builder = request.builder;
+    builder.setShaders(shader_stages).setShaderCode(spir_v);
+    return m_pipeline_registry.getOrCreate(builder, request.pipeline_layout);
+}
+
+auto PipelineCompiler::createPipeline(const ComputePipelineRequest& request) const -> vk::Pipeline {
+    const auto spir_v = compileSlangShader(request.shader_name, request.defines);
+    const auto shader_module = createShaderModule(m_device, std::span{ spir_v }, m_logger);
+    const auto compute_stage = vk::PipelineShaderStageCreateInfo{
+        .stage = vk::ShaderStageFlagBits::eCompute,
+        .module = shader_module,
+        .pName = request.stage.entry_point.c_str(),
+        .pSpecializationInfo = request.stage.specialization_constants.getInfo(),
+    };
+    return m_pipeline_registry.getOrCreate(compute_stage, spir_v, request.pipeline_layout);
+}
+
+}// namespace th
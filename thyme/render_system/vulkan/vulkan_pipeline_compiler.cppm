@@ -0,0 +1,120 @@
+export module th.render_system.vulkan:pipeline_compiler;
+
+import std;
+
+import vulkan;
+
+import th.core.job_system;
+import th.core.logger;
+
+import :graphic_pipeline;
+import :pipeline_cache;
+import :shader;
+
+namespace th {
+
+export enum struct PipelineStatus {
+    pending,
+    ready,
+    failed
+};
+
+// Readiness handle of a pipeline compiled in the background. Copies share the same state.
+export class PipelineHandle {
+    struct State {
+        std::atomic<PipelineStatus> status{ PipelineStatus::pending };
+        vk::Pipeline pipeline{ nullptr };
+    };
+
+public:
+    PipelineHandle() = default;
+
+    [[nodiscard]] auto getStatus() const noexcept -> PipelineStatus {
+        return m_state ? m_state->status.load(std::memory_order_acquire) : PipelineStatus::failed;
+    }
+
+    [[nodiscard]] auto isReady() const noexcept -> bool {
+        return getStatus() == PipelineStatus::ready;
+    }
+
+    // Null until the pipeline is ready.
+    [[nodiscard]] auto getPipeline() const noexcept -> vk::Pipeline {
+        return isReady() ? m_state->pipeline : nullptr;
+    }
+
+    void wait() const noexcept {
+        if (m_state) {
+            m_state->status.wait(PipelineStatus::pending, std::memory_order_acquire);
+        }
+    }
+
+private:
+    explicit PipelineHandle(std::shared_ptr<State> state) : m_state{ std::move(state) } {}
+
+    std::shared_ptr<State> m_state;
+
+    friend class PipelineCompiler;
+};
+
+export struct ShaderStageRequest {
+    vk::ShaderStageFlagBits stage;
+    std::string entry_point{ "main" };
+    SpecializationConstants specialization_constants{};
+};
+
+export struct GraphicsPipelineRequest {
+    std::string shader_name;
+    std::vector<ShaderDefine> defines{};
+    std::vector<ShaderStageRequest> stages;
+    // Fully configured except for the shader stages, which are filled in once the shader is compiled.
+    VulkanGraphicsPipelineBuilder builder;
+    vk::PipelineLayout pipeline_layout;
+};
+
+export struct ComputePipelineRequest {
+    std::string shader_name;
+    std::vector<ShaderDefine> defines{};
+    ShaderStageRequest stage{ .stage = vk::ShaderStageFlagBits::eCompute };
+    vk::PipelineLayout pipeline_layout;
+};
+
+// Compiles shaders and creates pipelines as background jobs, so startup cost spreads across the job system workers
+// instead of adding up on the main thread.
+export class PipelineCompiler {
+public:
+    PipelineCompiler(const vk::raii::Device& device, GraphicsPipelineRegistry& pipeline_registry,
+                     JobSystem& job_system, Logger& logger);
+
+    PipelineCompiler(const PipelineCompiler&) = delete;
+    PipelineCompiler(PipelineCompiler&&) = delete;
+    auto operator=(const PipelineCompiler&) -> PipelineCompiler& = delete;
+    auto operator=(PipelineCompiler&&) -> PipelineCompiler& = delete;
+    ~PipelineCompiler();
+
+    [[nodiscard]] auto compileGraphicsPipeline(GraphicsPipelineRequest request) -> PipelineHandle;
+    [[nodiscard]] auto compileComputePipeline(ComputePipelineRequest request) -> PipelineHandle;
+
+    // Blocks until every submitted request is finished.
+    void waitIdle();
+
+private:
+    struct Job {
+        std::variant<GraphicsPipelineRequest, ComputePipelineRequest> request;
+        std::shared_ptr<PipelineHandle::State> state;
+    };
+
+    [[nodiscard]] auto submit(Job job) -> PipelineHandle;
+    void compile(const Job& job) const;
+    [[nodiscard]] auto createPipeline(const GraphicsPipelineRequest& request) const -> vk::Pipeline;
+    [[nodiscard]] auto createPipeline(const ComputePipelineRequest& request) const -> vk::Pipeline;
+
+private:
+    const vk::raii::Device& m_device;
+    GraphicsPipelineRegistry& m_pipeline_registry;
+    JobSystem& m_job_system;
+    Logger& m_logger;
+
+    JobCounter m_pending_jobs;
+};
+
+}// namespace th
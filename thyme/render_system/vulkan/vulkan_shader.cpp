@@ -4,7 +4,25 @@ module th.render_system.vulkan;
 
 namespace th {
 
+constexpr auto g_shader_cache_version = uint32_t{ 1 };
+constexpr auto g_slang_profile = std::string_view{ "spirv_1_5" };
+
 auto ShaderCompiler::compile() const -> std::vector<uint32_t> {
+    const auto glslang_version = glslang::GetVersion();
+    const auto key = Fnv1aHasher{}
+                             .add("glsl")
+                             .addValue(g_shader_cache_version)
+                             .addValue(glslang_version.major)
+                             .addValue(glslang_version.minor)
+                             .addValue(glslang_version.patch)
+                             .addValue(m_type)
+                             .addValue(glslang::EShTargetLanguageVersion::EShTargetSpv_1_4)
+                             .add(m_data)
+                             .getValue();
+    return ShaderCache::getInstance().getOrCompile(key, [this] { return compileUncached(); });
+}
+
+auto ShaderCompiler::compileUncached() const -> std::vector<uint32_t> {
     auto shader = glslang::TShader(m_type);
     const char* d = m_data.c_str();
     shader.setStrings(&d, 1);
@@ -35,54 +53,135 @@ auto ShaderCompiler::compile() const -> std::vector<uint32_t> {
     return spir_v;
 }
 
-void SlangShaderCompiler::compile(const std::string_view target, Logger& logger) {
-    Slang::ComPtr<slang::IGlobalSession> global_session;
-    slang::createGlobalSession(global_session.writeRef());
+// Creating the global session loads the core module and dominates small compiles, so it is reused. Global sessions are
+// not thread safe, each compiling thread keeps its own, created on its first cache miss.
+[[nodiscard]] static auto getSlangGlobalSession() -> slang::IGlobalSession& {
+    thread_local const auto global_session = [] {
+        Slang::ComPtr<slang::IGlobalSession> session;
+        slang::createGlobalSession(session.writeRef());
+        return session;
+    }();
+    return *global_session;
+}
 
-    const auto target_desc = std::array{ slang::TargetDesc{ .format = slang_spirv,
-                                                            .profile = global_session->findProfile("spirv_1_5") } };
+[[nodiscard]] static auto findSlangDependency(const std::filesystem::path& base_path,
+                                              const std::filesystem::path& including_directory,
+                                              std::string name) -> std::optional<std::filesystem::path> {
+    std::erase(name, '"');
+    auto candidates = std::vector<std::filesystem::path>{};
+    if (name.ends_with(".slang")) {
+        candidates.emplace_back(name);
+    } else {
+        std::ranges::replace(name, '.', '/');
+        candidates.emplace_back(std::format("{}.slang", name));
+        std::ranges::replace(name, '_', '-');
+        candidates.emplace_back(std::format("{}.slang", name));
+    }
+    for (const auto& directory : { including_directory, base_path }) {
+        for (const auto& candidate : candidates) {
+            if (const auto path = directory / candidate; std::filesystem::is_regular_file(path)) {
+                return path;
+            }
+        }
+    }
+    return std::nullopt;
+}
 
-    auto options =
-            std::array{ slang::CompilerOptionEntry{ slang::CompilerOptionName::EmitSpirvDirectly,
-                                                    { slang::CompilerOptionValueKind::Int, 1, 0, nullptr, nullptr } } };
+struct SlangSourceInfo {
+    std::filesystem::file_time_type last_write_time;
+    uint64_t content_hash;
+    std::vector<std::filesystem::path> dependencies;
+};
+
+// Every lookup hashes the whole import graph, so the content hash and the resolved imports of each file are kept
+// until its timestamp changes instead of reading and scanning the file again.
+[[nodiscard]] static auto getSlangSourceInfo(const std::filesystem::path& base_path,
+                                             const std::filesystem::path& file_path) -> SlangSourceInfo {
+    static auto mutex = std::mutex{};
+    static auto sources = std::unordered_map<std::string, SlangSourceInfo>{};
+
+    auto error_code = std::error_code{};
+    const auto last_write_time = std::filesystem::last_write_time(file_path, error_code);
+    const auto key = file_path.generic_string();
+    if (!error_code) {
+        std::scoped_lock lock{ mutex };
+        if (const auto it = sources.find(key); it != sources.end() && it->second.last_write_time == last_write_time) {
+            return it->second;
+        }
+    }
 
-    const auto session_desc = slang::SessionDesc{ .targets = target_desc.data(),
-                                                  .targetCount = static_cast<SlangInt>(target_desc.size()),
-                                                  .defaultMatrixLayoutMode = slang_matrix_layout_column_major,
-                                                  .compilerOptionEntries = options.data(),
-                                                  .compilerOptionEntryCount = static_cast<uint32_t>(options.size()) };
+    const auto source = readFile<std::string>(file_path);
+    auto info = SlangSourceInfo{ .last_write_time = last_write_time,
+                                 .content_hash = Fnv1aHasher{}.add(source).getValue(),
+                                 .dependencies = {} };
+    static const auto dependency_regex =
+            std::regex{ R"(^\s*(?:import|__include|implementing)\s+([\w\.\-/"]+)\s*;|^\s*#include\s+("[^"]+"))" };
+    auto source_stream = std::istringstream{ source };
+    for (std::string line; std::getline(source_stream, line);) {
+        std::smatch match;
+        if (!std::regex_search(line, match, dependency_regex)) {
+            continue;
+        }
+        const auto name = match[1].matched ? match[1].str() : match[2].str();
+        if (auto dependency = findSlangDependency(base_path, file_path.parent_path(), name)) {
+            info.dependencies.push_back(std::move(*dependency));
+        }
+    }
+    if (!error_code) {
+        std::scoped_lock lock{ mutex };
+        sources.insert_or_assign(key, info);
+    }
+    return info;
+}
 
-    Slang::ComPtr<slang::ISession> session;
-    global_session->createSession(session_desc, session.writeRef());
-    const auto module_path = getBasePath(ShaderLanguage::slang) / target;
-    const auto module_path_str = std::format("{}.slang", module_path.string());
-    Slang::ComPtr<slang::IBlob> out_diagnostics;
-    const auto slang_module = Slang::ComPtr{ session->loadModuleFromSource(
-            target.data(), module_path_str.c_str(), nullptr, out_diagnostics.writeRef()) };
-    if (out_diagnostics->getBufferPointer()) {
-        logger.warn("Could not compile {}. Error: {}", target, out_diagnostics->getBufferPointer());
+// Hashes the module source and, recursively, every import/include that resolves to a file next to it. Imports of
+// built-in modules do not resolve and are covered by the compiler version instead.
+static void hashSlangSources(Fnv1aHasher& hasher, const std::filesystem::path& base_path,
+                             const std::filesystem::path& file_path, std::set<std::filesystem::path>& visited) {
+    if (!visited.insert(file_path.lexically_normal()).second) {
+        return;
+    }
+    const auto info = getSlangSourceInfo(base_path, file_path);
+    hasher.add(file_path.lexically_relative(base_path).generic_string()).addValue(info.content_hash);
+    for (const auto& dependency : info.dependencies) {
+        hashSlangSources(hasher, base_path, dependency, visited);
     }
-    slang_module->getTargetCode(0, m_spir_vv_code.writeRef());
 }
-auto compileSlangShader(const std::string_view shader_name) -> std::vector<uint32_t> {
-    Slang::ComPtr<slang::IGlobalSession> global_session;
-    slang::createGlobalSession(global_session.writeRef());
+
+[[nodiscard]] static auto compileSlangModule(const std::string_view shader_name,
+                                             const std::span<const ShaderDefine> defines) -> std::vector<uint32_t> {
+    auto& global_session = getSlangGlobalSession();
 
     const auto target_desc = std::array{ slang::TargetDesc{ .format = slang_spirv,
-                                                            .profile = global_session->findProfile("spirv_1_5") } };
+                                                            .profile = global_session.findProfile(
+                                                                    g_slang_profile.data()) } };
 
     auto options =
             std::array{ slang::CompilerOptionEntry{ slang::CompilerOptionName::EmitSpirvDirectly,
                                                     { slang::CompilerOptionValueKind::Int, 1, 0, nullptr, nullptr } } };
 
+    const auto macros = defines | std::views::transform([](const ShaderDefine& define) {
+                            return slang::PreprocessorMacroDesc{ .name = define.name.c_str(),
+                                                                 .value = define.value.c_str() };
+                        })
+                        | std::ranges::to<std::vector>();
+
+    // Lets shaders import shared modules such as bindless.slang.
+    const auto search_path = getBasePath(ShaderLanguage::slang).string();
+    const auto search_paths = std::array{ search_path.c_str() };
+
     const auto session_desc = slang::SessionDesc{ .targets = target_desc.data(),
                                                   .targetCount = static_cast<SlangInt>(target_desc.size()),
                                                   .defaultMatrixLayoutMode = slang_matrix_layout_column_major,
+                                                  .searchPaths = search_paths.data(),
+                                                  .searchPathCount = static_cast<SlangInt>(search_paths.size()),
+                                                  .preprocessorMacros = macros.data(),
+                                                  .preprocessorMacroCount = static_cast<SlangInt>(macros.size()),
                                                   .compilerOptionEntries = options.data(),
                                                   .compilerOptionEntryCount = static_cast<uint32_t>(options.size()) };
 
     Slang::ComPtr<slang::ISession> session;
-    global_session->createSession(session_desc, session.writeRef());
+    global_session.createSession(session_desc, session.writeRef());
     const auto module_path = getBasePath(ShaderLanguage::slang) / shader_name;
     const auto module_path_str = std::format("{}.slang", module_path.string());
     Slang::ComPtr<slang::IBlob> out_diagnostics;
@@ -100,4 +199,41 @@ auto compileSlangShader(const std::string_view shader_name) -> std::vector<uint3
     return std::vector(spriv_code_begin_ptr, spriv_code_begin_ptr + (spirv_code->getBufferSize() / 4));
 }
 
-}// namespace th
\ No newline at end of file
+void SlangShaderCompiler::compile(const std::string_view target, Logger& logger) {
+    try {
+        m_spir_v = compileSlangShader(target);
+    } catch (const std::exception& e) {
+        logger.warn("Could not compile {}. Error: {}", target, e.what());
+    }
+}
+
+auto compileSlangShader(const std::string_view shader_name) -> std::vector<uint32_t> {
+    return compileSlangShader(shader_name, {});
+}
+
+auto compileSlangShader(const std::string_view shader_name, const std::span<const ShaderDefine> defines)
+        -> std::vector<uint32_t> {
+    // Defines are hashed in name order, so the same combination requested in any order maps to one variant.
+    auto sorted_defines = std::vector(defines.begin(), defines.end());
+    std::ranges::sort(sorted_defines, {}, &ShaderDefine::name);
+
+    const auto base_path = getBasePath(ShaderLanguage::slang);
+    auto hasher = Fnv1aHasher{};
+    hasher.add("slang")
+            .addValue(g_shader_cache_version)
+            .add(spGetBuildTagString())
+            .add(g_slang_profile)
+            .addValue(slang::CompilerOptionName::EmitSpirvDirectly)
+            .addValue(slang_matrix_layout_column_major)
+            .add(shader_name);
+    for (const auto& define : sorted_defines) {
+        hasher.add(define.name).add(define.value);
+    }
+    auto visited = std::set<std::filesystem::path>{};
+    hashSlangSources(hasher, base_path, base_path / std::format("{}.slang", shader_name), visited);
+    return ShaderCache::getInstance().getOrCompile(hasher.getValue(), [shader_name, &sorted_defines] {
+        return compileSlangModule(shader_name, sorted_defines);
+    });
+}
+
+}// namespace th
@@ -9,6 +9,8 @@ import vulkan;
 import th.core.logger;
 import th.core.utils;
 
+import :shader_cache;
+
 class GlslangContext {
 public:
     GlslangContext() {
@@ -115,6 +117,8 @@ public:
     [[nodiscard]] auto compile() const -> std::vector<uint32_t>;
 
 private:
+    [[nodiscard]] auto compileUncached() const -> std::vector<uint32_t>;
+
     static void initializeContext() {
         [[maybe_unused]] static GlslangContext glslang;
     }
@@ -129,10 +133,97 @@ public:
     void compile(std::string_view target, Logger& logger);
 
 //private:
-    Slang::ComPtr<slang::IBlob> m_spir_vv_code;
+    std::vector<uint32_t> m_spir_v;
+};
+
+export struct ShaderDefine {
+    std::string name;
+    std::string value{ "1" };
+};
+
+// Feature keys a shader can be specialised on. Every enabled key is compiled in as `#define KEY 1`, so variants pay
+// no runtime branching and each requested combination becomes its own cached SPIR-V.
+export class ShaderFeatureSet {
+public:
+    static constexpr auto max_features = 64u;
+
+    explicit ShaderFeatureSet(std::vector<std::string> feature_keys) : m_feature_keys{ std::move(feature_keys) } {
+        if (m_feature_keys.size() > max_features) {
+            throw std::invalid_argument(std::format("At most {} shader features are supported", max_features));
+        }
+    }
+
+    // Bit mask of the enabled features, usable as a compact variant key.
+    [[nodiscard]] auto getVariant(std::span<const std::string_view> enabled_features) const -> uint64_t {
+        auto variant = uint64_t{ 0 };
+        for (const auto feature : enabled_features) {
+            const auto it = std::ranges::find(m_feature_keys, feature);
+            if (it == m_feature_keys.end()) {
+                throw std::invalid_argument(std::format("Unknown shader feature {}", feature));
+            }
+            variant |= uint64_t{ 1 } << std::distance(m_feature_keys.begin(), it);
+        }
+        return variant;
+    }
+
+    [[nodiscard]] auto getDefines(const uint64_t variant) const -> std::vector<ShaderDefine> {
+        auto defines = std::vector<ShaderDefine>{};
+        for (const auto [index, feature] : std::views::enumerate(m_feature_keys)) {
+            if (variant & (uint64_t{ 1 } << index)) {
+                defines.push_back(ShaderDefine{ .name = feature });
+            }
+        }
+        return defines;
+    }
+
+private:
+    std::vector<std::string> m_feature_keys;
+};
+
+// Vulkan specialization constants for variants that should share one SPIR-V module. The returned info points into
+// this object, which has to outlive pipeline creation.
+export class SpecializationConstants {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto set(const uint32_t constant_id, const T& value) -> SpecializationConstants& {
+        m_map_entries.push_back(vk::SpecializationMapEntry{
+                .constantID = constant_id,
+                .offset = static_cast<uint32_t>(m_data.size()),
+                .size = sizeof(T),
+        });
+        const auto bytes = std::as_bytes(std::span{ &value, 1 });
+        m_data.insert(m_data.end(), bytes.begin(), bytes.end());
+        return *this;
+    }
+
+    [[nodiscard]] auto isEmpty() const noexcept -> bool {
+        return m_map_entries.empty();
+    }
+
+    [[nodiscard]] auto getInfo() const noexcept -> const vk::SpecializationInfo* {
+        if (isEmpty()) {
+            return nullptr;
+        }
+        // Refreshed on every call, copies of this object must not point into the storage of the original.
+        m_info = vk::SpecializationInfo{
+            .mapEntryCount = static_cast<uint32_t>(m_map_entries.size()),
+            .pMapEntries = m_map_entries.data(),
+            .dataSize = m_data.size(),
+            .pData = m_data.data(),
+        };
+        return &m_info;
+    }
+
+private:
+    std::vector<vk::SpecializationMapEntry> m_map_entries;
+    std::vector<std::byte> m_data;
+    mutable vk::SpecializationInfo m_info;
 };
 
 export [[nodiscard]] auto compileSlangShader(std::string_view shader_name) -> std::vector<uint32_t>;
+export [[nodiscard]] auto compileSlangShader(std::string_view shader_name, std::span<const ShaderDefine> defines)
+        -> std::vector<uint32_t>;
 
 export auto createShaderModule(const vk::raii::Device& device, const std::span<const uint32_t> spir_v,
                                const Logger& logger) -> vk::raii::ShaderModule {
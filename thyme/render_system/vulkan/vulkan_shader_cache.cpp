@@ -0,0 +1,81 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+constexpr auto g_spir_v_magic_number = uint32_t{ 0x07230203 };
+
+auto ShaderCache::getInstance() -> ShaderCache& {
+    static ShaderCache shader_cache{ std::filesystem::current_path() / "shader_cache" };
+    return shader_cache;
+}
+
+auto ShaderCache::getOrCompile(const uint64_t key, const std::function<std::vector<uint32_t>()>& compile)
+        -> std::vector<uint32_t> {
+    {
+        std::scoped_lock lock{ m_mutex };
+        if (const auto it = m_spir_v.find(key); it != m_spir_v.end()) {
+            m_memory_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    // Compilation runs outside the lock, two threads missing on the same key both compile and store equal results.
+    auto spir_v = [&] {
+        if (auto cached = load(key)) {
+            m_disk_hits.fetch_add(1, std::memory_order_relaxed);
+            return std::move(*cached);
+        }
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        auto compiled = compile();
+        store(key, compiled);
+        return compiled;
+    }();
+    std::scoped_lock lock{ m_mutex };
+    return m_spir_v.try_emplace(key, std::move(spir_v)).first->second;
+}
+
+auto ShaderCache::getFilePath(const uint64_t key) const -> std::filesystem::path {
+    return m_directory / std::format("{:016x}.spv", key);
+}
+
+auto ShaderCache::load(const uint64_t key) const -> std::optional<std::vector<uint32_t>> {
+    const auto file_path = getFilePath(key);
+    auto error_code = std::error_code{};
+    const auto file_size = std::filesystem::file_size(file_path, error_code);
+    if (error_code || file_size == 0 || file_size % sizeof(uint32_t) != 0) {
+        return std::nullopt;
+    }
+    std::ifstream file(file_path, std::ios::binary);
+    auto spir_v = std::vector<uint32_t>(file_size / sizeof(uint32_t));
+    if (!file.read(reinterpret_cast<char*>(spir_v.data()), static_cast<std::streamsize>(file_size))
+        || spir_v.front() != g_spir_v_magic_number) {
+        return std::nullopt;
+    }
+    return spir_v;
+}
+
+void ShaderCache::store(const uint64_t key, const std::span<const uint32_t> spir_v) const {
+    // The disk cache is best effort, a failed write only costs a recompile on the next start.
+    auto error_code = std::error_code{};
+    std::filesystem::create_directories(m_directory, error_code);
+    if (error_code) {
+        return;
+    }
+    const auto file_path = getFilePath(key);
+    auto temporary_path = file_path;
+    temporary_path += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(spir_v.data()), static_cast<std::streamsize>(spir_v.size_bytes()));
+        if (!file) {
+            return;
+        }
+    }
+    std::filesystem::rename(temporary_path, file_path, error_code);
+    if (error_code) {
+        std::filesystem::remove(temporary_path, error_code);
+    }
+}
+
+}// namespace th
@@ -0,0 +1,51 @@
+export module th.render_system.vulkan:shader_cache;
+
+import std;
+
+namespace th {
+
+export struct ShaderCacheStatistics {
+    uint64_t memory_hits{ 0 };
+    uint64_t disk_hits{ 0 };
+    uint64_t misses{ 0 };
+
+    [[nodiscard]] auto getHitRate() const noexcept -> float {
+        const auto total = memory_hits + disk_hits + misses;
+        return total == 0 ? 0.0f : static_cast<float>(memory_hits + disk_hits) / static_cast<float>(total);
+    }
+};
+
+// Two level SPIR-V cache. Keys are content hashes of everything that affects the compiler output, so on-disk entries
+// never need invalidation: an edited shader simply maps to a new file.
+export class ShaderCache {
+public:
+    explicit ShaderCache(std::filesystem::path directory) : m_directory{ std::move(directory) } {}
+
+    [[nodiscard]] static auto getInstance() -> ShaderCache&;
+
+    [[nodiscard]] auto getOrCompile(uint64_t key, const std::function<std::vector<uint32_t>()>& compile)
+            -> std::vector<uint32_t>;
+
+    [[nodiscard]] auto getStatistics() const noexcept -> ShaderCacheStatistics {
+        return ShaderCacheStatistics{ .memory_hits = m_memory_hits.load(std::memory_order_relaxed),
+                                      .disk_hits = m_disk_hits.load(std::memory_order_relaxed),
+                                      .misses = m_misses.load(std::memory_order_relaxed) };
+    }
+
+private:
+    [[nodiscard]] auto getFilePath(uint64_t key) const -> std::filesystem::path;
+    [[nodiscard]] auto load(uint64_t key) const -> std::optional<std::vector<uint32_t>>;
+    void store(uint64_t key, std::span<const uint32_t> spir_v) const;
+
+private:
+    std::filesystem::path m_directory;
+
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_spir_v;
+
+    std::atomic<uint64_t> m_memory_hits{ 0 };
+    std::atomic<uint64_t> m_disk_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+};
+
+}// namespace th
@@ -59,16 +59,19 @@ auto createSwapChain(const vk::raii::PhysicalDevice& physical_device, const vk::
 
 VulkanSwapchain2::VulkanSwapchain2(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
                                    const uint32_t queue_family_index, const vk::SurfaceKHR surface,
-                                   std::function<vk::Extent2D()> get_frame_buffer_size, Logger& logger)
+                                   std::function<vk::Extent2D()> get_frame_buffer_size,
+                                   std::vector<vk::PresentModeKHR> preferred_present_modes,
+                                   DeferredDeletionQueue& deletion_queue, Logger& logger)
     : m_surface(surface), m_get_frame_buffer_size(std::move(get_frame_buffer_size)),
-      m_swapchain_details(physical_device, surface), m_swapchain_frame_extent(getExtent()),
-      m_presentation_queue(device.getQueue(queue_family_index, 0)), m_logger(logger) {
+      m_swapchain_details(physical_device, surface), m_preferred_present_modes(std::move(preferred_present_modes)),
+      m_swapchain_frame_extent(getExtent()),
+      m_presentation_queue(device.getQueue(queue_family_index, 0)), m_deletion_queue(deletion_queue),
+      m_logger(logger) {
     createSwapchain(physical_device, device);
 }
 
 auto VulkanSwapchain2::recreateSwapchain(const vk::raii::PhysicalDevice& physical_device,
                                          const vk::raii::Device& device) -> SwapChainCreationState {
-    device.waitIdle();// how to avoid this??
     m_swapchain_details = SwapChainSupportDetails(physical_device, m_surface);
     if (!m_swapchain_details.isValid()) {
         return SwapChainCreationState::invalid_swapchain;
@@ -83,16 +86,34 @@ auto VulkanSwapchain2::recreateSwapchain(const vk::raii::PhysicalDevice& physica
 
     return SwapChainCreationState::success;
 }
+void VulkanSwapchain2::setPreferredPresentModes(std::vector<vk::PresentModeKHR> preferred_present_modes) {
+    m_preferred_present_modes = std::move(preferred_present_modes);
+    m_should_recreate_swapchain = true;
+}
+
 void VulkanSwapchain2::transitImageLayout(const vk::CommandBuffer command_buffer, const ImageTransition& transition) {
     m_swapchain_frames.transitImageLayout(m_current_image_index, command_buffer, transition);
 }
 
 void VulkanSwapchain2::createSwapchain(const vk::raii::PhysicalDevice& physical_device,
                                        const vk::raii::Device& device) {
-    const auto best_formats = m_swapchain_details.getBestSwapChainSettings();
+    const auto best_formats = m_swapchain_details.getBestSwapChainSettings(m_preferred_present_modes);
     m_swapchain_format = best_formats.surfaceFormat.format;
-    m_swapchain =
+    if (best_formats.presetMode != m_present_mode || !*m_swapchain) {
+        m_logger.info("Swapchain present mode {}", vk::to_string(best_formats.presetMode));
+    }
+    m_present_mode = best_formats.presetMode;
+    auto swapchain =
             createSwapChain(physical_device, device, m_surface, best_formats, m_swapchain_frame_extent, m_swapchain);
+    // Frames still in flight may render to or present the old images, and wait on the old semaphores, so they are
+    // retired together with the old swapchain rather than destroyed right away.
+    if (*m_swapchain) {
+        m_deletion_queue.retire(std::move(m_swapchain));
+        m_deletion_queue.retire(std::move(m_swapchain_frames));
+        m_deletion_queue.retire(std::move(m_image_available_semaphores));
+        m_deletion_queue.retire(std::move(m_image_render_semaphores));
+    }
+    m_swapchain = std::move(swapchain);
     m_swapchain_frames = SwapchainFrames(device, m_swapchain, best_formats.surfaceFormat.format);
     m_image_available_semaphores.clear();
     m_image_render_semaphores.clear();
@@ -10,6 +10,7 @@ import :device;
 import :graphic_context;
 import :utils;
 import :command_buffers;
+import :deletion_queue;
 import :texture;
 
 namespace th {
@@ -70,7 +71,9 @@ export class VulkanSwapchain2: public RenderTarget {
 public:
     VulkanSwapchain2(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
                      uint32_t queue_family_index, vk::SurfaceKHR surface,
-                     std::function<vk::Extent2D()> get_frame_buffer_size, Logger& logger);
+                     std::function<vk::Extent2D()> get_frame_buffer_size,
+                     std::vector<vk::PresentModeKHR> preferred_present_modes, DeferredDeletionQueue& deletion_queue,
+                     Logger& logger);
 
     auto prepareFrame(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device)
             -> std::optional<SwapChainFrameSemaphores>;
@@ -81,10 +84,17 @@ public:
 
     void transitImageLayout(vk::CommandBuffer command_buffer, const ImageTransition& transition);
 
+    // Takes effect when the swapchain is recreated before the next frame.
+    void setPreferredPresentModes(std::vector<vk::PresentModeKHR> preferred_present_modes);
+
     [[nodiscard]] auto getFormat() const -> vk::Format {
         return m_swapchain_format;
     }
 
+    [[nodiscard]] auto getPresentMode() const noexcept -> vk::PresentModeKHR {
+        return m_present_mode;
+    }
+
     [[nodiscard]] auto getImage() const noexcept -> vk::Image override;
     [[nodiscard]] auto getImageView() const noexcept -> vk::ImageView override;
     [[nodiscard]] auto getResolution() const noexcept -> vk::Extent2D override;
@@ -99,7 +109,9 @@ private:
     vk::SurfaceKHR m_surface;
     std::function<vk::Extent2D()> m_get_frame_buffer_size;
     SwapChainSupportDetails m_swapchain_details;
+    std::vector<vk::PresentModeKHR> m_preferred_present_modes;
     vk::Format m_swapchain_format;
+    vk::PresentModeKHR m_present_mode{ vk::PresentModeKHR::eFifo };
     vk::Extent2D m_swapchain_frame_extent{};
     vk::raii::Queue m_presentation_queue;
     vk::raii::SwapchainKHR m_swapchain{ nullptr };
@@ -110,6 +122,7 @@ private:
 
     bool m_should_recreate_swapchain{ false };
 
+    DeferredDeletionQueue& m_deletion_queue;
     Logger& m_logger;
 };
 
@@ -88,9 +88,10 @@ VulkanImageMemoryCreator::VulkanImageMemoryCreator(const vk::Format format, cons
     : m_format{ format }, m_image_usage_flags{ image_usage_flags }, m_memory_property_flags{ memory_property_flags },
       m_aspect_flags{ aspect_flags }, m_msaa{ msaa }, m_mip_levels{ mip_levels } {}
 
-auto VulkanImageMemoryCreator::create(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
-                                      const vk::Extent3D resolution) const -> ImageMemoryImageView {
-    const auto createInfo = vk::ImageCreateInfo{
+auto VulkanImageMemoryCreator::create(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                                      const vk::raii::Device& device, const vk::Extent3D resolution,
+                                      const std::string_view name) const -> ImageMemoryImageView {
+    const auto create_info = vk::ImageCreateInfo{
         .imageType = vk::ImageType::e2D,
         .format = m_format,
         .extent = resolution,
@@ -101,15 +102,29 @@ auto VulkanImageMemoryCreator::create(const vk::raii::PhysicalDevice& physical_d
         .usage = m_image_usage_flags,
         .sharingMode = vk::SharingMode::eExclusive,
     };
-    auto image = device.createImage(createInfo);
-    const vk::MemoryRequirements memory_requirements = image.getMemoryRequirements();
-    auto memory = device.allocateMemory(vk::MemoryAllocateInfo{
-            .allocationSize = memory_requirements.size,
-            .memoryTypeIndex =
-                    findMemoryType(physical_device, memory_requirements.memoryTypeBits, m_memory_property_flags) });
-    image.bindMemory(memory, 0);
+    constexpr auto render_target_usage = vk::ImageUsageFlagBits::eColorAttachment
+                                         | vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                         | vk::ImageUsageFlagBits::eStorage;
+    const auto memory_requirements =
+            device.getImageMemoryRequirements(vk::DeviceImageMemoryRequirements{ .pCreateInfo = &create_info });
+    const auto is_render_target = static_cast<bool>(m_image_usage_flags & render_target_usage);
+    const auto dedicated =
+            is_render_target || memory_requirements.memoryRequirements.size >= g_dedicated_image_allocation_threshold;
+    const auto is_transient = static_cast<bool>(m_image_usage_flags & vk::ImageUsageFlagBits::eTransientAttachment);
+    auto image = allocator.createImage(
+            create_info,
+            vma::AllocationCreateInfo{
+                    .flags = dedicated ? vma::AllocationCreateFlagBits::eDedicatedMemory : vma::AllocationCreateFlags{},
+                    .usage = vma::MemoryUsage::eAutoPreferDevice,
+                    .requiredFlags = m_memory_property_flags,
+                    .preferredFlags = is_transient ? vk::MemoryPropertyFlagBits::eLazilyAllocated
+                                                   : vk::MemoryPropertyFlags{},
+            });
+    const auto category = is_render_target ? GpuMemoryCategory::render_target : GpuMemoryCategory::texture;
+    auto memory_tag = memory_tracker.track(*image.getAllocation(), category, name);
+    const vk::raii::Image& vk_image = image;
     auto image_view = device.createImageView(
-            vk::ImageViewCreateInfo{ .image = image,
+            vk::ImageViewCreateInfo{ .image = *vk_image,
                                      .viewType = vk::ImageViewType::e2D,
                                      .format = m_format,
                                      .subresourceRange = vk::ImageSubresourceRange{ .aspectMask = m_aspect_flags,
@@ -117,9 +132,39 @@ auto VulkanImageMemoryCreator::create(const vk::raii::PhysicalDevice& physical_d
                                                                                     .levelCount = m_mip_levels,
                                                                                     .baseArrayLayer = 0,
                                                                                     .layerCount = 1 } });
-    return ImageMemoryImageView{ .image = std::move(image),
-                                 .memory = std::move(memory),
-                                 .image_view = std::move(image_view) };
+    return ImageMemoryImageView{
+        .image = std::move(image), .image_view = std::move(image_view), .memory_tag = std::move(memory_tag)
+    };
+}
+
+VulkanImageTarget::VulkanImageTarget(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                                     const vk::raii::Device& device, DeferredDeletionQueue& deletion_queue,
+                                     VulkanImageMemoryCreator memory_creator, std::string name)
+    : m_allocator{ allocator }, m_memory_tracker{ memory_tracker }, m_device{ device },
+      m_deletion_queue{ deletion_queue }, m_memory_creator{ std::move(memory_creator) }, m_name{ std::move(name) },
+      m_transition_state{ vk::Image{},
+                          m_memory_creator.getImageAspectFlags(),
+                          m_memory_creator.getMipLevels(),
+                          ImageTransition{} } {}
+
+void VulkanImageTarget::resize(const vk::Extent2D resolution) {
+    if (resolution == m_resolution) {
+        return;
+    }
+    if (*m_image_memory_image_view.image_view) {
+        m_deletion_queue.retire(std::exchange(m_image_memory_image_view, ImageMemoryImageView{}));
+    }
+    m_resolution = resolution;
+    if (resolution.width != 0 && resolution.height != 0) {
+        m_image_memory_image_view = m_memory_creator.create(
+                m_allocator,
+                m_memory_tracker,
+                m_device,
+                vk::Extent3D{ .width = resolution.width, .height = resolution.height, .depth = 1 },
+                m_name);
+    }
+    m_transition_state = ImageLayoutTransitionState(
+            getImage(), m_memory_creator.getImageAspectFlags(), m_memory_creator.getMipLevels(), ImageTransition{});
 }
 
 /*VulkanImageMemory::VulkanImageMemory(const VulkanDevice& device, const vk::Extent3D resolution,
@@ -3,11 +3,14 @@ export module th.render_system.vulkan:texture;
 import std;
 
 import vulkan;
+import vk_mem_alloc;
 
 import th.scene.texture_data;
 
 import :buffer;
+import :deletion_queue;
 import :device;
+import :memory_tracker;
 import :utils;
 
 namespace th {
@@ -18,19 +21,27 @@ export void blitImage(vk::CommandBuffer command_buffer, vk::Image src_image, vk:
                       vk::Image dst_image, vk::Extent3D dst_resolution);
 
 struct ImageMemoryImageView {
-    vk::raii::Image image;
-    vk::raii::DeviceMemory memory;
-    vk::raii::ImageView image_view;
+    vma::raii::Image image{ nullptr };
+    vk::raii::ImageView image_view{ nullptr };
+    GpuMemoryTag memory_tag;
 };
 
+// Images at least this large get their own VkDeviceMemory instead of claiming most of a shared block.
+export constexpr auto g_dedicated_image_allocation_threshold = vk::DeviceSize{ 16 * 1024 * 1024 };
+
 export class VulkanImageMemoryCreator {
 public:
     VulkanImageMemoryCreator(vk::Format format, vk::ImageUsageFlags image_usage_flags,
                              vk::MemoryPropertyFlags memory_property_flags, vk::ImageAspectFlags aspect_flags,
                              vk::SampleCountFlagBits msaa, uint32_t mip_levels);
 
-    [[nodiscard]] auto create(const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
-                              vk::Extent3D resolution) const -> ImageMemoryImageView;
+    // Render targets and large images are allocated dedicated: they are recreated as a whole on resize, and would
+    // otherwise pin or fragment the blocks shared by small resources. Attachments and storage images are accounted as
+    // render targets. Transient attachments prefer lazily allocated memory, which tiled GPUs only back when the tile
+    // data is stored.
+    [[nodiscard]] auto create(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                              const vk::raii::Device& device, vk::Extent3D resolution, std::string_view name) const
+            -> ImageMemoryImageView;
 
     [[nodiscard]] auto getMipLevels() const -> uint32_t {
         return m_mip_levels;
@@ -49,6 +60,54 @@ private:
     uint32_t m_mip_levels{ 1 };
 };
 
+// Render target owning its image, such as a depth buffer. The image is created on the first resize; later resizes
+// retire the previous image through the deletion queue, as frames in flight may still use it.
+export class VulkanImageTarget final: public RenderTarget {
+public:
+    VulkanImageTarget(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                      const vk::raii::Device& device, DeferredDeletionQueue& deletion_queue,
+                      VulkanImageMemoryCreator memory_creator, std::string name);
+
+    VulkanImageTarget(const VulkanImageTarget&) = delete;
+    VulkanImageTarget(VulkanImageTarget&&) = delete;
+    auto operator=(const VulkanImageTarget&) -> VulkanImageTarget& = delete;
+    auto operator=(VulkanImageTarget&&) -> VulkanImageTarget& = delete;
+    ~VulkanImageTarget() override = default;
+
+    [[nodiscard]] auto getImage() const noexcept -> vk::Image override {
+        const vk::raii::Image& image = m_image_memory_image_view.image;
+        return *image;
+    }
+
+    [[nodiscard]] auto getImageView() const noexcept -> vk::ImageView override {
+        return *m_image_memory_image_view.image_view;
+    }
+
+    [[nodiscard]] auto getImageMemoryBarrier(const ImageTransition& transition) noexcept
+            -> vk::ImageMemoryBarrier2 override {
+        return m_transition_state.getImageMemoryBarrier(transition);
+    }
+
+    [[nodiscard]] auto getResolution() const noexcept -> vk::Extent2D override {
+        return m_resolution;
+    }
+
+    // Does nothing when the resolution is unchanged. The new image starts in the undefined layout.
+    void resize(vk::Extent2D resolution);
+
+private:
+    const vma::raii::Allocator& m_allocator;
+    GpuMemoryTracker& m_memory_tracker;
+    const vk::raii::Device& m_device;
+    DeferredDeletionQueue& m_deletion_queue;
+    VulkanImageMemoryCreator m_memory_creator;
+    std::string m_name;
+
+    ImageMemoryImageView m_image_memory_image_view;
+    ImageLayoutTransitionState m_transition_state;
+    vk::Extent2D m_resolution{};
+};
+
 /*export class VulkanImageMemory: public RenderTarget {
 public:
     VulkanImageMemory(const VulkanDevice& device, vk::Extent3D resolution, VulkanImageMemoryCreator memory_creator,
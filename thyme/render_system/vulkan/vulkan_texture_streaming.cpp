@@ -0,0 +1,502 @@
+module;
+
+module th.render_system.vulkan;
+
+namespace th {
+
+// TextureData always holds RGBA8 texels, so every streamed image has this format and budgets count 4 bytes a texel.
+constexpr auto g_streamed_texture_format = vk::Format::eR8G8B8A8Unorm;
+constexpr auto g_streamed_texel_size = vk::DeviceSize{ 4 };
+
+[[nodiscard]] static auto getImage(const vma::raii::Image& image) -> vk::Image {
+    const vk::raii::Image& vk_image = image;
+    return *vk_image;
+}
+
+[[nodiscard]] static auto createStreamedImageBarrier(const vk::Image image, const uint32_t base_mip_level,
+                                                     const uint32_t mip_levels,
+                                                     const ImageLayoutTransition& layout_transition,
+                                                     const vk::PipelineStageFlags2 src_stage_mask,
+                                                     const vk::AccessFlags2 src_access_mask,
+                                                     const vk::PipelineStageFlags2 dst_stage_mask,
+                                                     const vk::AccessFlags2 dst_access_mask)
+        -> vk::ImageMemoryBarrier2 {
+    return vk::ImageMemoryBarrier2{
+        .srcStageMask = src_stage_mask,
+        .srcAccessMask = src_access_mask,
+        .dstStageMask = dst_stage_mask,
+        .dstAccessMask = dst_access_mask,
+        .oldLayout = layout_transition.oldLayout,
+        .newLayout = layout_transition.newLayout,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .image = image,
+        .subresourceRange = vk::ImageSubresourceRange{ .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                       .baseMipLevel = base_mip_level,
+                                                       .levelCount = mip_levels,
+                                                       .baseArrayLayer = 0,
+                                                       .layerCount = 1 },
+    };
+}
+
+[[nodiscard]] static auto maxComponent(const glm::uvec2 resolution) noexcept -> uint32_t {
+    return std::max(resolution.x, resolution.y);
+}
+
+constexpr auto g_shader_read_stages =
+        vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+TextureStreamer::TextureStreamer(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                                 const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                                 JobSystem& job_system, const uint32_t max_frames_in_flight,
+                                 const TextureStreamingSettings& settings, Logger& logger)
+    : m_allocator{ allocator }, m_memory_tracker{ memory_tracker }, m_device{ device }, m_job_system{ job_system },
+      m_settings{ settings }, m_logger{ logger }, m_retired_resources(max_frames_in_flight) {
+    const auto memory_properties = physical_device.getMemoryProperties();
+    for (uint32_t heap{ 0 }; heap < memory_properties.memoryHeapCount; ++heap) {
+        if (memory_properties.memoryHeaps[heap].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+            m_device_local_heaps.push_back(heap);
+        }
+    }
+    m_logger.debug("Texture streamer started with budget {} bytes", getMemoryBudget());
+}
+
+TextureStreamer::~TextureStreamer() {
+    // Decoding jobs push into m_decoded, they have to finish before it goes away.
+    m_job_system.wait(m_pending_requests);
+}
+
+void TextureStreamer::RetiredResources::retire(StreamedImage& image) {
+    image_views.push_back(std::move(image.image_view));
+    images.push_back(std::move(image.image));
+    memory_tags.push_back(std::move(image.memory_tag));
+}
+
+auto TextureStreamer::addTexture(std::shared_ptr<const TextureData> texture_data) -> StreamedTextureHandle {
+    const auto mip_levels = texture_data->getMipLevels();
+    auto tail_mip_level = 0u;
+    while (tail_mip_level + 1 < mip_levels
+           && maxComponent(texture_data->getMipResolution(tail_mip_level)) > m_settings.mip_tail_size) {
+        ++tail_mip_level;
+    }
+    const auto id = static_cast<uint32_t>(m_textures.size());
+    m_textures.push_back(StreamedTexture{
+            .data = std::move(texture_data),
+            .tail_mip_level = tail_mip_level,
+            .detail_mip_level = mip_levels,
+            .resident_mip_level = mip_levels,
+            .desired_mip_level = tail_mip_level,
+            .last_used_frame = m_frame,
+            .request_in_flight = true,
+    });
+    enqueueRequest(id, tail_mip_level);
+    return StreamedTextureHandle{ .id = id };
+}
+
+void TextureStreamer::requestScreenSize(const StreamedTextureHandle handle, const float screen_size_in_pixels) {
+    auto& texture = m_textures[handle.id];
+    const auto base_size = static_cast<float>(maxComponent(texture.data->getResolution()));
+    const auto mip_level = static_cast<uint32_t>(
+            std::clamp(std::floor(std::log2(base_size / std::max(screen_size_in_pixels, 1.0f))),
+                       0.0f,
+                       static_cast<float>(texture.tail_mip_level)));
+    texture.desired_mip_level =
+            texture.last_used_frame == m_frame ? std::min(texture.desired_mip_level, mip_level) : mip_level;
+    texture.last_used_frame = m_frame;
+}
+
+void TextureStreamer::update(const vk::CommandBuffer command_buffer, const uint32_t frame_index) {
+    auto& retired = m_retired_resources[frame_index];
+    retired = RetiredResources{};
+
+    auto decoded_mips = std::exchange(m_postponed_uploads, {});
+    std::ranges::move(takeDecodedMips(), std::back_inserter(decoded_mips));
+
+    auto uploads = 0u;
+    for (auto& decoded : decoded_mips) {
+        auto& texture = m_textures[decoded.texture_id];
+        if (uploads >= m_settings.max_uploads_per_frame) {
+            m_postponed_uploads.push_back(std::move(decoded));
+            continue;
+        }
+        texture.request_in_flight = false;
+        // A detail image evicted while its next level was decoding leaves a gap, so the decoded level is dropped.
+        if (decoded.first_mip_level + decoded.mips.size() != texture.resident_mip_level) {
+            continue;
+        }
+        const auto is_tail = decoded.first_mip_level == texture.tail_mip_level;
+        try {
+            if (is_tail) {
+                auto tail = createStreamedImage(texture, texture.tail_mip_level);
+                uploadMips(command_buffer, texture, getImage(tail.image), texture.tail_mip_level, decoded, retired);
+                tail.image_view = createImageView(
+                        texture, getImage(tail.image), texture.tail_mip_level, texture.tail_mip_level);
+                texture.tail = std::move(tail);
+                m_resident_bytes += getMipChainSize(texture, texture.tail_mip_level);
+            } else {
+                if (decoded.first_mip_level < texture.detail_mip_level) {
+                    // Allocated down to the desired level when that fits, so the next levels need no new image.
+                    auto first_mip_level = std::min(texture.desired_mip_level, decoded.first_mip_level);
+                    if (isOverBudget(getDetailGrowth(texture, first_mip_level))) {
+                        first_mip_level = decoded.first_mip_level;
+                    }
+                    const auto growth = getDetailGrowth(texture, first_mip_level);
+                    while (m_resident_bytes + growth > getMemoryBudget() && evictLeastRecentlyUsed(retired)) {}
+                    // Eviction may have dropped the detail image of this very texture.
+                    if (decoded.first_mip_level + 1 != texture.resident_mip_level || isOverBudget(growth)) {
+                        continue;
+                    }
+                    allocateDetail(command_buffer, texture, first_mip_level, retired);
+                }
+                const auto image_mip_level = texture.detail_mip_level;
+                uploadMips(command_buffer, texture, getImage(texture.detail.image), image_mip_level, decoded, retired);
+                retired.image_views.push_back(std::move(texture.detail.image_view));
+                texture.detail.image_view = createImageView(
+                        texture, getImage(texture.detail.image), image_mip_level, decoded.first_mip_level);
+            }
+            texture.resident_mip_level = decoded.first_mip_level;
+            ++uploads;
+        } catch (const vk::OutOfDeviceMemoryError& error) {
+            m_logger.warn("Out of device memory while streaming texture {}: {}", decoded.texture_id, error.what());
+            if (is_tail) {
+                texture.request_in_flight = true;
+                m_postponed_uploads.push_back(std::move(decoded));
+            }
+            evictLeastRecentlyUsed(retired);
+        }
+    }
+
+    for (uint32_t id{ 0 }; id < m_textures.size(); ++id) {
+        auto& texture = m_textures[id];
+        if (texture.request_in_flight || texture.resident_mip_level > texture.tail_mip_level
+            || texture.desired_mip_level >= texture.resident_mip_level || texture.last_used_frame != m_frame) {
+            continue;
+        }
+        const auto next_mip_level = texture.resident_mip_level - 1;
+        if (isOverBudget(getDetailGrowth(texture, next_mip_level))) {
+            continue;
+        }
+        texture.request_in_flight = true;
+        enqueueRequest(id, next_mip_level);
+    }
+
+    // Evicted images stay alive until the frame retiring them completes, so only the resident bytes drop right away.
+    // Heap usage reported by VMA lags behind and evicts a single texture per frame, instead of the whole cache at once.
+    while (m_resident_bytes > getMemoryBudget() && evictLeastRecentlyUsed(retired)) {}
+    if (isOverBudget(0)) {
+        evictLeastRecentlyUsed(retired);
+    }
+
+    ++m_frame;
+}
+
+auto TextureStreamer::getImageView(const StreamedTextureHandle handle) const noexcept -> vk::ImageView {
+    const auto& texture = m_textures[handle.id];
+    return texture.detail_mip_level < texture.data->getMipLevels() ? *texture.detail.image_view
+                                                                    : *texture.tail.image_view;
+}
+
+auto TextureStreamer::isResident(const StreamedTextureHandle handle) const noexcept -> bool {
+    const auto& texture = m_textures[handle.id];
+    return texture.resident_mip_level < texture.data->getMipLevels();
+}
+
+auto TextureStreamer::getMemoryBudget() const -> vk::DeviceSize {
+    if (m_settings.memory_budget != 0) {
+        return m_settings.memory_budget;
+    }
+    const auto budgets = m_allocator.getHeapBudgets();
+    auto budget = vk::DeviceSize{ 0 };
+    for (const auto heap : m_device_local_heaps) {
+        budget += budgets[heap].budget;
+    }
+    return static_cast<vk::DeviceSize>(static_cast<double>(budget) * m_settings.heap_budget_fraction);
+}
+
+void TextureStreamer::decode(const MipRequest& request) {
+    auto decoded = DecodedMips{ .texture_id = request.texture_id, .first_mip_level = request.mip_level };
+    if (request.whole_chain) {
+        decoded.mips = request.data->generateMipChain(request.mip_level);
+    } else {
+        decoded.mips.push_back(request.data->generateMipLevel(request.mip_level));
+    }
+    std::scoped_lock lock{ m_decoded_mutex };
+    m_decoded.push_back(std::move(decoded));
+}
+
+void TextureStreamer::enqueueRequest(const uint32_t texture_id, const uint32_t mip_level) {
+    const auto& texture = m_textures[texture_id];
+    m_job_system.runBackground(
+            [this,
+             request = MipRequest{ .texture_id = texture_id,
+                                   .mip_level = mip_level,
+                                   .whole_chain = mip_level == texture.tail_mip_level,
+                                   .data = texture.data }] { decode(request); },
+            &m_pending_requests);
+}
+
+auto TextureStreamer::takeDecodedMips() -> std::vector<DecodedMips> {
+    std::scoped_lock lock{ m_decoded_mutex };
+    return std::exchange(m_decoded, {});
+}
+
+auto TextureStreamer::createStreamedImage(const StreamedTexture& texture, const uint32_t first_mip_level) const
+        -> StreamedImage {
+    const auto resolution = texture.data->getMipResolution(first_mip_level);
+    auto image = m_allocator.createImage(
+            vk::ImageCreateInfo{
+                    .imageType = vk::ImageType::e2D,
+                    .format = g_streamed_texture_format,
+                    .extent = vk::Extent3D{ .width = resolution.x, .height = resolution.y, .depth = 1 },
+                    .mipLevels = texture.data->getMipLevels() - first_mip_level,
+                    .arrayLayers = 1,
+                    .samples = vk::SampleCountFlagBits::e1,
+                    .tiling = vk::ImageTiling::eOptimal,
+                    .usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst
+                             | vk::ImageUsageFlagBits::eSampled,
+                    .sharingMode = vk::SharingMode::eExclusive,
+                    .initialLayout = vk::ImageLayout::eUndefined,
+            },
+            vma::AllocationCreateInfo{ .usage = vma::MemoryUsage::eGpuOnly });
+    auto memory_tag = m_memory_tracker.track(
+            *image.getAllocation(),
+            GpuMemoryCategory::texture,
+            std::format("streamed texture {} from mip {}", &texture - m_textures.data(), first_mip_level));
+    return StreamedImage{ .image = std::move(image), .memory_tag = std::move(memory_tag) };
+}
+
+auto TextureStreamer::createImageView(const StreamedTexture& texture, const vk::Image image,
+                                      const uint32_t image_mip_level, const uint32_t first_mip_level) const
+        -> vk::raii::ImageView {
+    return m_device.createImageView(vk::ImageViewCreateInfo{
+            .image = image,
+            .viewType = vk::ImageViewType::e2D,
+            .format = g_streamed_texture_format,
+            .subresourceRange = vk::ImageSubresourceRange{ .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                           .baseMipLevel = first_mip_level - image_mip_level,
+                                                           .levelCount = texture.data->getMipLevels()
+                                                                         - first_mip_level,
+                                                           .baseArrayLayer = 0,
+                                                           .layerCount = 1 },
+    });
+}
+
+void TextureStreamer::uploadMips(const vk::CommandBuffer command_buffer, const StreamedTexture& texture,
+                                 const vk::Image image, const uint32_t image_mip_level, const DecodedMips& decoded,
+                                 RetiredResources& retired) {
+    const auto first_level = decoded.first_mip_level - image_mip_level;
+    const auto level_count = static_cast<uint32_t>(decoded.mips.size());
+
+    const auto staging_size = std::ranges::fold_left(
+            decoded.mips, vk::DeviceSize{ 0 }, [](const auto sum, const auto& mip) { return sum + mip.size(); });
+    auto staging_buffer = createStagingBuffer(m_allocator, staging_size);
+    auto staging_memory_tag = m_memory_tracker.track(
+            *staging_buffer.getAllocation(),
+            GpuMemoryCategory::staging,
+            std::format("streamed texture {} mips {} staging", decoded.texture_id, decoded.first_mip_level));
+    auto* const mapped_memory = static_cast<uint8_t*>(staging_buffer.getAllocation().map());
+    std::vector<vk::BufferImageCopy2> buffer_copy_regions;
+    auto offset = vk::DeviceSize{ 0 };
+    for (uint32_t i{ 0 }; i < level_count; ++i) {
+        const auto& mip = decoded.mips[i];
+        std::memcpy(mapped_memory + offset, mip.data(), mip.size());
+        const auto resolution = texture.data->getMipResolution(decoded.first_mip_level + i);
+        buffer_copy_regions.push_back(vk::BufferImageCopy2{
+                .bufferOffset = offset,
+                .imageSubresource = vk::ImageSubresourceLayers{ .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                                .mipLevel = first_level + i,
+                                                                .baseArrayLayer = 0,
+                                                                .layerCount = 1 },
+                .imageExtent = vk::Extent3D{ .width = resolution.x, .height = resolution.y, .depth = 1 },
+        });
+        offset += mip.size();
+    }
+    staging_buffer.getAllocation().unmap();
+
+    // No view covers the levels yet, so their previous contents are discarded. The transition still waits for the
+    // copy and layout transitions allocateDetail recorded on the whole image.
+    const auto write_barrier = createStreamedImageBarrier(
+            image,
+            first_level,
+            level_count,
+            ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eUndefined,
+                                   .newLayout = vk::ImageLayout::eTransferDstOptimal },
+            vk::PipelineStageFlagBits2::eCopy | g_shader_read_stages,
+            vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferWrite);
+    command_buffer.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &write_barrier,
+    });
+
+    const vk::raii::Buffer& vk_staging_buffer = staging_buffer;
+    command_buffer.copyBufferToImage2(vk::CopyBufferToImageInfo2{
+            .srcBuffer = *vk_staging_buffer,
+            .dstImage = image,
+            .dstImageLayout = vk::ImageLayout::eTransferDstOptimal,
+            .regionCount = static_cast<uint32_t>(buffer_copy_regions.size()),
+            .pRegions = buffer_copy_regions.data(),
+    });
+
+    const auto read_barrier = createStreamedImageBarrier(
+            image,
+            first_level,
+            level_count,
+            ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                                   .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal },
+            vk::PipelineStageFlagBits2::eCopy,
+            vk::AccessFlagBits2::eTransferWrite,
+            g_shader_read_stages,
+            vk::AccessFlagBits2::eShaderSampledRead);
+    command_buffer.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &read_barrier,
+    });
+
+    retired.staging_buffers.push_back(std::move(staging_buffer));
+    retired.memory_tags.push_back(std::move(staging_memory_tag));
+}
+
+void TextureStreamer::allocateDetail(const vk::CommandBuffer command_buffer, StreamedTexture& texture,
+                                     const uint32_t first_mip_level, RetiredResources& retired) {
+    const auto mip_levels = texture.data->getMipLevels();
+    const auto resident_mip_level = texture.resident_mip_level;
+    const auto has_detail = texture.detail_mip_level < mip_levels;
+    const auto& source = has_detail ? texture.detail : texture.tail;
+    const auto source_mip_level = has_detail ? texture.detail_mip_level : texture.tail_mip_level;
+    const auto source_image = getImage(source.image);
+
+    auto detail = createStreamedImage(texture, first_mip_level);
+    const auto detail_image = getImage(detail.image);
+
+    const auto copy_barriers = std::array{
+        createStreamedImageBarrier(detail_image,
+                                   0,
+                                   mip_levels - first_mip_level,
+                                   ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eUndefined,
+                                                          .newLayout = vk::ImageLayout::eTransferDstOptimal },
+                                   vk::PipelineStageFlagBits2::eNone,
+                                   vk::AccessFlagBits2::eNone,
+                                   vk::PipelineStageFlagBits2::eCopy,
+                                   vk::AccessFlagBits2::eTransferWrite),
+        createStreamedImageBarrier(source_image,
+                                   resident_mip_level - source_mip_level,
+                                   mip_levels - resident_mip_level,
+                                   ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                                                          .newLayout = vk::ImageLayout::eTransferSrcOptimal },
+                                   g_shader_read_stages,
+                                   vk::AccessFlagBits2::eShaderSampledRead,
+                                   vk::PipelineStageFlagBits2::eCopy,
+                                   vk::AccessFlagBits2::eTransferRead),
+    };
+    command_buffer.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = static_cast<uint32_t>(copy_barriers.size()),
+            .pImageMemoryBarriers = copy_barriers.data(),
+    });
+
+    std::vector<vk::ImageCopy2> image_copy_regions;
+    for (auto level = resident_mip_level; level < mip_levels; ++level) {
+        const auto resolution = texture.data->getMipResolution(level);
+        image_copy_regions.push_back(vk::ImageCopy2{
+                .srcSubresource = vk::ImageSubresourceLayers{ .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                              .mipLevel = level - source_mip_level,
+                                                              .baseArrayLayer = 0,
+                                                              .layerCount = 1 },
+                .dstSubresource = vk::ImageSubresourceLayers{ .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                                              .mipLevel = level - first_mip_level,
+                                                              .baseArrayLayer = 0,
+                                                              .layerCount = 1 },
+                .extent = vk::Extent3D{ .width = resolution.x, .height = resolution.y, .depth = 1 },
+        });
+    }
+    command_buffer.copyImage2(vk::CopyImageInfo2{
+            .srcImage = source_image,
+            .srcImageLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .dstImage = detail_image,
+            .dstImageLayout = vk::ImageLayout::eTransferDstOptimal,
+            .regionCount = static_cast<uint32_t>(image_copy_regions.size()),
+            .pRegions = image_copy_regions.data(),
+    });
+
+    // The tail goes back to shader reads, while a replaced detail image is retired as it is.
+    const auto read_barriers = std::array{
+        createStreamedImageBarrier(detail_image,
+                                   0,
+                                   mip_levels - first_mip_level,
+                                   ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                                                          .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal },
+                                   vk::PipelineStageFlagBits2::eCopy,
+                                   vk::AccessFlagBits2::eTransferWrite,
+                                   g_shader_read_stages,
+                                   vk::AccessFlagBits2::eShaderSampledRead),
+        createStreamedImageBarrier(source_image,
+                                   resident_mip_level - source_mip_level,
+                                   mip_levels - resident_mip_level,
+                                   ImageLayoutTransition{ .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
+                                                          .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal },
+                                   vk::PipelineStageFlagBits2::eCopy,
+                                   vk::AccessFlagBits2::eTransferRead,
+                                   g_shader_read_stages,
+                                   vk::AccessFlagBits2::eShaderSampledRead),
+    };
+    command_buffer.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = has_detail ? 1u : 2u,
+            .pImageMemoryBarriers = read_barriers.data(),
+    });
+
+    m_resident_bytes += getDetailGrowth(texture, first_mip_level);
+    detail.image_view = createImageView(texture, detail_image, first_mip_level, resident_mip_level);
+    if (has_detail) {
+        retired.retire(texture.detail);
+    }
+    texture.detail = std::move(detail);
+    texture.detail_mip_level = first_mip_level;
+}
+
+auto TextureStreamer::evictLeastRecentlyUsed(RetiredResources& retired) -> bool {
+    const auto evictable = m_textures | std::views::filter([this](const StreamedTexture& texture) {
+                               return texture.detail_mip_level < texture.data->getMipLevels()
+                                      && texture.last_used_frame < m_frame;
+                           });
+    const auto least_recently_used = std::ranges::min_element(evictable, {}, &StreamedTexture::last_used_frame);
+    if (least_recently_used == evictable.end()) {
+        return false;
+    }
+    auto& texture = *least_recently_used;
+    m_resident_bytes -= getMipChainSize(texture, texture.detail_mip_level);
+    retired.retire(texture.detail);
+    texture.detail_mip_level = texture.data->getMipLevels();
+    texture.resident_mip_level = texture.tail_mip_level;
+    return true;
+}
+
+auto TextureStreamer::isOverBudget(const vk::DeviceSize additional_bytes) const -> bool {
+    if (m_resident_bytes + additional_bytes > getMemoryBudget()) {
+        return true;
+    }
+    const auto budgets = m_allocator.getHeapBudgets();
+    return std::ranges::any_of(m_device_local_heaps, [&budgets, additional_bytes](const auto heap) {
+        return budgets[heap].usage + additional_bytes > budgets[heap].budget;
+    });
+}
+
+auto TextureStreamer::getMipChainSize(const StreamedTexture& texture, const uint32_t first_mip_level) const noexcept
+        -> vk::DeviceSize {
+    auto size = vk::DeviceSize{ 0 };
+    for (auto level = first_mip_level; level < texture.data->getMipLevels(); ++level) {
+        const auto resolution = texture.data->getMipResolution(level);
+        size += static_cast<vk::DeviceSize>(resolution.x) * resolution.y * g_streamed_texel_size;
+    }
+    return size;
+}
+
+auto TextureStreamer::getDetailGrowth(const StreamedTexture& texture, const uint32_t first_mip_level) const noexcept
+        -> vk::DeviceSize {
+    if (first_mip_level >= texture.detail_mip_level) {
+        return 0;
+    }
+    return getMipChainSize(texture, first_mip_level) - getMipChainSize(texture, texture.detail_mip_level);
+}
+
+}// namespace th
@@ -0,0 +1,168 @@
+export module th.render_system.vulkan:texture_streaming;
+
+import std;
+
+import vulkan;
+import vk_mem_alloc;
+
+import th.core.job_system;
+import th.core.logger;
+import th.scene.texture_data;
+
+import :buffer;
+import :memory_tracker;
+import :utils;
+
+namespace th {
+
+export struct TextureStreamingSettings {
+    // Budget in bytes for streamed texture memory. When zero the budget is derived from the device local heap budget
+    // reported by VMA, scaled by heap_budget_fraction.
+    vk::DeviceSize memory_budget{ 0 };
+    float heap_budget_fraction{ 0.5f };
+    // Largest dimension of the mip tail, which is uploaded at registration and never evicted.
+    uint32_t mip_tail_size{ 64 };
+    uint32_t max_uploads_per_frame{ 4 };
+};
+
+export struct StreamedTextureHandle {
+    uint32_t id{ std::numeric_limits<uint32_t>::max() };
+
+    [[nodiscard]] auto isValid() const noexcept -> bool {
+        return id != std::numeric_limits<uint32_t>::max();
+    }
+};
+
+// Streams the mip levels of RGBA8 textures under a memory budget. Every texture keeps its mip tail in a small image
+// that is never evicted. Finer levels go to a detail image allocated once down to the level the texture is wanted at,
+// so streaming a level in only uploads that level and moves the view's base mip. Eviction releases the detail image of
+// the least recently used texture, which frees memory without allocating or copying anything.
+export class TextureStreamer {
+    struct StreamedImage {
+        vma::raii::Image image{ nullptr };
+        vk::raii::ImageView image_view{ nullptr };
+        GpuMemoryTag memory_tag;
+    };
+
+    struct StreamedTexture {
+        std::shared_ptr<const TextureData> data;
+        // Mip levels [tail_mip_level, mip count).
+        StreamedImage tail;
+        // Mip levels [detail_mip_level, mip count), the view only covers the resident ones.
+        StreamedImage detail;
+        uint32_t tail_mip_level{ 0 };
+        // The mip count while there is no detail image.
+        uint32_t detail_mip_level{ 0 };
+        // Mip levels [resident_mip_level, mip count) are resident, so the mip count means nothing is resident yet.
+        uint32_t resident_mip_level{ 0 };
+        uint32_t desired_mip_level{ 0 };
+        uint64_t last_used_frame{ 0 };
+        bool request_in_flight{ false };
+    };
+
+    struct MipRequest {
+        uint32_t texture_id{ 0 };
+        uint32_t mip_level{ 0 };
+        bool whole_chain{ false };
+        std::shared_ptr<const TextureData> data;
+    };
+
+    struct DecodedMips {
+        uint32_t texture_id{ 0 };
+        uint32_t first_mip_level{ 0 };
+        std::vector<std::vector<uint8_t>> mips;
+    };
+
+    struct RetiredResources {
+        std::vector<vma::raii::Buffer> staging_buffers;
+        std::vector<vma::raii::Image> images;
+        std::vector<vk::raii::ImageView> image_views;
+        std::vector<GpuMemoryTag> memory_tags;
+
+        void retire(StreamedImage& image);
+    };
+
+public:
+    TextureStreamer(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                    const vk::raii::PhysicalDevice& physical_device, const vk::raii::Device& device,
+                    JobSystem& job_system, uint32_t max_frames_in_flight, const TextureStreamingSettings& settings,
+                    Logger& logger);
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer(TextureStreamer&&) = delete;
+    auto operator=(const TextureStreamer&) -> TextureStreamer& = delete;
+    auto operator=(TextureStreamer&&) -> TextureStreamer& = delete;
+    ~TextureStreamer();
+
+    // Registers the texture; its mip tail is generated as a background job and uploaded on a following update().
+    [[nodiscard]] auto addTexture(std::shared_ptr<const TextureData> texture_data) -> StreamedTextureHandle;
+
+    // Reports the largest on-screen extent (in pixels) the texture is drawn at this frame. Drives both which mip is
+    // streamed in and the LRU order used for eviction.
+    void requestScreenSize(StreamedTextureHandle handle, float screen_size_in_pixels);
+
+    // Records pending uploads and evictions. Must be called once per frame, after the fence of frame_index signalled.
+    void update(vk::CommandBuffer command_buffer, uint32_t frame_index);
+
+    // The image view changes whenever a mip is streamed in or evicted, so descriptors should be refreshed per frame.
+    // Null until the mip tail is resident.
+    [[nodiscard]] auto getImageView(StreamedTextureHandle handle) const noexcept -> vk::ImageView;
+
+    [[nodiscard]] auto isResident(StreamedTextureHandle handle) const noexcept -> bool;
+
+    [[nodiscard]] auto getResidentMipLevel(StreamedTextureHandle handle) const noexcept -> uint32_t {
+        return m_textures[handle.id].resident_mip_level;
+    }
+
+    [[nodiscard]] auto getResidentBytes() const noexcept -> vk::DeviceSize {
+        return m_resident_bytes;
+    }
+
+    [[nodiscard]] auto getMemoryBudget() const -> vk::DeviceSize;
+
+private:
+    void decode(const MipRequest& request);
+    void enqueueRequest(uint32_t texture_id, uint32_t mip_level);
+    [[nodiscard]] auto takeDecodedMips() -> std::vector<DecodedMips>;
+
+    // The image without a view, its level 0 is first_mip_level of the texture.
+    [[nodiscard]] auto createStreamedImage(const StreamedTexture& texture, uint32_t first_mip_level) const
+            -> StreamedImage;
+    // View of the levels [first_mip_level, mip count) of an image whose level 0 is image_mip_level of the texture.
+    [[nodiscard]] auto createImageView(const StreamedTexture& texture, vk::Image image, uint32_t image_mip_level,
+                                       uint32_t first_mip_level) const -> vk::raii::ImageView;
+    void uploadMips(vk::CommandBuffer command_buffer, const StreamedTexture& texture, vk::Image image,
+                    uint32_t image_mip_level, const DecodedMips& decoded, RetiredResources& retired);
+    // Replaces the detail image by one starting at first_mip_level, holding a copy of the resident levels.
+    void allocateDetail(vk::CommandBuffer command_buffer, StreamedTexture& texture, uint32_t first_mip_level,
+                        RetiredResources& retired);
+    auto evictLeastRecentlyUsed(RetiredResources& retired) -> bool;
+    [[nodiscard]] auto isOverBudget(vk::DeviceSize additional_bytes) const -> bool;
+
+    [[nodiscard]] auto getMipChainSize(const StreamedTexture& texture, uint32_t first_mip_level) const noexcept
+            -> vk::DeviceSize;
+    // Memory a detail image starting at first_mip_level takes beyond the current one.
+    [[nodiscard]] auto getDetailGrowth(const StreamedTexture& texture, uint32_t first_mip_level) const noexcept
+            -> vk::DeviceSize;
+
+private:
+    const vma::raii::Allocator& m_allocator;
+    GpuMemoryTracker& m_memory_tracker;
+    const vk::raii::Device& m_device;
+    JobSystem& m_job_system;
+    TextureStreamingSettings m_settings;
+    Logger& m_logger;
+
+    std::vector<uint32_t> m_device_local_heaps;
+    std::vector<StreamedTexture> m_textures;
+    std::vector<RetiredResources> m_retired_resources;
+    std::vector<DecodedMips> m_postponed_uploads;
+    vk::DeviceSize m_resident_bytes{ 0 };
+    uint64_t m_frame{ 0 };
+
+    JobCounter m_pending_requests;
+    std::mutex m_decoded_mutex;
+    std::vector<DecodedMips> m_decoded;
+};
+
+}// namespace th
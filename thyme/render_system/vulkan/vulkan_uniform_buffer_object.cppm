@@ -6,6 +6,7 @@ import vulkan;
 
 import :buffer;
 import :device;
+import :memory_tracker;
 #include <cassert>
 
 export namespace th {
@@ -15,14 +16,18 @@ class VulkanUniformBuffer2 final {
     template <typename T>
     class UniformBuffer final {
     public:
-        explicit UniformBuffer(const vma::raii::Allocator& allocator)
+        UniformBuffer(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                      const std::string_view name)
             : m_buffer(allocator.createBuffer(
                       vk::BufferCreateInfo{
                               .size = sizeof(T),
-                              .usage = vk::BufferUsageFlagBits::eUniformBuffer,
+                              // Also readable from the bindless heap as a storage buffer.
+                              .usage = vk::BufferUsageFlagBits::eUniformBuffer
+                                       | vk::BufferUsageFlagBits::eStorageBuffer,
                               .sharingMode = vk::SharingMode::eExclusive,
                       },
                       vma::AllocationCreateInfo{ .usage = vma::MemoryUsage::eCpuToGpu })),
+              m_memory_tag(memory_tracker.track(*m_buffer.getAllocation(), GpuMemoryCategory::uniform_buffer, name)),
               m_mapped_memory_buffer(m_buffer.getAllocation().map()) {}
 
         void update(const T& obj) const noexcept {
@@ -40,14 +45,16 @@ class VulkanUniformBuffer2 final {
 
     private:
         vma::raii::Buffer m_buffer;
+        GpuMemoryTag m_memory_tag;
         void* m_mapped_memory_buffer{ nullptr };
     };
 
 public:
-    VulkanUniformBuffer2(const vma::raii::Allocator& allocator, std::size_t num_buffers_in_flight) {
+    VulkanUniformBuffer2(const vma::raii::Allocator& allocator, GpuMemoryTracker& memory_tracker,
+                         std::size_t num_buffers_in_flight, const std::string_view name = "uniform buffer") {
         m_uniform_buffer_objects.reserve(num_buffers_in_flight);
-        std::generate_n(std::back_inserter(m_uniform_buffer_objects), num_buffers_in_flight, [&allocator]() mutable {
-            return UniformBuffer<T>(allocator);
+        std::generate_n(std::back_inserter(m_uniform_buffer_objects), num_buffers_in_flight, [&]() mutable {
+            return UniformBuffer<T>(allocator, memory_tracker, name);
         });
     }
 
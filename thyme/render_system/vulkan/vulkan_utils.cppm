@@ -85,12 +85,14 @@ public:
         return formats[0];
     }
 
-    [[nodiscard]] auto getBestPresetMode() const noexcept -> vk::PresentModeKHR {
-        const auto suitable_preset = std::ranges::find_if(presentModes, [](const vk::PresentModeKHR presentMode) {
-            return presentMode == vk::PresentModeKHR::eMailbox;
+    // Picks the first supported mode of the preference list. FIFO is the fallback as every device must support it.
+    [[nodiscard]] auto getBestPresetMode(const std::span<const vk::PresentModeKHR> preferred_modes) const noexcept
+            -> vk::PresentModeKHR {
+        const auto suitable_preset = std::ranges::find_if(preferred_modes, [this](const vk::PresentModeKHR mode) {
+            return std::ranges::contains(presentModes, mode);
         });
 
-        if (suitable_preset != presentModes.end()) {
+        if (suitable_preset != preferred_modes.end()) {
             return *suitable_preset;
         }
         return vk::PresentModeKHR::eFifo;
@@ -114,9 +116,10 @@ public:
                              std::clamp(fallback_resolution.y, min_image_extent.height, max_image_extent.height) };
     }
 
-    [[nodiscard]] auto getBestSwapChainSettings() const noexcept -> SwapChainSettings {
+    [[nodiscard]] auto getBestSwapChainSettings(const std::span<const vk::PresentModeKHR> preferred_modes) const
+            noexcept -> SwapChainSettings {
         return SwapChainSettings{ .surfaceFormat = getBestSurfaceFormat(),
-                                  .presetMode = getBestPresetMode(),
+                                  .presetMode = getBestPresetMode(preferred_modes),
                                   .imageCount = getImageCount() };
     }
 };
@@ -0,0 +1,115 @@
+module th.scene.animation;
+
+import std;
+import glm;
+
+namespace th {
+
+constexpr auto animation_chunk_size = 4096uz;
+
+template <typename Function>
+void AnimationSystem::forEachChunk(JobSystem* job_system, const std::size_t count, Function&& function) {
+    if (job_system) {
+        job_system->parallelFor(0, count, animation_chunk_size, function);
+    } else {
+        function(0uz, count);
+    }
+}
+
+void AnimationSystem::add(const RotationAnimation& animation) {
+    m_rotations.targets.push_back(animation.target);
+    m_rotations.axes.push_back(glm::normalize(animation.axis));
+    m_rotations.angular_velocities.push_back(animation.angular_velocity);
+    m_rotations.angles.push_back(animation.angle);
+    m_rotations.results.push_back(glm::angleAxis(animation.angle, glm::normalize(animation.axis)));
+}
+
+void AnimationSystem::add(const TranslationCurve& animation) {
+    m_translation_curves.targets.push_back(animation.target);
+    m_translation_curves.origins.push_back(animation.origin);
+    m_translation_curves.amplitudes.push_back(animation.amplitude);
+    m_translation_curves.frequencies.push_back(animation.frequency);
+    m_translation_curves.phases.push_back(animation.phase);
+    m_translation_curves.results.push_back(animation.origin);
+}
+
+void AnimationSystem::add(const KeyframeTrack& animation) {
+    if (animation.keyframes.empty()) {
+        throw std::invalid_argument("Keyframe track needs at least one keyframe");
+    }
+    m_keyframe_tracks.targets.push_back(animation.target);
+    m_keyframe_tracks.first_keyframes.push_back(static_cast<uint32_t>(m_keyframe_tracks.key_times.size()));
+    m_keyframe_tracks.keyframe_counts.push_back(static_cast<uint32_t>(animation.keyframes.size()));
+    for (const auto& [time, translation] : animation.keyframes) {
+        m_keyframe_tracks.key_times.push_back(time);
+        m_keyframe_tracks.key_translations.push_back(translation);
+    }
+    m_keyframe_tracks.results.push_back(animation.keyframes.front().translation);
+}
+
+void AnimationSystem::addCallback(std::function<void(float)> callback) {
+    m_callbacks.push_back(std::move(callback));
+}
+
+void AnimationSystem::update(const float dt, JobSystem* job_system) {
+    m_time += dt;
+    const auto time = m_time;
+
+    forEachChunk(job_system, m_rotations.targets.size(), [this, dt](const std::size_t begin, const std::size_t end) {
+        auto& [targets, axes, angular_velocities, angles, results] = m_rotations;
+        for (auto i = begin; i < end; ++i) {
+            angles[i] = std::fmod(angles[i] + angular_velocities[i] * dt, 2.0f * std::numbers::pi_v<float>);
+        }
+        for (auto i = begin; i < end; ++i) {
+            results[i] = glm::angleAxis(angles[i], axes[i]);
+        }
+    });
+
+    forEachChunk(job_system,
+                 m_translation_curves.targets.size(),
+                 [this, time](const std::size_t begin, const std::size_t end) {
+                     auto& [targets, origins, amplitudes, frequencies, phases, results] = m_translation_curves;
+                     for (auto i = begin; i < end; ++i) {
+                         results[i] = origins[i] + amplitudes[i] * glm::sin(frequencies[i] * time + phases[i]);
+                     }
+                 });
+
+    forEachChunk(
+            job_system, m_keyframe_tracks.targets.size(), [this, time](const std::size_t begin, const std::size_t end) {
+                auto& [targets, first_keyframes, keyframe_counts, key_times, key_translations, results] =
+                        m_keyframe_tracks;
+                for (auto i = begin; i < end; ++i) {
+                    const auto times = std::span{ key_times }.subspan(first_keyframes[i], keyframe_counts[i]);
+                    const auto translations =
+                            std::span{ key_translations }.subspan(first_keyframes[i], keyframe_counts[i]);
+                    const auto duration = times.back();
+                    const auto local_time = duration > 0.0f ? std::fmod(time, duration) : 0.0f;
+                    const auto next = static_cast<std::size_t>(
+                            std::distance(times.begin(), std::ranges::upper_bound(times, local_time)));
+                    if (next == 0 || next == times.size()) {
+                        results[i] = next == 0 ? translations.front() : translations.back();
+                        continue;
+                    }
+                    const auto factor = (local_time - times[next - 1]) / (times[next] - times[next - 1]);
+                    results[i] = glm::mix(translations[next - 1], translations[next], factor);
+                }
+            });
+
+    for (const auto& callback : m_callbacks) {
+        callback(dt);
+    }
+}
+
+void AnimationSystem::apply(SceneGraph& scene_graph) const {
+    for (auto i = 0uz; i < m_translation_curves.targets.size(); ++i) {
+        scene_graph.setTranslation(m_translation_curves.targets[i], m_translation_curves.results[i]);
+    }
+    for (auto i = 0uz; i < m_keyframe_tracks.targets.size(); ++i) {
+        scene_graph.setTranslation(m_keyframe_tracks.targets[i], m_keyframe_tracks.results[i]);
+    }
+    for (auto i = 0uz; i < m_rotations.targets.size(); ++i) {
+        scene_graph.setRotation(m_rotations.targets[i], m_rotations.results[i]);
+    }
+}
+
+}// namespace th
@@ -0,0 +1,97 @@
+export module th.scene.animation;
+
+import std;
+import glm;
+
+import th.core.job_system;
+import th.scene.scene_graph;
+
+export namespace th {
+
+// Spins the node around a fixed axis.
+struct RotationAnimation {
+    SceneNodeHandle target;
+    glm::vec3 axis{ 0.0f, 0.0f, 1.0f };
+    float angular_velocity{ 0.0f };
+    float angle{ 0.0f };
+};
+
+// Moves the node along origin + amplitude * sin(frequency * time + phase).
+struct TranslationCurve {
+    SceneNodeHandle target;
+    glm::vec3 origin{ 0.0f };
+    glm::vec3 amplitude{ 0.0f };
+    glm::vec3 frequency{ 1.0f };
+    glm::vec3 phase{ 0.0f };
+};
+
+struct TranslationKeyframe {
+    float time;
+    glm::vec3 translation;
+};
+
+// Loops through translation keyframes sorted by time, interpolating linearly.
+struct KeyframeTrack {
+    SceneNodeHandle target;
+    std::vector<TranslationKeyframe> keyframes;
+};
+
+// Animates scene nodes in batches: every animation kind lives in its own set of arrays and is updated in one tight
+// loop over all instances, split into chunks across the job system when one is given. Arbitrary callbacks are
+// still supported, but run one by one after the batched kinds.
+class AnimationSystem {
+public:
+    void add(const RotationAnimation& animation);
+    void add(const TranslationCurve& animation);
+    void add(const KeyframeTrack& animation);
+    void addCallback(std::function<void(float)> callback);
+
+    void update(float dt, JobSystem* job_system = nullptr);
+
+    // Writes the animated components of every target into the scene graph.
+    void apply(SceneGraph& scene_graph) const;
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_rotations.targets.size() + m_translation_curves.targets.size() + m_keyframe_tracks.targets.size();
+    }
+
+private:
+    struct Rotations {
+        std::vector<SceneNodeHandle> targets;
+        std::vector<glm::vec3> axes;
+        std::vector<float> angular_velocities;
+        std::vector<float> angles;
+        std::vector<glm::quat> results;
+    };
+
+    struct TranslationCurves {
+        std::vector<SceneNodeHandle> targets;
+        std::vector<glm::vec3> origins;
+        std::vector<glm::vec3> amplitudes;
+        std::vector<glm::vec3> frequencies;
+        std::vector<glm::vec3> phases;
+        std::vector<glm::vec3> results;
+    };
+
+    // Keyframes of all tracks are stored back to back, each track owning a range.
+    struct KeyframeTracks {
+        std::vector<SceneNodeHandle> targets;
+        std::vector<uint32_t> first_keyframes;
+        std::vector<uint32_t> keyframe_counts;
+        std::vector<float> key_times;
+        std::vector<glm::vec3> key_translations;
+        std::vector<glm::vec3> results;
+    };
+
+    template <typename Function>
+    static void forEachChunk(JobSystem* job_system, std::size_t count, Function&& function);
+
+private:
+    float m_time{ 0.0f };
+    Rotations m_rotations;
+    TranslationCurves m_translation_curves;
+    KeyframeTracks m_keyframe_tracks;
+    std::vector<std::function<void(float)>> m_callbacks;
+};
+
+}// namespace th
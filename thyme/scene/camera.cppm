@@ -101,6 +101,15 @@ public:
         return m_view_projection_matrix;
     }
 
+    [[nodiscard]] auto getPosition() const noexcept -> const glm::vec3& {
+        return m_position;
+    }
+
+    [[nodiscard]] auto getProjectionArguments() const noexcept
+            -> const std::variant<PerspectiveCameraArguments, OrthographicCameraArguments>& {
+        return m_projection_camera_arguments;
+    }
+
     auto move(const glm::vec2 offset) noexcept -> void {
         m_position += m_front * glm::vec3(offset.x);
         m_position += m_right * glm::vec3(offset.y);
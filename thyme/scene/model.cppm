@@ -5,6 +5,7 @@ import std;
 import glm;
 
 import th.core.logger;
+import th.core.slot_map;
 import th.scene.texture_data;
 import th.scene.transformation;
 
@@ -29,39 +30,83 @@ public:
     std::string name;
     Mesh mesh;
     TextureData texture;// TODO! make array of textures
+    // Slow path for behaviour AnimationSystem cannot express, prefer its batched animation kinds.
     std::function<void(Model&)> on_animate;
     void animate() {
-        on_animate(*this);
+        if (on_animate) {
+            on_animate(*this);
+        }
     }
 };
 
+using ModelHandle = SlotMapHandle<Model>;
+
+// Models live densely in a slot map, so iterating them stays cache friendly while handles survive other models being
+// added or deleted. References returned by lookups are only valid until the next add or delete.
 class ModelStorage {
+    struct NameHash {
+        using is_transparent = void;
+
+        [[nodiscard]] auto operator()(const std::string_view name) const noexcept -> std::size_t {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
 public:
     explicit ModelStorage(Logger& logger) : m_logger(logger) {}
 
-    inline auto addModel(const Model& model) -> Model& {
+    ModelStorage(const ModelStorage&) = delete;
+    ModelStorage(ModelStorage&&) = delete;
+    auto operator=(const ModelStorage&) -> ModelStorage& = delete;
+    auto operator=(ModelStorage&&) -> ModelStorage& = delete;
+    ~ModelStorage() = default;
+
+    inline auto addModel(Model&& model) -> ModelHandle {
         m_logger.info("Adding model (name: {}, vertices: {}, indices: {})",
                       model.name,
                       model.mesh.vertices.size(),
                       model.mesh.indices.size());
-        if (std::ranges::find_if(m_models, [&model](const Model& m) { return m.name == model.name; })
-            != m_models.end()) {
+        if (m_names.contains(model.name)) {
             const auto msg = std::format("Cannot add model {}. Already exists.", model.name);
             m_logger.error("{}", msg);
             throw std::runtime_error(msg);
         }
-        return m_models.emplace_back(model);
+        auto name = model.name;
+        const auto handle = m_models.insert(std::move(model));
+        m_names.emplace(std::move(name), handle);
+        return handle;
     }
 
     inline void deleteModel(const std::string_view name) noexcept {
-        if (const auto it = std::ranges::find_if(m_models, [name](const Model& model) { return model.name == name; });
-            it != m_models.end()) {
-            m_models.erase(it);
+        if (const auto it = m_names.find(name); it != m_names.end()) {
+            m_models.erase(it->second);
+            m_names.erase(it);
         }
     }
 
-    inline void deleteModel(const Model& model) noexcept {
-        deleteModel(model.name);
+    inline void deleteModel(const ModelHandle handle) noexcept {
+        if (const auto* model = m_models.get(handle)) {
+            deleteModel(model->name);
+        }
+    }
+
+    // Invalid handle if there is no model with this name.
+    [[nodiscard]] inline auto find(const std::string_view name) const noexcept -> ModelHandle {
+        const auto it = m_names.find(name);
+        return it != m_names.end() ? it->second : ModelHandle{};
+    }
+
+    [[nodiscard]] inline auto contains(const ModelHandle handle) const noexcept -> bool {
+        return m_models.contains(handle);
+    }
+
+    // Null if the model was deleted.
+    [[nodiscard]] inline auto get(const ModelHandle handle) noexcept -> Model* {
+        return m_models.get(handle);
+    }
+
+    [[nodiscard]] inline auto get(const ModelHandle handle) const noexcept -> const Model* {
+        return m_models.get(handle);
     }
 
     [[nodiscard]] inline auto begin() noexcept {
@@ -88,16 +133,17 @@ public:
         return m_models.empty();
     }
 
-    [[nodiscard]] inline auto operator[](const size_t index) noexcept -> Model& {
-        return m_models[index];
+    [[nodiscard]] inline auto operator[](const ModelHandle handle) -> Model& {
+        return m_models.at(handle);
     }
 
-    [[nodiscard]] inline auto operator[](const size_t index) const noexcept -> const Model& {
-        return m_models[index];
+    [[nodiscard]] inline auto operator[](const ModelHandle handle) const -> const Model& {
+        return m_models.at(handle);
     }
 
 private:
-    std::vector<Model> m_models;
+    SlotMap<Model> m_models;
+    std::unordered_map<std::string, ModelHandle, NameHash, std::equal_to<>> m_names;
     Logger& m_logger;
 };
 
@@ -0,0 +1,140 @@
+module th.scene.scene_graph;
+
+import std;
+import glm;
+
+namespace th {
+
+constexpr auto scene_graph_chunk_size = 1024uz;
+
+[[nodiscard]] static auto composeTransform(const glm::vec3 translation, const glm::quat rotation,
+                                           const glm::vec3 scale) noexcept -> glm::mat4 {
+    return glm::gtc::scale(glm::gtc::translate(glm::mat4(1.0f), translation) * glm::toMat4(rotation), scale);
+}
+
+auto SceneGraph::addNode(const LocalTransform& local_transform, const SceneNodeHandle parent) -> SceneNodeHandle {
+    const auto depth = parent.isValid() ? getLocation(parent).depth + 1 : 0u;
+    if (depth == m_levels.size()) {
+        m_levels.emplace_back();
+    }
+    auto& level = m_levels[depth];
+    const auto node = SceneNodeHandle{ .id = static_cast<uint32_t>(m_locations.size()) };
+    const auto location = Location{ .depth = depth, .index = static_cast<uint32_t>(level.node_ids.size()) };
+
+    level.translations.push_back(local_transform.translation);
+    level.rotations.push_back(local_transform.rotation);
+    level.scales.push_back(local_transform.scale);
+    level.world_matrices.emplace_back(1.0f);
+    level.parents.push_back(parent.isValid() ? getLocation(parent).index : 0u);
+    level.node_ids.push_back(node.id);
+    level.children.emplace_back();
+    level.dirty.push_back(0);
+    if (parent.isValid()) {
+        const auto parent_location = getLocation(parent);
+        m_levels[parent_location.depth].children[parent_location.index].push_back(location.index);
+    }
+    m_locations.push_back(location);
+    markDirty(location);
+    return node;
+}
+
+void SceneGraph::setLocalTransform(const SceneNodeHandle node, const LocalTransform& local_transform) {
+    const auto [depth, index] = getLocation(node);
+    auto& level = m_levels[depth];
+    level.translations[index] = local_transform.translation;
+    level.rotations[index] = local_transform.rotation;
+    level.scales[index] = local_transform.scale;
+    markDirty(Location{ .depth = depth, .index = index });
+}
+
+void SceneGraph::setTranslation(const SceneNodeHandle node, const glm::vec3 translation) {
+    const auto location = getLocation(node);
+    m_levels[location.depth].translations[location.index] = translation;
+    markDirty(location);
+}
+
+void SceneGraph::setRotation(const SceneNodeHandle node, const glm::quat rotation) {
+    const auto location = getLocation(node);
+    m_levels[location.depth].rotations[location.index] = rotation;
+    markDirty(location);
+}
+
+void SceneGraph::setScale(const SceneNodeHandle node, const glm::vec3 scale) {
+    const auto location = getLocation(node);
+    m_levels[location.depth].scales[location.index] = scale;
+    markDirty(location);
+}
+
+auto SceneGraph::getLocalTransform(const SceneNodeHandle node) const -> LocalTransform {
+    const auto [depth, index] = getLocation(node);
+    const auto& level = m_levels[depth];
+    return LocalTransform{
+        .translation = level.translations[index], .rotation = level.rotations[index], .scale = level.scales[index]
+    };
+}
+
+auto SceneGraph::getWorldMatrix(const SceneNodeHandle node) const -> const glm::mat4& {
+    const auto [depth, index] = getLocation(node);
+    return m_levels[depth].world_matrices[index];
+}
+
+auto SceneGraph::getParent(const SceneNodeHandle node) const -> SceneNodeHandle {
+    const auto [depth, index] = getLocation(node);
+    if (depth == 0) {
+        return SceneNodeHandle{};
+    }
+    return SceneNodeHandle{ .id = m_levels[depth - 1].node_ids[m_levels[depth].parents[index]] };
+}
+
+auto SceneGraph::update(JobSystem* job_system) -> std::size_t {
+    m_updated_nodes.clear();
+    for (auto depth = 0uz; depth < m_levels.size(); ++depth) {
+        auto& level = m_levels[depth];
+        if (level.dirty_indices.empty()) {
+            continue;
+        }
+        const auto* parent_level = depth > 0 ? &m_levels[depth - 1] : nullptr;
+        // Nodes of one level only read the level above, so they can be computed independently.
+        const auto update_nodes = [&level, parent_level](const std::size_t begin, const std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                const auto index = level.dirty_indices[i];
+                const auto local =
+                        composeTransform(level.translations[index], level.rotations[index], level.scales[index]);
+                level.world_matrices[index] =
+                        parent_level ? parent_level->world_matrices[level.parents[index]] * local : local;
+            }
+        };
+        if (job_system) {
+            job_system->parallelFor(0, level.dirty_indices.size(), scene_graph_chunk_size, update_nodes);
+        } else {
+            update_nodes(0, level.dirty_indices.size());
+        }
+
+        for (const auto index : level.dirty_indices) {
+            level.dirty[index] = 0;
+            m_updated_nodes.push_back(SceneNodeHandle{ .id = level.node_ids[index] });
+            for (const auto child : level.children[index]) {
+                markDirty(Location{ .depth = static_cast<uint32_t>(depth + 1), .index = child });
+            }
+        }
+        level.dirty_indices.clear();
+    }
+    return m_updated_nodes.size();
+}
+
+auto SceneGraph::getLocation(const SceneNodeHandle node) const -> Location {
+    if (node.id >= m_locations.size()) {
+        throw std::out_of_range(std::format("Scene node {} does not exist", node.id));
+    }
+    return m_locations[node.id];
+}
+
+void SceneGraph::markDirty(const Location location) {
+    auto& level = m_levels[location.depth];
+    if (level.dirty[location.index] == 0) {
+        level.dirty[location.index] = 1;
+        level.dirty_indices.push_back(location.index);
+    }
+}
+
+}// namespace th
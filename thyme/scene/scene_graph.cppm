@@ -0,0 +1,97 @@
+export module th.scene.scene_graph;
+
+import std;
+import glm;
+
+import th.core.job_system;
+
+export namespace th {
+
+struct SceneNodeHandle {
+    static constexpr auto invalid = std::numeric_limits<uint32_t>::max();
+
+    uint32_t id{ invalid };
+
+    [[nodiscard]] auto isValid() const noexcept -> bool {
+        return id != invalid;
+    }
+
+    auto operator==(const SceneNodeHandle&) const noexcept -> bool = default;
+};
+
+struct LocalTransform {
+    glm::vec3 translation{ 0.0f };
+    glm::quat rotation{ glm::identity<glm::quat>() };
+    glm::vec3 scale{ 1.0f };
+};
+
+// Transform hierarchy stored level by level: every depth keeps its nodes' local TRS and world matrices in separate
+// arrays, and a node's parent always lives one level up. Changing a node only marks it dirty; update() walks the
+// levels top-down and recomputes just the dirty nodes and their descendants, each level split across the job system
+// when one is given. Handles stay valid for the lifetime of the graph.
+class SceneGraph {
+public:
+    auto addNode(const LocalTransform& local_transform = {}, SceneNodeHandle parent = {}) -> SceneNodeHandle;
+
+    void setLocalTransform(SceneNodeHandle node, const LocalTransform& local_transform);
+    void setTranslation(SceneNodeHandle node, glm::vec3 translation);
+    void setRotation(SceneNodeHandle node, glm::quat rotation);
+    void setScale(SceneNodeHandle node, glm::vec3 scale);
+
+    [[nodiscard]] auto getLocalTransform(SceneNodeHandle node) const -> LocalTransform;
+
+    // Valid as of the last update().
+    [[nodiscard]] auto getWorldMatrix(SceneNodeHandle node) const -> const glm::mat4&;
+
+    [[nodiscard]] auto getParent(SceneNodeHandle node) const -> SceneNodeHandle;
+
+    [[nodiscard]] auto getDepth(SceneNodeHandle node) const -> uint32_t {
+        return m_locations.at(node.id).depth;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_locations.size();
+    }
+
+    [[nodiscard]] auto getDepthCount() const noexcept -> std::size_t {
+        return m_levels.size();
+    }
+
+    // Recomputes the world matrices of dirty subtrees and returns how many nodes were updated.
+    auto update(JobSystem* job_system = nullptr) -> std::size_t;
+
+    // Nodes whose world matrix the last update() recomputed, parents ahead of their children. Only these have to be
+    // passed on to Renderer::updateNodeTransforms.
+    [[nodiscard]] auto getUpdatedNodes() const noexcept -> std::span<const SceneNodeHandle> {
+        return m_updated_nodes;
+    }
+
+private:
+    struct Location {
+        uint32_t depth;
+        uint32_t index;
+    };
+
+    struct Level {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> world_matrices;
+        // Index of the parent in the level above.
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> node_ids;
+        std::vector<std::vector<uint32_t>> children;
+        std::vector<uint8_t> dirty;
+        std::vector<uint32_t> dirty_indices;
+    };
+
+    [[nodiscard]] auto getLocation(SceneNodeHandle node) const -> Location;
+    void markDirty(Location location);
+
+private:
+    std::vector<Level> m_levels;
+    std::vector<Location> m_locations;
+    std::vector<SceneNodeHandle> m_updated_nodes;
+};
+
+}// namespace th
@@ -24,6 +24,21 @@ public:
         return m_data;
     }
 
+    [[nodiscard]] auto getMipResolution(const uint32_t mip_level) const noexcept -> glm::uvec2 {
+        return glm::max(m_resolution >> glm::uvec2(mip_level), glm::uvec2(1u));
+    }
+
+    // Box-filters the base level down to the requested mip level. Runs on the CPU, so it is safe to call from
+    // background threads while the texture is not modified.
+    [[nodiscard]] auto generateMipLevel(uint32_t mip_level) const -> std::vector<uint8_t>;
+
+    // Generates every level from first_mip_level down to 1x1 in a single pass over the base level.
+    [[nodiscard]] auto generateMipChain(uint32_t first_mip_level) const -> std::vector<std::vector<uint8_t>>;
+
+private:
+    [[nodiscard]] auto downsample(std::span<const uint8_t> source, uint32_t source_mip_level) const
+            -> std::vector<uint8_t>;
+
 private:
     uint32_t m_mip_levels;
     glm::uvec2 m_resolution{};
@@ -50,4 +65,52 @@ TextureData::TextureData(const std::filesystem::path& file) {
     stbi_image_free(pixels);
 }
 
+auto TextureData::downsample(const std::span<const uint8_t> source, const uint32_t source_mip_level) const
+        -> std::vector<uint8_t> {
+    constexpr auto channels = 4u;
+    const auto source_resolution = getMipResolution(source_mip_level);
+    const auto resolution = getMipResolution(source_mip_level + 1);
+    std::vector<uint8_t> destination(static_cast<std::size_t>(resolution.x) * resolution.y * channels);
+    for (uint32_t y{ 0 }; y < resolution.y; ++y) {
+        const auto y0 = std::min(y * 2, source_resolution.y - 1);
+        const auto y1 = std::min(y * 2 + 1, source_resolution.y - 1);
+        for (uint32_t x{ 0 }; x < resolution.x; ++x) {
+            const auto x0 = std::min(x * 2, source_resolution.x - 1);
+            const auto x1 = std::min(x * 2 + 1, source_resolution.x - 1);
+            const auto texel = [&](const uint32_t tx, const uint32_t ty, const uint32_t c) -> uint32_t {
+                return source[(static_cast<std::size_t>(ty) * source_resolution.x + tx) * channels + c];
+            };
+            for (uint32_t c{ 0 }; c < channels; ++c) {
+                const auto sum = texel(x0, y0, c) + texel(x1, y0, c) + texel(x0, y1, c) + texel(x1, y1, c);
+                destination[(static_cast<std::size_t>(y) * resolution.x + x) * channels + c] =
+                        static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return destination;
+}
+
+auto TextureData::generateMipLevel(const uint32_t mip_level) const -> std::vector<uint8_t> {
+    if (mip_level == 0) {
+        return m_data;
+    }
+    auto level_data = downsample(m_data, 0);
+    for (uint32_t level{ 1 }; level < mip_level; ++level) {
+        level_data = downsample(level_data, level);
+    }
+    return level_data;
+}
+
+auto TextureData::generateMipChain(const uint32_t first_mip_level) const -> std::vector<std::vector<uint8_t>> {
+    std::vector<std::vector<uint8_t>> chain;
+    chain.reserve(m_mip_levels - std::min(first_mip_level, m_mip_levels));
+    auto level_data = generateMipLevel(first_mip_level);
+    for (uint32_t level{ first_mip_level }; level < m_mip_levels; ++level) {
+        auto next_level_data = level + 1 < m_mip_levels ? downsample(level_data, level) : std::vector<uint8_t>{};
+        chain.emplace_back(std::move(level_data));
+        level_data = std::move(next_level_data);
+    }
+    return chain;
+}
+
 }// namespace th
@@ -12,8 +12,7 @@ public:
     }
 
     inline void rotate(const float angle, const glm::vec3 axis) noexcept {
-        //glm::rotate(glm::mat4(1.0f), deltaTime * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-        m_transform_matrix = glm::gtc::rotate(glm::mat4(1.0f), angle, axis);
+        m_transform_matrix = glm::gtc::rotate(m_transform_matrix, angle, axis);
     }
 
     inline void scale(const glm::vec3 factor) noexcept {